@@ -16,11 +16,23 @@ import 'package:flutter/foundation.dart'
     show debugDefaultTargetPlatformOverride;
 import 'package:flutter/material.dart';
 
+import 'single_instance.dart';
+import 'startup_trace.dart';
+
 void main() {
   // See https://github.com/flutter/flutter/wiki/Desktop-shells#target-platform-override
   debugDefaultTargetPlatformOverride = TargetPlatform.fuchsia;
 
   runApp(new MyApp());
+
+  // Lets the Linux runner's startup tracer record the first frame.
+  reportFrameTimingsToRunner();
+
+  // When the Linux runner is in single-instance mode, later launches are
+  // forwarded to this instance instead of starting a new one.
+  listenForForwardedLaunches((workingDirectory, arguments) {
+    print('Launched again from $workingDirectory with arguments $arguments');
+  });
 }
 
 class MyApp extends StatelessWidget {
@@ -14,6 +14,7 @@
 #include <linux/limits.h>
 #include <unistd.h>
 
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
@@ -21,8 +22,26 @@
 
 #include <flutter/flutter_window_controller.h>
 
+#include "runner/linux/app_directories.h"
+#include "runner/linux/file_prefetcher.h"
+#include "runner/linux/shader_cache.h"
+#include "runner/linux/single_instance.h"
+#include "runner/linux/stall_watchdog.h"
+#include "runner/linux/startup_tracer.h"
+
 namespace {
 
+// The identifier used for per-application directories, such as the cache.
+const char kApplicationId[] = "flutter_desktop_example";
+
+// How often the event loop wakes while something needs periodic work:
+// delivering launches forwarded by other instances, the stall watchdog's
+// heartbeat, and the like.
+constexpr std::chrono::milliseconds kEventLoopWakeInterval{100};
+static_assert(kEventLoopWakeInterval <=
+                  runner::SingleInstance::kDeliveryInterval,
+              "Forwarded launches must be delivered often enough");
+
 // Returns the path of the directory containing this executable, or an empty
 // string if the directory cannot be found.
 std::string GetExecutableDirectory() {
@@ -45,6 +64,17 @@ std::string GetExecutableDirectory() {
 }  // namespace
 
 int main(int argc, char **argv) {
+  // Startup phases are recorded if FLUTTER_STARTUP_TRACE is set.
+  runner::StartupTracer tracer(argc, argv);
+  int64_t main_start = runner::StartupTracer::Now();
+
+  // In single-instance mode, a launch while another instance is running hands
+  // its arguments to that instance rather than starting another engine.
+  runner::SingleInstance single_instance(kApplicationId, argc, argv);
+  if (single_instance.ForwardToRunningInstance()) {
+    return EXIT_SUCCESS;
+  }
+
   // Resources are located relative to the executable.
   std::string base_directory = GetExecutableDirectory();
   if (base_directory.empty()) {
@@ -54,18 +84,68 @@ int main(int argc, char **argv) {
   std::string assets_path = data_directory + "/flutter_assets";
   std::string icu_data_path = data_directory + "/icudtl.dat";
 
+  // Start warming the page cache with the files the engine reads at startup,
+  // while the rest of startup proceeds.
+  std::string cache_directory = runner::GetCacheDirectory(kApplicationId);
+  runner::FilePrefetcher prefetcher(
+      base_directory,
+      cache_directory.empty() ? "" : cache_directory + "/prefetch_manifest");
+  prefetcher.Start();
+
   // Arguments for the Flutter Engine.
   std::vector<std::string> arguments;
 
+  // Release bundles contain the application AOT-compiled into lib/libapp.so.
+  // Otherwise, the engine runs the kernel snapshot in the assets directory.
+  std::string aot_library_path = base_directory + "/lib/libapp.so";
+  bool use_aot_library = access(aot_library_path.c_str(), R_OK) == 0;
+  if (use_aot_library) {
+    arguments.push_back("--aot-shared-library-name=" + aot_library_path);
+  }
+  tracer.SetMetadata("snapshot", use_aot_library ? "aot" : "kernel");
+
+  // Reuse the shaders compiled by earlier runs.
+  runner::ShaderCacheState shader_cache_state =
+      runner::ConfigureShaderCache(cache_directory, argc, argv, &arguments);
+  tracer.SetMetadata("shader_cache",
+                     runner::ShaderCacheStateName(shader_cache_state));
+
+  tracer.AddPhase("LocateResources", main_start,
+                  runner::StartupTracer::Now());
+
   flutter::FlutterWindowController flutter_controller(icu_data_path);
 
   // Start the engine.
+  int64_t phase_start = runner::StartupTracer::Now();
   if (!flutter_controller.CreateWindow(800, 600, "Flutter Desktop Example",
                                        assets_path, arguments)) {
     return EXIT_FAILURE;
   }
+  tracer.AddPhase("CreateWindow", phase_start, runner::StartupTracer::Now());
+
+  // Log stalls of the platform thread, if enabled. This observes channel
+  // messages, so it must be created before any handlers are installed.
+  runner::StallWatchdog stall_watchdog(argc, argv, kEventLoopWakeInterval);
+
+  tracer.ListenForFrameTimings(
+      flutter_controller.GetRegistrarForPlugin("StartupTracer"));
+  single_instance.RegisterChannel(
+      flutter_controller.GetRegistrarForPlugin("SingleInstance"));
 
   // Run until the window is closed.
-  flutter_controller.RunEventLoop();
+  tracer.AddInstantEvent("RunEventLoop", runner::StartupTracer::Now());
+  if (single_instance.listening() || stall_watchdog.enabled()) {
+    // Wake periodically to deliver launches forwarded by other instances, and
+    // for the watchdog's heartbeat.
+    stall_watchdog.Start();
+    while (flutter_controller.RunEventLoopWithTimeout(
+        kEventLoopWakeInterval)) {
+      stall_watchdog.Heartbeat();
+      single_instance.DeliverForwardedLaunches();
+    }
+  } else {
+    flutter_controller.RunEventLoop();
+  }
+  prefetcher.Finish(&tracer);
   return EXIT_SUCCESS;
 }
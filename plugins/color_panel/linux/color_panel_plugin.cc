@@ -21,23 +21,37 @@
 #include <flutter/plugin_registrar.h>
 #include <flutter/standard_method_codec.h>
 
+#include "plugins/common/linux/method_table.h"
+#include "plugins/common/linux/probes.h"
+
 namespace plugins_color_panel {
 
 namespace {
 // See color_panel.dart for documentation.
-const char kChannelName[] = "flutter/colorpanel";
-const char kShowColorPanelMethod[] = "ColorPanel.Show";
-const char kColorPanelShowAlpha[] = "ColorPanel.ShowAlpha";
-const char kHideColorPanelMethod[] = "ColorPanel.Hide";
-const char kColorSelectedCallbackMethod[] = "ColorPanel.ColorSelectedCallback";
-const char kClosedCallbackMethod[] = "ColorPanel.ClosedCallback";
-const char kColorComponentAlphaKey[] = "alpha";
-const char kColorComponentRedKey[] = "red";
-const char kColorComponentGreenKey[] = "green";
-const char kColorComponentBlueKey[] = "blue";
+constexpr char kChannelName[] = "flutter/colorpanel";
+constexpr char kShowColorPanelMethod[] = "ColorPanel.Show";
+constexpr char kColorPanelShowAlpha[] = "ColorPanel.ShowAlpha";
+constexpr char kHideColorPanelMethod[] = "ColorPanel.Hide";
+constexpr char kColorSelectedCallbackMethod[] =
+    "ColorPanel.ColorSelectedCallback";
+constexpr char kClosedCallbackMethod[] = "ColorPanel.ClosedCallback";
+constexpr char kColorComponentAlphaKey[] = "alpha";
+constexpr char kColorComponentRedKey[] = "red";
+constexpr char kColorComponentGreenKey[] = "green";
+constexpr char kColorComponentBlueKey[] = "blue";
+
+enum class Method { kShowColorPanel, kHideColorPanel };
+
+constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {
+    {kShowColorPanelMethod, Method::kShowColorPanel},
+    {kHideColorPanelMethod, Method::kHideColorPanel},
+};
+constexpr auto kMethods = plugins_common::MakeMethodTable(kMethodEntries);
 }
 
 static constexpr char kWindowTitle[] = "Flutter Color Picker";
+// The name of the dialog in probes.
+static constexpr char kProbeName[] = "color_panel";
 
 using flutter::EncodableMap;
 using flutter::EncodableValue;
@@ -92,6 +106,7 @@ class ColorPanelPlugin::ColorPanel {
     }
     gtk_color_chooser_set_use_alpha(
         reinterpret_cast<GtkColorChooser *>(gtk_widget_), use_alpha);
+    FLUTTER_DESKTOP_PROBE1(dialog_open, kProbeName);
     gtk_widget_show_all(gtk_widget_);
     g_signal_connect(gtk_widget_, "close", G_CALLBACK(CloseCallback), parent);
     g_signal_connect(gtk_widget_, "response", G_CALLBACK(ResponseCallback),
@@ -102,6 +117,7 @@ class ColorPanelPlugin::ColorPanel {
     if (gtk_widget_) {
       gtk_widget_destroy(gtk_widget_);
       gtk_widget_ = nullptr;
+      FLUTTER_DESKTOP_PROBE1(dialog_close, kProbeName);
     }
   }
 
@@ -176,23 +192,31 @@ ColorPanelPlugin::~ColorPanelPlugin() {}
 void ColorPanelPlugin::HandleMethodCall(
     const flutter::MethodCall<EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<EncodableValue>> result) {
-  if (method_call.method_name().compare(kShowColorPanelMethod) == 0) {
-    result->Success();
-    // There is only one color panel that can be displayed at once.
-    // There are no channels to use the color panel, so just return.
-    if (color_panel_) {
-      return;
-    }
-    color_panel_ = std::make_unique<ColorPanelPlugin::ColorPanel>(
-        this, method_call.arguments());
-  } else if (method_call.method_name().compare(kHideColorPanelMethod) == 0) {
-    result->Success();
-    if (color_panel_ == nullptr) {
-      return;
-    }
-    HidePanel(CloseRequestSource::kPlatformChannel);
-  } else {
+  plugins_common::ScopedMethodCallProbe probe(
+      kChannelName, method_call.method_name().c_str());
+  const Method *method = kMethods.Find(method_call.method_name());
+  if (!method) {
     result->NotImplemented();
+    return;
+  }
+  switch (*method) {
+    case Method::kShowColorPanel:
+      result->Success();
+      // There is only one color panel that can be displayed at once.
+      // There are no channels to use the color panel, so just return.
+      if (color_panel_) {
+        return;
+      }
+      color_panel_ = std::make_unique<ColorPanelPlugin::ColorPanel>(
+          this, method_call.arguments());
+      break;
+    case Method::kHideColorPanel:
+      result->Success();
+      if (color_panel_ == nullptr) {
+        return;
+      }
+      HidePanel(CloseRequestSource::kPlatformChannel);
+      break;
   }
 }
 
@@ -0,0 +1,223 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_ARENA_H_
+#define PLUGINS_COMMON_LINUX_ARENA_H_
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Bump allocation for values that share a short lifetime, such as everything
+// decoded from one incoming message. Allocating from an Arena is a pointer
+// increment, and everything allocated from it is freed at once by Reset.
+//
+// ArenaVector and ArenaString are the standard containers using an
+// ArenaAllocator. Default-constructed ones allocate from the heap as usual;
+// decoding them with a StandardCodecReader that has an arena allocates them
+// from that arena instead.
+
+namespace plugins_common {
+
+class Arena {
+ public:
+  static constexpr size_t kDefaultBlockSize = 4096;
+
+  // The most memory kept across a Reset, unless the block size is larger, so
+  // that one unusually large message doesn't pin its memory for the life of
+  // the arena.
+  static constexpr size_t kMaxRetainedSize = 256 * 1024;
+
+  // How many times the most used between recent resets the memory kept
+  // across a Reset may be. Recent means within the last kUsageHistoryLength
+  // resets.
+  static constexpr size_t kMaxRetainedToUsedRatio = 4;
+  static constexpr size_t kUsageHistoryLength = 8;
+
+  explicit Arena(size_t block_size = kDefaultBlockSize)
+      : block_size_(block_size) {}
+
+  // Prevent copying.
+  Arena(Arena const &) = delete;
+  Arena &operator=(Arena const &) = delete;
+
+  // Returns |size| bytes aligned to |alignment|, which must be a power of two
+  // no greater than alignof(std::max_align_t).
+  void *Allocate(size_t size, size_t alignment) {
+    size_t padding = (alignment - reinterpret_cast<uintptr_t>(next_) %
+                                      alignment) %
+                     alignment;
+    if (next_ == nullptr || padding + size > remaining_) {
+      AddBlock(size);
+      padding = 0;
+    }
+    uint8_t *allocation = next_ + padding;
+    next_ += padding + size;
+    remaining_ -= padding + size;
+    used_ += size;
+    return allocation;
+  }
+
+  // Frees everything allocated from the arena.
+  //
+  // If more than one block was needed since the last reset, they are replaced
+  // by a single block large enough for all of them, so that repeating the
+  // same allocations, as for a similar message, needs no further blocks.
+  // The memory is released instead if it is more than kMaxRetainedSize, or
+  // far more than recent usage, so that the next allocation starts over with
+  // a block of the initial size.
+  void Reset() {
+    usage_history_[usage_history_index_] = used_;
+    usage_history_index_ = (usage_history_index_ + 1) % kUsageHistoryLength;
+    used_ = 0;
+    size_t recent_usage =
+        *std::max_element(usage_history_.begin(), usage_history_.end());
+    size_t max_retained_size =
+        kMaxRetainedSize > block_size_ ? kMaxRetainedSize : block_size_;
+    size_t max_expected_size =
+        kMaxRetainedToUsedRatio *
+        (recent_usage > block_size_ ? recent_usage : block_size_);
+    size_t total_size = 0;
+    for (const Block &block : blocks_) {
+      total_size += block.size;
+    }
+    if (total_size > max_retained_size || total_size > max_expected_size) {
+      blocks_.clear();
+      next_ = nullptr;
+      remaining_ = 0;
+      return;
+    }
+    if (blocks_.size() > 1) {
+      blocks_.clear();
+      blocks_.push_back(
+          {std::unique_ptr<uint8_t[]>(new uint8_t[total_size]), total_size});
+    }
+    if (blocks_.empty()) {
+      return;
+    }
+    next_ = blocks_.front().data.get();
+    remaining_ = blocks_.front().size;
+  }
+
+ private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> data;
+    size_t size;
+  };
+
+  // Starts a new block with room for at least |size| bytes. Blocks are
+  // allocated with new[], so start at the maximum fundamental alignment.
+  void AddBlock(size_t size) {
+    size_t block_size = size > block_size_ ? size : block_size_;
+    blocks_.push_back(
+        {std::unique_ptr<uint8_t[]>(new uint8_t[block_size]), block_size});
+    next_ = blocks_.back().data.get();
+    remaining_ = block_size;
+  }
+
+  size_t block_size_;
+  std::vector<Block> blocks_;
+  // The unused part of the last block.
+  uint8_t *next_ = nullptr;
+  size_t remaining_ = 0;
+  // The bytes allocated since the last reset, and those allocated between
+  // each of the last kUsageHistoryLength resets, oldest first from
+  // |usage_history_index_|.
+  size_t used_ = 0;
+  std::array<size_t, kUsageHistoryLength> usage_history_ = {};
+  size_t usage_history_index_ = 0;
+};
+
+// An allocator using an Arena, or the heap if it has none. Deallocation from
+// an arena does nothing; the memory is reclaimed when the arena is reset.
+//
+// Copying a container gives the copy a heap allocator, so copies of values
+// allocated from an arena can safely outlive it. Assignment, including move
+// assignment, keeps the destination's allocator, so moving a value allocated
+// from an arena into a heap-allocated container copies its contents. Move
+// construction, however, takes the source's allocator, as for all standard
+// containers, and containers with different allocators must not be swapped.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::false_type;
+  using propagate_on_container_swap = std::false_type;
+
+  ArenaAllocator() : arena_(nullptr) {}
+
+  explicit ArenaAllocator(Arena *arena) : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.arena()) {}
+
+  Arena *arena() const { return arena_; }
+
+  T *allocate(size_t count) {
+    if (arena_) {
+      return static_cast<T *>(arena_->Allocate(count * sizeof(T), alignof(T)));
+    }
+    return static_cast<T *>(::operator new(count * sizeof(T)));
+  }
+
+  void deallocate(T *pointer, size_t count) {
+    if (!arena_) {
+      ::operator delete(pointer);
+    }
+  }
+
+  ArenaAllocator select_on_container_copy_construction() const {
+    return ArenaAllocator();
+  }
+
+ private:
+  Arena *arena_;
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return a.arena() == b.arena();
+}
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b) {
+  return !(a == b);
+}
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+// Replaces |*value| with a container constructed from |args|, which include
+// its allocator. Assignment would keep |*value|'s allocator; this gives it
+// the new one, which is how decoding moves values into a reader's arena.
+template <typename Container, typename... Args>
+void ReplaceWithAllocator(Container *value, Args &&... args) {
+  Container replacement(std::forward<Args>(args)...);
+  // Move construction takes the allocator, and doesn't throw.
+  value->~Container();
+  new (value) Container(std::move(replacement));
+}
+
+using ArenaString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_ARENA_H_
@@ -0,0 +1,178 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "plugins/common/linux/fake_flutter_desktop.h"
+
+#include <flutter_glfw.h>
+#include <flutter_messenger.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// The opaque types of the C API, as implemented by the fake.
+
+struct _FlutterPlatformMessageResponseHandle {
+  std::vector<uint8_t> *response;
+  bool *responded;
+};
+
+struct FlutterDesktopMessenger {
+  struct Callback {
+    std::string channel;
+    FlutterDesktopMessageCallback callback;
+    void *user_data;
+  };
+  // Searched linearly, since there are only ever a few channels, to avoid
+  // allocating a key for each message.
+  std::vector<Callback> callbacks;
+  // Response handles not in use by a message, kept for reuse so that the
+  // fake doesn't add allocations to each message.
+  std::vector<std::unique_ptr<FlutterDesktopMessageResponseHandle>>
+      free_handles;
+};
+
+struct FlutterDesktopWindow {
+  int x = 0;
+  int y = 0;
+  int width = 800;
+  int height = 600;
+  double scale_factor = 1.0;
+};
+
+struct FlutterDesktopPluginRegistrar {
+  FlutterDesktopMessenger messenger;
+  FlutterDesktopWindow window;
+};
+
+namespace plugins_common {
+
+namespace {
+
+FlutterDesktopPluginRegistrar *GetRegistrar() {
+  static auto *registrar = new FlutterDesktopPluginRegistrar();
+  return registrar;
+}
+
+}  // namespace
+
+FlutterDesktopPluginRegistrarRef GetFakeRegistrar() { return GetRegistrar(); }
+
+bool DeliverFakeMessage(const char *channel, const uint8_t *message,
+                        size_t message_size, std::vector<uint8_t> *response,
+                        bool *responded) {
+  FlutterDesktopMessenger *messenger = &GetRegistrar()->messenger;
+  for (const auto &entry : messenger->callbacks) {
+    if (entry.channel.compare(channel) != 0) {
+      continue;
+    }
+    response->clear();
+    *responded = false;
+    std::unique_ptr<FlutterDesktopMessageResponseHandle> handle;
+    if (messenger->free_handles.empty()) {
+      handle = std::make_unique<FlutterDesktopMessageResponseHandle>();
+    } else {
+      handle = std::move(messenger->free_handles.back());
+      messenger->free_handles.pop_back();
+    }
+    handle->response = response;
+    handle->responded = responded;
+    FlutterDesktopMessage platform_message = {};
+    platform_message.struct_size = sizeof(platform_message);
+    platform_message.channel = channel;
+    platform_message.message = message;
+    platform_message.message_size = message_size;
+    // Returned to |free_handles| when the response is sent.
+    platform_message.response_handle = handle.release();
+    entry.callback(messenger, &platform_message, entry.user_data);
+    return true;
+  }
+  return false;
+}
+
+}  // namespace plugins_common
+
+// The C API functions used by the C++ wrapper's registrar, messenger, and
+// window classes.
+
+FlutterDesktopMessengerRef FlutterDesktopRegistrarGetMessenger(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  return &registrar->messenger;
+}
+
+void FlutterDesktopRegistrarEnableInputBlocking(
+    FlutterDesktopPluginRegistrarRef registrar, const char *channel) {}
+
+FlutterDesktopWindowRef FlutterDesktopRegistrarGetWindow(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  return &registrar->window;
+}
+
+bool FlutterDesktopMessengerSend(FlutterDesktopMessengerRef messenger,
+                                 const char *channel, const uint8_t *message,
+                                 const size_t message_size) {
+  // There is no Dart side to receive the message.
+  return true;
+}
+
+void FlutterDesktopMessengerSendResponse(
+    FlutterDesktopMessengerRef messenger,
+    const FlutterDesktopMessageResponseHandle *handle, const uint8_t *data,
+    size_t data_length) {
+  // The handle is only ever one released by DeliverFakeMessage, which is
+  // mutable there.
+  std::unique_ptr<FlutterDesktopMessageResponseHandle> owned_handle(
+      const_cast<FlutterDesktopMessageResponseHandle *>(handle));
+  if (data_length > 0) {
+    owned_handle->response->assign(data, data + data_length);
+  }
+  *owned_handle->responded = true;
+  messenger->free_handles.push_back(std::move(owned_handle));
+}
+
+void FlutterDesktopMessengerSetCallback(FlutterDesktopMessengerRef messenger,
+                                        const char *channel,
+                                        FlutterDesktopMessageCallback callback,
+                                        void *user_data) {
+  auto &callbacks = messenger->callbacks;
+  for (auto it = callbacks.begin(); it != callbacks.end(); ++it) {
+    if (it->channel.compare(channel) == 0) {
+      callbacks.erase(it);
+      break;
+    }
+  }
+  if (callback) {
+    callbacks.push_back({channel, callback, user_data});
+  }
+}
+
+void FlutterDesktopWindowGetFrame(FlutterDesktopWindowRef window, int *x,
+                                  int *y, int *width, int *height) {
+  *x = window->x;
+  *y = window->y;
+  *width = window->width;
+  *height = window->height;
+}
+
+void FlutterDesktopWindowSetFrame(FlutterDesktopWindowRef window, int x,
+                                  int y, int width, int height) {
+  window->x = x;
+  window->y = y;
+  window->width = width;
+  window->height = height;
+}
+
+double FlutterDesktopWindowGetScaleFactor(FlutterDesktopWindowRef window) {
+  return window->scale_factor;
+}
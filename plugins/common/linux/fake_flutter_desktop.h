@@ -0,0 +1,49 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_FAKE_FLUTTER_DESKTOP_H_
+#define PLUGINS_COMMON_LINUX_FAKE_FLUTTER_DESKTOP_H_
+
+#include <flutter_plugin_registrar.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// A stand-in for the parts of the Flutter desktop C API that plugins use:
+// a registrar, its messenger, and its window. Linking fake_flutter_desktop.cc
+// in place of the Flutter library allows plugins to be registered and driven
+// directly, without an engine or a Dart side, for benchmarks.
+//
+// Like the real messenger, the fake is not thread-safe; it must only be used
+// from one thread.
+
+namespace plugins_common {
+
+// Returns the fake registrar to pass to plugins' registration functions.
+FlutterDesktopPluginRegistrarRef GetFakeRegistrar();
+
+// Delivers |message| to the handler registered for |channel|, as if it had
+// been sent from Dart. When the handler responds, which may be after it
+// returns, as with work run on a TaskPool, the response is stored in
+// |response| and |responded| is set to true; both must remain valid until
+// then.
+//
+// Returns false if no handler is registered for |channel|.
+bool DeliverFakeMessage(const char *channel, const uint8_t *message,
+                        size_t message_size, std::vector<uint8_t> *response,
+                        bool *responded);
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_FAKE_FLUTTER_DESKTOP_H_
@@ -0,0 +1,289 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_MESSAGE_LOG_H_
+#define PLUGINS_COMMON_LINUX_MESSAGE_LOG_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// A compact binary log of platform channel traffic, written by the runner's
+// message recorder and read by the message_replay tool.
+//
+// The file is an 8-byte magic string followed by entries, each of which is:
+//   type: byte, an EntryType
+//   time: varint, microseconds since the previous entry
+//   For kMessageFromDart and kMessageToDart:
+//     channel: varint, the index of the channel among those seen so far; an
+//         index equal to the number seen so far introduces a new channel,
+//         and is followed by its name as a varint length and the bytes
+//   For kResponse:
+//     message: varint, how many messages from Dart ago the message being
+//         responded to was logged (0 for the most recent)
+//   payload: varint length, and the bytes
+// Varints are unsigned LEB128.
+
+namespace plugins_common {
+
+enum class MessageLogEntryType : uint8_t {
+  kMessageFromDart = 1,
+  kResponse = 2,
+  kMessageToDart = 3,
+};
+
+struct MessageLogEntry {
+  MessageLogEntryType type;
+  // Microseconds since the start of the log.
+  int64_t time;
+  // Empty for responses.
+  std::string channel;
+  // For messages from Dart, the message's index among them; for responses,
+  // the index of the message being responded to.
+  uint64_t message_index;
+  std::vector<uint8_t> payload;
+};
+
+namespace internal {
+
+constexpr char kMessageLogMagic[] = "FDEMLOG1";
+constexpr size_t kMessageLogMagicSize = sizeof(kMessageLogMagic) - 1;
+
+}  // namespace internal
+
+// Writes a message log. Writes are buffered; the file is complete once the
+// writer is destroyed.
+class MessageLogWriter {
+ public:
+  MessageLogWriter() = default;
+  ~MessageLogWriter() {
+    if (file_) {
+      fclose(file_);
+    }
+  }
+
+  // Prevent copying.
+  MessageLogWriter(MessageLogWriter const &) = delete;
+  MessageLogWriter &operator=(MessageLogWriter const &) = delete;
+
+  // Creates or truncates the log at |path|. Returns false on failure.
+  bool Open(const std::string &path) {
+    file_ = fopen(path.c_str(), "we");
+    if (!file_) {
+      return false;
+    }
+    // Messages are small, so write them in large batches.
+    setvbuf(file_, nullptr, _IOFBF, 1 << 16);
+    fwrite(internal::kMessageLogMagic, 1, internal::kMessageLogMagicSize,
+           file_);
+    return true;
+  }
+
+  // Logs a message from Dart at |time| microseconds, returning its index.
+  uint64_t WriteMessageFromDart(int64_t time, const char *channel,
+                                const uint8_t *payload, size_t payload_size) {
+    WriteMessage(MessageLogEntryType::kMessageFromDart, time, channel,
+                 payload, payload_size);
+    return messages_from_dart_++;
+  }
+
+  // Logs the response to the message from Dart with |message_index|.
+  void WriteResponse(int64_t time, uint64_t message_index,
+                     const uint8_t *payload, size_t payload_size) {
+    WriteHeader(MessageLogEntryType::kResponse, time);
+    WriteVarint(messages_from_dart_ - 1 - message_index);
+    WritePayload(payload, payload_size);
+  }
+
+  void WriteMessageToDart(int64_t time, const char *channel,
+                          const uint8_t *payload, size_t payload_size) {
+    WriteMessage(MessageLogEntryType::kMessageToDart, time, channel, payload,
+                 payload_size);
+  }
+
+ private:
+  void WriteMessage(MessageLogEntryType type, int64_t time,
+                    const char *channel, const uint8_t *payload,
+                    size_t payload_size) {
+    WriteHeader(type, time);
+    // There are only ever a few channels.
+    size_t index = 0;
+    while (index < channels_.size() && channels_[index] != channel) {
+      ++index;
+    }
+    WriteVarint(index);
+    if (index == channels_.size()) {
+      channels_.push_back(channel);
+      WritePayload(reinterpret_cast<const uint8_t *>(channel),
+                   strlen(channel));
+    }
+    WritePayload(payload, payload_size);
+  }
+
+  void WriteHeader(MessageLogEntryType type, int64_t time) {
+    fputc(static_cast<uint8_t>(type), file_);
+    // Out-of-order times, which shouldn't happen with a monotonic clock, are
+    // logged as simultaneous.
+    WriteVarint(time > last_time_ ? time - last_time_ : 0);
+    last_time_ = std::max(time, last_time_);
+  }
+
+  void WritePayload(const uint8_t *payload, size_t payload_size) {
+    WriteVarint(payload_size);
+    fwrite(payload, 1, payload_size, file_);
+  }
+
+  void WriteVarint(uint64_t value) {
+    while (value >= 0x80) {
+      fputc(static_cast<uint8_t>(value) | 0x80, file_);
+      value >>= 7;
+    }
+    fputc(static_cast<uint8_t>(value), file_);
+  }
+
+  FILE *file_ = nullptr;
+  int64_t last_time_ = 0;
+  uint64_t messages_from_dart_ = 0;
+  std::vector<std::string> channels_;
+};
+
+// Reads a message log written by MessageLogWriter.
+class MessageLogReader {
+ public:
+  // Reads the whole log at |path| into memory, so that reading entries
+  // doesn't do I/O. Returns false if it can't be read or isn't a log.
+  bool Open(const std::string &path) {
+    FILE *file = fopen(path.c_str(), "re");
+    if (!file) {
+      return false;
+    }
+    uint8_t buffer[1 << 16];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+      data_.insert(data_.end(), buffer, buffer + read);
+    }
+    fclose(file);
+    if (data_.size() < internal::kMessageLogMagicSize ||
+        memcmp(data_.data(), internal::kMessageLogMagic,
+               internal::kMessageLogMagicSize) != 0) {
+      return false;
+    }
+    position_ = internal::kMessageLogMagicSize;
+    return true;
+  }
+
+  // Reads the next entry into |entry|. Returns false at the end of the log,
+  // or if the rest of the log is malformed, in which case error() is true.
+  // The entries before the error, such as all the complete entries of a log
+  // cut off by a crash, are still read.
+  bool Next(MessageLogEntry *entry) {
+    if (position_ == data_.size()) {
+      return false;
+    }
+    if (ReadEntry(entry)) {
+      return true;
+    }
+    error_ = true;
+    position_ = data_.size();
+    return false;
+  }
+
+  bool error() const { return error_; }
+
+ private:
+  bool ReadEntry(MessageLogEntry *entry) {
+    uint64_t type = data_[position_++];
+    uint64_t delta;
+    if (!ReadVarint(&delta)) {
+      return false;
+    }
+    time_ += static_cast<int64_t>(delta);
+    entry->time = time_;
+    entry->channel.clear();
+    entry->message_index = 0;
+    entry->type = static_cast<MessageLogEntryType>(type);
+    switch (entry->type) {
+      case MessageLogEntryType::kMessageFromDart:
+      case MessageLogEntryType::kMessageToDart: {
+        uint64_t index;
+        if (!ReadVarint(&index) || index > channels_.size()) {
+          return false;
+        }
+        if (index == channels_.size()) {
+          std::vector<uint8_t> name;
+          if (!ReadPayload(&name)) {
+            return false;
+          }
+          channels_.emplace_back(name.begin(), name.end());
+        }
+        entry->channel = channels_[index];
+        if (entry->type == MessageLogEntryType::kMessageFromDart) {
+          entry->message_index = messages_from_dart_++;
+        }
+        break;
+      }
+      case MessageLogEntryType::kResponse: {
+        uint64_t messages_ago;
+        if (!ReadVarint(&messages_ago) ||
+            messages_ago >= messages_from_dart_) {
+          return false;
+        }
+        entry->message_index = messages_from_dart_ - 1 - messages_ago;
+        break;
+      }
+      default:
+        return false;
+    }
+    return ReadPayload(&entry->payload);
+  }
+
+  bool ReadVarint(uint64_t *value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      if (position_ == data_.size()) {
+        return false;
+      }
+      uint8_t byte = data_[position_++];
+      *value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ReadPayload(std::vector<uint8_t> *payload) {
+    uint64_t size;
+    if (!ReadVarint(&size) || size > data_.size() - position_) {
+      return false;
+    }
+    payload->assign(data_.begin() + position_,
+                    data_.begin() + position_ + size);
+    position_ += size;
+    return true;
+  }
+
+  std::vector<uint8_t> data_;
+  size_t position_ = 0;
+  bool error_ = false;
+  int64_t time_ = 0;
+  uint64_t messages_from_dart_ = 0;
+  std::vector<std::string> channels_;
+};
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_MESSAGE_LOG_H_
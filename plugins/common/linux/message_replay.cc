@@ -0,0 +1,306 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Replays platform channel traffic recorded by the runner's message recorder
+// (see runner/linux/message_recorder.h) against the plugins, registered with
+// a fake registrar and messenger (see fake_flutter_desktop.h) rather than a
+// Flutter engine, and reports throughput and the latency of each method.
+//
+// Usage: message_replay [--max-speed] [--repeat=<count>] <log>
+//
+// Messages are delivered at the recorded times, or back to back with
+// --max-speed. Latency is measured from delivery to the response, so it
+// includes time the response spent queued, such as on a TaskPool. Messages
+// for channels with no plugin here, such as the runner's own channels and
+// the file chooser (whose modal dialog would stop the replay), are skipped.
+//
+// The plugins use GTK, so a display is required; `make replay` runs under
+// Xvfb when DISPLAY is not set.
+
+#include <gtk/gtk.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <list>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "plugins/common/linux/fake_flutter_desktop.h"
+#include "plugins/common/linux/message_log.h"
+#include "plugins/common/linux/standard_codec_stream.h"
+#include "plugins/example_plugin/linux/example_plugin.h"
+#include "plugins/menubar/linux/menubar_plugin.h"
+#include "plugins/window_size/linux/window_size_plugin.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+using plugins_common::MessageLogEntry;
+using plugins_common::MessageLogEntryType;
+
+const char kMaxSpeedArgument[] = "--max-speed";
+const char kRepeatArgumentPrefix[] = "--repeat=";
+
+// How long to wait for outstanding responses after the last message.
+const std::chrono::seconds kDrainTimeout(10);
+
+// A recorded message from Dart.
+struct RecordedMessage {
+  int64_t time;
+  std::string channel;
+  std::string method;
+  std::vector<uint8_t> payload;
+  // The recorded response, if any.
+  bool has_response = false;
+  std::vector<uint8_t> response;
+};
+
+// A delivered message awaiting its response.
+struct InFlightMessage {
+  const RecordedMessage *message;
+  Clock::time_point start;
+  std::vector<uint8_t> response;
+  bool responded = false;
+};
+
+struct Results {
+  // Latencies in microseconds, by channel and method.
+  std::map<std::pair<std::string, std::string>, std::vector<int64_t>>
+      latencies;
+  // Messages skipped for having no handler, by channel.
+  std::map<std::string, size_t> unhandled;
+  size_t delivered = 0;
+  size_t unanswered = 0;
+  size_t differing_responses = 0;
+};
+
+// Returns the method name of a standard method codec call, or an empty
+// string if |payload| isn't one.
+std::string GetMethodName(const std::vector<uint8_t> &payload) {
+  plugins_common::StandardCodecReader reader(payload.data(), payload.size());
+  const char *name;
+  size_t name_size;
+  if (!reader.ReadStringView(&name, &name_size)) {
+    return "";
+  }
+  return std::string(name, name_size);
+}
+
+// Reads the messages from Dart in the log at |path|, with their responses.
+// Returns false if the log can't be read.
+bool ReadMessages(const char *path, std::vector<RecordedMessage> *messages) {
+  plugins_common::MessageLogReader reader;
+  if (!reader.Open(path)) {
+    std::cerr << "Unable to read message log " << path << std::endl;
+    return false;
+  }
+  // Indices are only assigned to messages from Dart, so map them to
+  // positions in |messages|.
+  std::unordered_map<uint64_t, size_t> positions;
+  MessageLogEntry entry;
+  while (reader.Next(&entry)) {
+    if (entry.type == MessageLogEntryType::kMessageFromDart) {
+      positions[entry.message_index] = messages->size();
+      RecordedMessage message;
+      message.time = entry.time;
+      message.channel = entry.channel;
+      message.method = GetMethodName(entry.payload);
+      message.payload = std::move(entry.payload);
+      messages->push_back(std::move(message));
+    } else if (entry.type == MessageLogEntryType::kResponse) {
+      RecordedMessage &message = (*messages)[positions[entry.message_index]];
+      message.has_response = true;
+      message.response = std::move(entry.payload);
+    }
+  }
+  if (reader.error()) {
+    std::cerr << "Message log " << path << " is truncated or malformed; "
+              << "replaying the " << messages->size()
+              << " messages before the error" << std::endl;
+  }
+  return true;
+}
+
+int64_t MicrosecondsBetween(Clock::time_point start, Clock::time_point end) {
+  return std::chrono::duration_cast<std::chrono::microseconds>(end - start)
+      .count();
+}
+
+// Runs pending main context work, such as responses posted by TaskPool
+// work, and moves the messages in |in_flight| that have been answered into
+// |results|.
+void CollectResponses(std::list<InFlightMessage> *in_flight,
+                      Results *results) {
+  while (g_main_context_iteration(nullptr, FALSE)) {
+  }
+  Clock::time_point now = Clock::now();
+  for (auto it = in_flight->begin(); it != in_flight->end();) {
+    if (!it->responded) {
+      ++it;
+      continue;
+    }
+    const RecordedMessage &message = *it->message;
+    results->latencies[std::make_pair(message.channel, message.method)]
+        .push_back(MicrosecondsBetween(it->start, now));
+    if (message.has_response && message.response != it->response) {
+      ++results->differing_responses;
+    }
+    it = in_flight->erase(it);
+  }
+}
+
+// Delivers |messages| to the plugins, at the recorded times unless
+// |max_speed| is set, and waits for their responses. Messages that are
+// never answered are left in |in_flight|, which must outlive any late
+// response.
+void Replay(const std::vector<RecordedMessage> &messages, bool max_speed,
+            std::list<InFlightMessage> *in_flight, Results *results) {
+  Clock::time_point replay_start = Clock::now();
+  int64_t log_start = messages.empty() ? 0 : messages.front().time;
+  for (const RecordedMessage &message : messages) {
+    if (!max_speed) {
+      Clock::time_point due =
+          replay_start + std::chrono::microseconds(message.time - log_start);
+      while (Clock::now() < due) {
+        CollectResponses(in_flight, results);
+        int64_t remaining = MicrosecondsBetween(Clock::now(), due);
+        if (remaining > 0) {
+          usleep(std::min<int64_t>(remaining, 1000));
+        }
+      }
+    }
+    in_flight->emplace_back();
+    InFlightMessage &delivery = in_flight->back();
+    delivery.message = &message;
+    delivery.start = Clock::now();
+    if (!plugins_common::DeliverFakeMessage(
+            message.channel.c_str(), message.payload.data(),
+            message.payload.size(), &delivery.response,
+            &delivery.responded)) {
+      ++results->unhandled[message.channel];
+      in_flight->pop_back();
+      continue;
+    }
+    ++results->delivered;
+    CollectResponses(in_flight, results);
+  }
+  Clock::time_point drain_deadline = Clock::now() + kDrainTimeout;
+  while (!in_flight->empty() && Clock::now() < drain_deadline) {
+    CollectResponses(in_flight, results);
+    usleep(100);
+  }
+}
+
+// Returns the |percent|th percentile of |values|, which must be sorted and
+// not empty.
+int64_t Percentile(const std::vector<int64_t> &values, int percent) {
+  return values[(values.size() - 1) * percent / 100];
+}
+
+void PrintResults(Results *results, int64_t elapsed_us) {
+  std::cout << "Delivered " << results->delivered << " messages in "
+            << elapsed_us / 1000 << " ms: " << std::fixed
+            << std::setprecision(1)
+            << (elapsed_us > 0 ? results->delivered * 1e6 / elapsed_us : 0)
+            << " messages/s" << std::endl;
+  std::cout << std::setw(24) << std::left << "channel" << std::setw(24)
+            << "method" << std::right << std::setw(8) << "count"
+            << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+            << std::setw(10) << "p99 us" << std::setw(10) << "max us"
+            << std::endl;
+  for (auto &entry : results->latencies) {
+    std::vector<int64_t> &latencies = entry.second;
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::setw(24) << std::left << entry.first.first
+              << std::setw(24) << entry.first.second << std::right
+              << std::setw(8) << latencies.size() << std::setw(10)
+              << Percentile(latencies, 50) << std::setw(10)
+              << Percentile(latencies, 90) << std::setw(10)
+              << Percentile(latencies, 99) << std::setw(10)
+              << latencies.back() << std::endl;
+  }
+  if (results->unanswered > 0) {
+    std::cout << results->unanswered << " messages were never answered"
+              << std::endl;
+  }
+  if (results->differing_responses > 0) {
+    // Expected for responses that depend on the machine, such as window
+    // and screen geometry.
+    std::cout << results->differing_responses
+              << " responses differed from the recording" << std::endl;
+  }
+  for (const auto &entry : results->unhandled) {
+    std::cout << "Skipped " << entry.second << " messages on " << entry.first
+              << ", which has no plugin here" << std::endl;
+  }
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (!gtk_init_check(&argc, &argv)) {
+    std::cerr << "A display is required to run the plugins." << std::endl;
+    return EXIT_FAILURE;
+  }
+  bool max_speed = false;
+  int repeat = 1;
+  const char *path = nullptr;
+  size_t repeat_prefix_length = strlen(kRepeatArgumentPrefix);
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], kMaxSpeedArgument) == 0) {
+      max_speed = true;
+    } else if (strncmp(argv[i], kRepeatArgumentPrefix,
+                       repeat_prefix_length) == 0) {
+      repeat = std::max(1, atoi(argv[i] + repeat_prefix_length));
+    } else {
+      path = argv[i];
+    }
+  }
+  if (!path) {
+    std::cerr << "Usage: " << argv[0]
+              << " [--max-speed] [--repeat=<count>] <log>" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  std::vector<RecordedMessage> messages;
+  if (!ReadMessages(path, &messages)) {
+    return EXIT_FAILURE;
+  }
+
+  FlutterDesktopPluginRegistrarRef registrar =
+      plugins_common::GetFakeRegistrar();
+  ExamplePluginRegisterWithRegistrar(registrar);
+  MenubarRegisterWithRegistrar(registrar);
+  WindowSizeRegisterWithRegistrar(registrar);
+
+  Results results;
+  // Elements must not move while a response may be written to them, so
+  // this is a list.
+  std::list<InFlightMessage> in_flight;
+  Clock::time_point start = Clock::now();
+  for (int i = 0; i < repeat; ++i) {
+    Replay(messages, max_speed, &in_flight, &results);
+  }
+  results.unanswered = in_flight.size();
+  PrintResults(&results, MicrosecondsBetween(start, Clock::now()));
+  return results.unanswered == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
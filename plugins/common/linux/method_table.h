@@ -0,0 +1,171 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_METHOD_TABLE_H_
+#define PLUGINS_COMMON_LINUX_METHOD_TABLE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+// Method-name dispatch for plugins, using a perfect hash table built at
+// compile time, so that looking up a method costs one hash of the name and
+// one string comparison regardless of how many methods the plugin has.
+//
+// Usage:
+//   enum class Method { kShow, kHide };
+//   constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {
+//       {kShowMethod, Method::kShow},
+//       {kHideMethod, Method::kHide},
+//   };
+//   constexpr auto kMethods = plugins_common::MakeMethodTable(kMethodEntries);
+//   ...
+//   const Method *method = kMethods.Find(method_call.method_name());
+//
+// Method names used in a table must be constexpr, so that they can be hashed
+// at compile time.
+
+namespace plugins_common {
+
+// Returns the 32-bit FNV-1a hash of |size| bytes at |data|, varied by |seed|.
+constexpr uint32_t HashMethodName(const char *data, size_t size,
+                                  uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (size_t i = 0; i < size; ++i) {
+    hash ^= static_cast<uint8_t>(data[i]);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// A method name and the value it dispatches to, such as an enum value or a
+// member function pointer.
+template <typename Handler>
+struct MethodEntry {
+  const char *name;
+  Handler handler;
+};
+
+namespace internal {
+
+constexpr size_t ConstexprStrlen(const char *string) {
+  size_t length = 0;
+  while (string[length] != '\0') {
+    ++length;
+  }
+  return length;
+}
+
+// Returns the number of slots for a table of |count| entries: the smallest
+// power of two of at least |count| squared. With that many slots, a random
+// seed gives a collision-free table with probability over 1/2, so the seed
+// search at compile time is short.
+constexpr size_t SlotCount(size_t count) {
+  size_t slots = 1;
+  while (slots < count * count) {
+    slots *= 2;
+  }
+  return slots;
+}
+
+}  // namespace internal
+
+// A compile-time perfect hash table from method name to handler.
+template <typename Handler, size_t N>
+class MethodTable {
+ public:
+  static_assert(N > 0, "A method table needs at least one method");
+  static_assert(N < 255, "Slots store entry indices as uint8_t");
+
+  constexpr explicit MethodTable(const MethodEntry<Handler> (&entries)[N])
+      : entries_{}, lengths_{}, seed_(0), slots_{} {
+    for (size_t i = 0; i < N; ++i) {
+      entries_[i] = entries[i];
+      lengths_[i] = internal::ConstexprStrlen(entries[i].name);
+    }
+    for (uint32_t seed = 0;; ++seed) {
+      // Distinct names will almost never need more than a few seeds, but
+      // duplicate names always collide. Evaluating a throw fails compilation.
+      if (seed == kMaxSeeds) {
+        throw std::logic_error("Method names must be unique");
+      }
+      if (TryBuild(seed)) {
+        seed_ = seed;
+        return;
+      }
+    }
+  }
+
+  // Returns the handler for |name|, or nullptr if there is no such method.
+  const Handler *Find(const std::string &name) const {
+    return Find(name.data(), name.size());
+  }
+
+  // As above, for a name that is |size| bytes at |data|, which need not be
+  // null-terminated.
+  const Handler *Find(const char *data, size_t size) const {
+    const MethodEntry<Handler> *entry = FindEntry(data, size);
+    return entry ? &entry->handler : nullptr;
+  }
+
+  // As above, but returns the whole entry, whose name is null-terminated.
+  const MethodEntry<Handler> *FindEntry(const char *data, size_t size) const {
+    uint8_t index = slots_[HashMethodName(data, size, seed_) & kSlotMask];
+    if (index == kEmptySlot || lengths_[index] != size ||
+        memcmp(entries_[index].name, data, size) != 0) {
+      return nullptr;
+    }
+    return &entries_[index];
+  }
+
+ private:
+  static constexpr size_t kSlotCount = internal::SlotCount(N);
+  static constexpr size_t kSlotMask = kSlotCount - 1;
+  static constexpr uint8_t kEmptySlot = 0xff;
+  static constexpr uint32_t kMaxSeeds = 64;
+
+  // Fills |slots_| using |seed|. Returns false on a collision.
+  constexpr bool TryBuild(uint32_t seed) {
+    for (size_t slot = 0; slot < kSlotCount; ++slot) {
+      slots_[slot] = kEmptySlot;
+    }
+    for (size_t i = 0; i < N; ++i) {
+      size_t slot =
+          HashMethodName(entries_[i].name, lengths_[i], seed) & kSlotMask;
+      if (slots_[slot] != kEmptySlot) {
+        return false;
+      }
+      slots_[slot] = static_cast<uint8_t>(i);
+    }
+    return true;
+  }
+
+  MethodEntry<Handler> entries_[N];
+  size_t lengths_[N];
+  uint32_t seed_;
+  // The index in |entries_| of the method hashing to each slot.
+  uint8_t slots_[kSlotCount];
+};
+
+// Returns a MethodTable for |entries|, deducing its size.
+template <typename Handler, size_t N>
+constexpr MethodTable<Handler, N> MakeMethodTable(
+    const MethodEntry<Handler> (&entries)[N]) {
+  return MethodTable<Handler, N>(entries);
+}
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_METHOD_TABLE_H_
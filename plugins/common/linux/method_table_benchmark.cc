@@ -0,0 +1,135 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the cost of dispatching a method call by name with a MethodTable
+// against the chain of compare() calls that plugins used previously, for
+// plugins with 2 and 50 methods. Run with `make benchmark`.
+
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "plugins/common/linux/method_table.h"
+
+namespace {
+
+using plugins_common::MethodEntry;
+
+constexpr MethodEntry<int> kSmallEntries[] = {
+    {"ColorPanel.Show", 0},
+    {"ColorPanel.Hide", 1},
+};
+
+constexpr MethodEntry<int> kLargeEntries[] = {
+    {"Window.GetScreenList", 0},     {"Window.GetWindowInfo", 1},
+    {"Window.SetWindowFrame", 2},    {"Window.SetMinSize", 3},
+    {"Window.SetMaxSize", 4},        {"Window.SetAspectRatio", 5},
+    {"Window.SetTitle", 6},          {"Window.SetVisibility", 7},
+    {"Window.Minimize", 8},          {"Window.Maximize", 9},
+    {"Window.Restore", 10},          {"Window.SetFullScreen", 11},
+    {"Window.Focus", 12},            {"Window.SetOpacity", 13},
+    {"Window.SetAlwaysOnTop", 14},   {"Window.SetDecorated", 15},
+    {"Window.SetResizable", 16},     {"Window.SetIcon", 17},
+    {"Window.StartDrag", 18},        {"Window.StartResize", 19},
+    {"Menubar.SetMenu", 20},         {"Menubar.ClearMenu", 21},
+    {"Menubar.SetItemEnabled", 22},  {"Menubar.SetItemChecked", 23},
+    {"Menubar.SetItemLabel", 24},    {"Menubar.SetShortcut", 25},
+    {"FileChooser.Show.Open", 26},   {"FileChooser.Show.Save", 27},
+    {"FileChooser.Show.Folder", 28}, {"Clipboard.GetText", 29},
+    {"Clipboard.SetText", 30},       {"Clipboard.HasText", 31},
+    {"Clipboard.GetImage", 32},      {"Clipboard.SetImage", 33},
+    {"Cursor.SetCursor", 34},        {"Cursor.Hide", 35},
+    {"Cursor.Show", 36},             {"Screen.GetDpi", 37},
+    {"Screen.GetWorkArea", 38},      {"Screen.GetRefreshRate", 39},
+    {"Notifications.Show", 40},      {"Notifications.Cancel", 41},
+    {"Notifications.CancelAll", 42}, {"Tray.SetIcon", 43},
+    {"Tray.SetTooltip", 44},         {"Tray.SetMenu", 45},
+    {"Tray.Remove", 46},             {"App.Quit", 47},
+    {"App.GetVersion", 48},          {"App.OpenUrl", 49},
+};
+
+constexpr auto kSmallTable = plugins_common::MakeMethodTable(kSmallEntries);
+constexpr auto kLargeTable = plugins_common::MakeMethodTable(kLargeEntries);
+
+const int kIterations = 2000000;
+
+// Dispatches |name| the way the plugins did before MethodTable: comparing it
+// against each method name in turn.
+template <size_t N>
+int DispatchByComparison(const MethodEntry<int> (&entries)[N],
+                         const std::string &name) {
+  for (const auto &entry : entries) {
+    if (name.compare(entry.name) == 0) {
+      return entry.handler;
+    }
+  }
+  return -1;
+}
+
+// Returns the method names to look up: each method, plus one unknown name,
+// as with a method the plugin doesn't implement.
+template <size_t N>
+std::vector<std::string> GetCalls(const MethodEntry<int> (&entries)[N]) {
+  std::vector<std::string> calls;
+  for (const auto &entry : entries) {
+    calls.push_back(entry.name);
+  }
+  calls.push_back("Unknown.Method");
+  return calls;
+}
+
+// Returns the average time in nanoseconds of calling |dispatch| on each of
+// |calls| in turn.
+template <typename Dispatch>
+double TimeDispatch(const std::vector<std::string> &calls,
+                    Dispatch dispatch) {
+  // Consumes the results, so that the compiler can't remove the lookups.
+  volatile int sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kIterations; ++i) {
+    sink = sink + dispatch(calls[i % calls.size()]);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         kIterations;
+}
+
+template <typename Table, size_t N>
+void RunBenchmark(const char *label, const MethodEntry<int> (&entries)[N],
+                  const Table &table) {
+  std::vector<std::string> calls = GetCalls(entries);
+  double comparison = TimeDispatch(calls, [&](const std::string &name) {
+    return DispatchByComparison(entries, name);
+  });
+  double hashed = TimeDispatch(calls, [&](const std::string &name) {
+    const int *handler = table.Find(name);
+    return handler ? *handler : -1;
+  });
+  std::cout << std::setw(12) << label << std::setw(14) << comparison
+            << std::setw(14) << hashed << std::endl;
+}
+
+}  // namespace
+
+int main() {
+  std::cout << std::fixed << std::setprecision(1) << std::setw(12)
+            << "methods" << std::setw(14) << "compare (ns)" << std::setw(14)
+            << "table (ns)" << std::endl;
+  RunBenchmark("2", kSmallEntries, kSmallTable);
+  RunBenchmark("50", kLargeEntries, kLargeTable);
+  return 0;
+}
@@ -0,0 +1,64 @@
+# Copyright 2019 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+
+# Optimization settings for the C++ code of the Linux runners and plugins,
+# included by their Makefiles. Select one with OPTIMIZATION=<setting>:
+#   none          No optimization flags; the default.
+#   o2            -O2.
+#   lto           -O2 with ThinLTO. The link uses LTO_LDFLAGS, and static
+#                 archives are made with llvm-ar.
+#   pgo-generate  As lto, instrumented to write a profile of each run to
+#                 $LLVM_PROFILE_FILE (default.profraw if unset).
+#   pgo-use       As lto, optimized using PGO_PROFILE, an absolute path to a
+#                 profile merged from pgo-generate runs with
+#                 `llvm-profdata merge`.
+# tools/build_optimized.dart builds and compares all of these.
+#
+# Including Makefiles add OPTIMIZATION_CXXFLAGS to the flags used to both
+# compile and link, and OPTIMIZATION_LDFLAGS to the flags used to link.
+# Objects aren't rebuilt when the setting changes, so each setting should be
+# built into its own OUT_DIR; the testbed Makefile does this.
+OPTIMIZATION=none
+PGO_PROFILE=
+# LTO needs a linker that reads LLVM bitcode.
+LTO_LDFLAGS=-fuse-ld=lld
+
+OPTIMIZATION_CXXFLAGS.none=
+OPTIMIZATION_CXXFLAGS.o2=-O2
+OPTIMIZATION_CXXFLAGS.lto=-O2 -flto=thin
+OPTIMIZATION_CXXFLAGS.pgo-generate=$(OPTIMIZATION_CXXFLAGS.lto) \
+	-fprofile-instr-generate
+# Code that changed since the profile was recorded, or that the training run
+# didn't reach, is compiled as if there were no profile rather than failing
+# the build.
+OPTIMIZATION_CXXFLAGS.pgo-use=$(OPTIMIZATION_CXXFLAGS.lto) \
+	-fprofile-instr-use=$(PGO_PROFILE) -Wno-profile-instr-out-of-date \
+	-Wno-profile-instr-unprofiled
+
+ifeq ($(origin OPTIMIZATION_CXXFLAGS.$(OPTIMIZATION)),undefined)
+$(error Unknown OPTIMIZATION setting '$(OPTIMIZATION)')
+endif
+ifeq ($(OPTIMIZATION),pgo-use)
+ifeq ($(strip $(PGO_PROFILE)),)
+$(error Set PGO_PROFILE to use OPTIMIZATION=pgo-use)
+endif
+endif
+
+OPTIMIZATION_CXXFLAGS=$(OPTIMIZATION_CXXFLAGS.$(OPTIMIZATION))
+ifneq ($(filter lto pgo-%,$(OPTIMIZATION)),)
+OPTIMIZATION_LDFLAGS=$(LTO_LDFLAGS)
+AR=llvm-ar
+else
+OPTIMIZATION_LDFLAGS=
+endif
@@ -0,0 +1,408 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the cost of plugin method calls, end to end and by stage, with the
+// plugins registered against a fake registrar and messenger (see
+// fake_flutter_desktop.h) rather than a Flutter engine. For each call, this
+// reports the time, C++ heap allocations, and allocated bytes per operation
+// for:
+// - encode: serializing the call's payload with the standard codec.
+// - decode: deserializing the payload into the types the plugin uses, from
+//   an arena that is reset after each call, as TypedMethodChannel does.
+// - dispatch: delivering the encoded method call to the plugin's channel,
+//   including decoding it, running the handler, and encoding the reply.
+// The payload is the call's arguments, or its result if it has none.
+//
+// It also reports the dispatch cost of a TaskQueue round trip: posting empty
+// work to a TaskPool worker and running its completion on the main context.
+// Work is only worth moving to the pool if it blocks for longer than that.
+//
+// Allocations made by GTK through GLib are not counted. Calls that use GTK
+// are skipped unless a display is available; `make plugin_benchmark` runs
+// under Xvfb when DISPLAY is not set.
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_call.h>
+#include <flutter/standard_method_codec.h>
+#include <gtk/gtk.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "plugins/common/linux/arena.h"
+#include "plugins/common/linux/fake_flutter_desktop.h"
+#include "plugins/common/linux/standard_codec_stream.h"
+#include "plugins/common/linux/task_pool.h"
+#include "plugins/example_plugin/linux/example_plugin.h"
+#include "plugins/file_chooser/linux/file_chooser_messages.h"
+#include "plugins/menubar/linux/menubar_messages.h"
+#include "plugins/menubar/linux/menubar_plugin.h"
+#include "plugins/window_size/linux/window_size_messages.h"
+#include "plugins/window_size/linux/window_size_plugin.h"
+
+namespace {
+
+size_t g_allocation_count = 0;
+size_t g_allocated_bytes = 0;
+
+}  // namespace
+
+// Counts every allocation made through the default operator new, which the
+// array and nothrow forms also go through.
+void *operator new(size_t size) {
+  ++g_allocation_count;
+  g_allocated_bytes += size;
+  void *pointer = malloc(size == 0 ? 1 : size);
+  if (!pointer) {
+    throw std::bad_alloc();
+  }
+  return pointer;
+}
+
+void operator delete(void *pointer) noexcept { free(pointer); }
+
+void operator delete(void *pointer, size_t size) noexcept { free(pointer); }
+
+namespace {
+
+using plugins_common::StandardCodecReader;
+using plugins_common::StandardCodecWriter;
+
+// Each operation is repeated until it has run for at least this long.
+constexpr std::chrono::milliseconds kMinimumDuration(200);
+
+// The example plugin's channel and method, which it doesn't export.
+constexpr char kExampleChannelName[] = "example_plugin";
+constexpr char kGetPlatformVersionMethod[] = "getPlatformVersion";
+
+// The cost of one run of an operation.
+struct Measurement {
+  double nanoseconds;
+  double allocations;
+  double bytes;
+};
+
+// A method call to benchmark. Any of the operations may be empty, if they
+// don't apply to the call.
+struct Case {
+  std::string name;
+  std::function<void()> encode;
+  std::function<void()> decode;
+  std::function<void()> dispatch;
+};
+
+// Runs |operation| repeatedly, and returns its average cost.
+Measurement Measure(const std::function<void()> &operation) {
+  // Warm up caches, and any lazily created state in the plugins.
+  operation();
+
+  size_t iterations = 0;
+  size_t batch_size = 1;
+  g_allocation_count = 0;
+  g_allocated_bytes = 0;
+  auto start = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::duration elapsed;
+  do {
+    for (size_t i = 0; i < batch_size; ++i) {
+      operation();
+    }
+    iterations += batch_size;
+    batch_size *= 2;
+    elapsed = std::chrono::steady_clock::now() - start;
+  } while (elapsed < kMinimumDuration);
+
+  Measurement measurement;
+  measurement.nanoseconds =
+      std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+  measurement.allocations =
+      static_cast<double>(g_allocation_count) / iterations;
+  measurement.bytes = static_cast<double>(g_allocated_bytes) / iterations;
+  return measurement;
+}
+
+// Returns the encoding of a call to |method| with |arguments|, which can be
+// of any type with an Encode overload, or nullptr for no arguments.
+template <typename T>
+std::vector<uint8_t> EncodeMethodCall(const char *method, const T *arguments) {
+  StandardCodecWriter writer;
+  writer.WriteString(method, strlen(method));
+  if (arguments) {
+    Encode(*arguments, &writer);
+  } else {
+    writer.WriteNull();
+  }
+  return writer.buffer();
+}
+
+// Returns an operation that encodes |value|.
+template <typename T>
+std::function<void()> MakeEncode(const T &value) {
+  return [value]() {
+    StandardCodecWriter writer;
+    Encode(value, &writer);
+  };
+}
+
+// Returns an operation that decodes the encoding of |value|, using an arena
+// that is reset after each decode, as TypedMethodChannel does.
+template <typename T>
+std::function<void()> MakeDecode(const T &value) {
+  StandardCodecWriter writer;
+  Encode(value, &writer);
+  auto arena = std::make_shared<plugins_common::Arena>();
+  return [encoded = writer.buffer(), arena]() {
+    {
+      StandardCodecReader reader(encoded.data(), encoded.size(), arena.get());
+      T decoded;
+      if (!Decode(&reader, &decoded)) {
+        std::cerr << "Failed to decode a payload" << std::endl;
+        exit(1);
+      }
+    }
+    arena->Reset();
+  };
+}
+
+// Returns an operation that delivers |message| to |channel|, which must be
+// answered successfully. Handlers that respond from work on a TaskPool
+// respond from a task posted to the main context, so it is run until the
+// response arrives.
+std::function<void()> MakeDispatch(const char *channel,
+                                   std::vector<uint8_t> message) {
+  return [channel, message = std::move(message),
+          response = std::vector<uint8_t>()]() mutable {
+    bool responded = false;
+    if (!plugins_common::DeliverFakeMessage(channel, message.data(),
+                                            message.size(), &response,
+                                            &responded)) {
+      std::cerr << "No handler for " << channel << std::endl;
+      exit(1);
+    }
+    while (!responded) {
+      g_main_context_iteration(nullptr, TRUE);
+    }
+    if (response.empty() || response[0] != 0) {
+      std::cerr << "Call on " << channel << " was not successful" << std::endl;
+      exit(1);
+    }
+  };
+}
+
+// Returns a menu bar with |item_count| leaf items, in menus of ten.
+plugins_common::ArenaVector<plugins_menubar::MenuItemInfo> GetMenus(
+    int item_count) {
+  plugins_common::ArenaVector<plugins_menubar::MenuItemInfo> menus;
+  for (int i = 0; i < item_count; ++i) {
+    if (i % 10 == 0) {
+      plugins_menubar::MenuItemInfo menu;
+      menu.label = ("Menu " + std::to_string(i / 10)).c_str();
+      menu.has_label = true;
+      menu.has_children = true;
+      menus.push_back(menu);
+    }
+    plugins_menubar::MenuItemInfo item;
+    item.id = i;
+    item.has_id = true;
+    item.label = ("Item " + std::to_string(i)).c_str();
+    item.has_label = true;
+    item.enabled = i % 2 == 0;
+    item.has_enabled = true;
+    menus.back().children.push_back(item);
+  }
+  return menus;
+}
+
+// Returns the screen list that the window size plugin would report for a
+// dual-monitor setup.
+std::vector<plugins_window_size::ScreenInfo> GetScreens() {
+  std::vector<plugins_window_size::ScreenInfo> screens(2);
+  for (size_t i = 0; i < screens.size(); ++i) {
+    plugins_window_size::FrameRect frame;
+    frame.left = 1920.0 * i;
+    frame.width = 1920.0;
+    frame.height = 1080.0;
+    screens[i].frame = frame;
+    frame.top = 27.0;
+    frame.height -= 27.0;
+    screens[i].visible_frame = frame;
+    screens[i].scale_factor = 1.0;
+  }
+  return screens;
+}
+
+std::vector<Case> GetCases(bool have_display) {
+  std::vector<Case> cases;
+
+  {
+    Case window_case;
+    window_case.name = "WindowSize getScreenList";
+    auto screens = GetScreens();
+    window_case.encode = MakeEncode(screens);
+    window_case.decode = MakeDecode(screens);
+    if (have_display) {
+      window_case.dispatch = MakeDispatch(
+          plugins_window_size::kChannelName,
+          EncodeMethodCall<int64_t>(plugins_window_size::kGetScreenListMethod,
+                                    nullptr));
+    }
+    cases.push_back(window_case);
+  }
+
+  {
+    Case window_case;
+    window_case.name = "WindowSize setWindowFrame";
+    plugins_window_size::FrameRect frame;
+    frame.left = 100.0;
+    frame.top = 100.0;
+    frame.width = 1280.0;
+    frame.height = 720.0;
+    window_case.encode = MakeEncode(frame);
+    window_case.decode = MakeDecode(frame);
+    // The window is part of the fake, so this doesn't need GTK.
+    window_case.dispatch = MakeDispatch(
+        plugins_window_size::kChannelName,
+        EncodeMethodCall(plugins_window_size::kSetWindowFrameMethod, &frame));
+    cases.push_back(window_case);
+  }
+
+  for (int item_count : {10, 100, 1000, 10000}) {
+    Case menu_case;
+    menu_case.name = "Menubar SetMenu " + std::to_string(item_count);
+    auto menus = GetMenus(item_count);
+    menu_case.encode = MakeEncode(menus);
+    menu_case.decode = MakeDecode(menus);
+    if (have_display) {
+      menu_case.dispatch = MakeDispatch(
+          plugins_menubar::kChannelName,
+          EncodeMethodCall(plugins_menubar::kSetMenuMethod, &menus));
+    }
+    cases.push_back(menu_case);
+  }
+
+  {
+    // Only encoding and decoding are measured for the file chooser, since
+    // dispatching a call shows a modal dialog.
+    Case file_chooser_case;
+    file_chooser_case.name = "FileChooser showOpenPanel";
+    plugins_file_chooser::FileChooserOptions options;
+    options.initial_directory = "/home/user/Documents/Projects/flutter";
+    options.has_initial_directory = true;
+    for (const char *type : {"png", "jpg", "jpeg", "gif", "webp", "bmp"}) {
+      options.allowed_file_types.push_back(type);
+    }
+    options.has_allowed_file_types = true;
+    options.confirm_button_text = "Import Selected Images";
+    options.has_confirm_button_text = true;
+    options.allows_multiple_selection = true;
+    options.has_allows_multiple_selection = true;
+    file_chooser_case.encode = MakeEncode(options);
+    file_chooser_case.decode = MakeDecode(options);
+    cases.push_back(file_chooser_case);
+  }
+
+  {
+    // The example plugin uses the C++ wrapper's MethodChannel, so its call
+    // is encoded and decoded with the wrapper's codec.
+    Case example_case;
+    example_case.name = "ExamplePlugin getPlatformVersion";
+    const auto &codec = flutter::StandardMethodCodec::GetInstance();
+    flutter::MethodCall<flutter::EncodableValue> call(
+        kGetPlatformVersionMethod, std::unique_ptr<flutter::EncodableValue>());
+    std::vector<uint8_t> encoded = *codec.EncodeMethodCall(call);
+    example_case.encode = [&codec]() {
+      flutter::MethodCall<flutter::EncodableValue> call(
+          kGetPlatformVersionMethod,
+          std::unique_ptr<flutter::EncodableValue>());
+      codec.EncodeMethodCall(call);
+    };
+    example_case.decode = [&codec, encoded]() {
+      codec.DecodeMethodCall(encoded.data(), encoded.size());
+    };
+    example_case.dispatch = MakeDispatch(kExampleChannelName, encoded);
+    cases.push_back(example_case);
+  }
+
+  {
+    Case pool_case;
+    pool_case.name = "TaskQueue round trip";
+    auto queue = std::make_shared<plugins_common::TaskQueue>(
+        &plugins_common::TaskPool::GetShared(), "benchmark");
+    pool_case.dispatch = [queue]() {
+      bool completed = false;
+      if (!queue->Post(
+              [](const plugins_common::CancellationToken &token) { return 0; },
+              [&completed](int result) { completed = true; })) {
+        std::cerr << "Task pool rejected work" << std::endl;
+        exit(1);
+      }
+      while (!completed) {
+        g_main_context_iteration(nullptr, TRUE);
+      }
+    };
+    cases.push_back(pool_case);
+  }
+
+  return cases;
+}
+
+void PrintMeasurement(const std::string &name, const char *operation,
+                      const std::function<void()> &function) {
+  std::cout << std::setw(36) << std::left << name << std::setw(10)
+            << operation << std::right;
+  if (!function) {
+    std::cout << std::setw(14) << "-" << std::setw(12) << "-"
+              << std::setw(12) << "-" << std::endl;
+    return;
+  }
+  Measurement measurement = Measure(function);
+  std::cout << std::setw(14) << measurement.nanoseconds << std::setw(12)
+            << measurement.allocations << std::setw(12) << measurement.bytes
+            << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  bool have_display = gtk_init_check(&argc, &argv);
+  if (!have_display) {
+    std::cerr << "No display available; skipping calls that use GTK."
+              << std::endl;
+  }
+
+  FlutterDesktopPluginRegistrarRef registrar =
+      plugins_common::GetFakeRegistrar();
+  ExamplePluginRegisterWithRegistrar(registrar);
+  MenubarRegisterWithRegistrar(registrar);
+  WindowSizeRegisterWithRegistrar(registrar);
+
+  std::cout << std::fixed << std::setprecision(1) << std::setw(36)
+            << std::left << "call" << std::setw(10) << "stage" << std::right
+            << std::setw(14) << "ns/op" << std::setw(12) << "allocs/op"
+            << std::setw(12) << "bytes/op" << std::endl;
+  for (const Case &benchmark_case : GetCases(have_display)) {
+    PrintMeasurement(benchmark_case.name, "encode", benchmark_case.encode);
+    PrintMeasurement(benchmark_case.name, "decode", benchmark_case.decode);
+    PrintMeasurement(benchmark_case.name, "dispatch",
+                     benchmark_case.dispatch);
+  }
+  return 0;
+}
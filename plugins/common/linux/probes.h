@@ -0,0 +1,98 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_PROBES_H_
+#define PLUGINS_COMMON_LINUX_PROBES_H_
+
+// USDT (user-level statically defined tracing) probes, for attaching
+// bpftrace or perf to a running application without rebuilding it. Each
+// probe compiles to a single nop, plus a note in the binary describing where
+// its arguments are, so it costs nothing measurable when no tracer is
+// attached.
+//
+// Probes are in the flutter_desktop provider, and are listed in
+// runner/README.md. Example scripts are in tools/bpftrace.
+//
+// Probes need <sys/sdt.h> (from systemtap-sdt-dev on Debian and Ubuntu, or
+// systemtap-sdt-devel on Fedora); without it, or with
+// FLUTTER_DESKTOP_NO_PROBES defined, they compile to nothing. This header is
+// also used by the runner.
+//
+// Usage:
+//   FLUTTER_DESKTOP_PROBE1(dialog_open, "file_chooser");
+
+#if !defined(FLUTTER_DESKTOP_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define FLUTTER_DESKTOP_PROBES_ENABLED 1
+#endif
+#endif
+
+#ifdef FLUTTER_DESKTOP_PROBES_ENABLED
+#define FLUTTER_DESKTOP_PROBE(name) DTRACE_PROBE(flutter_desktop, name)
+#define FLUTTER_DESKTOP_PROBE1(name, arg1) \
+  DTRACE_PROBE1(flutter_desktop, name, arg1)
+#define FLUTTER_DESKTOP_PROBE2(name, arg1, arg2) \
+  DTRACE_PROBE2(flutter_desktop, name, arg1, arg2)
+#else
+// Arguments are referenced, but not evaluated, so that variables only used by
+// probes don't cause unused variable warnings.
+#define FLUTTER_DESKTOP_PROBE(name) \
+  do {                              \
+  } while (false)
+#define FLUTTER_DESKTOP_PROBE1(name, arg1) \
+  do {                                     \
+    (void)sizeof(arg1);                    \
+  } while (false)
+#define FLUTTER_DESKTOP_PROBE2(name, arg1, arg2) \
+  do {                                           \
+    (void)sizeof(arg1);                          \
+    (void)sizeof(arg2);                          \
+  } while (false)
+#endif
+
+namespace plugins_common {
+
+// Fires method_call_entry with the channel and method names on construction,
+// and method_call_return with the same arguments on destruction, so that a
+// handler is bracketed on every return path. Both names must outlive the
+// probe.
+class ScopedMethodCallProbe {
+ public:
+#ifdef FLUTTER_DESKTOP_PROBES_ENABLED
+  ScopedMethodCallProbe(const char *channel, const char *method)
+      : channel_(channel), method_(method) {
+    FLUTTER_DESKTOP_PROBE2(method_call_entry, channel_, method_);
+  }
+
+  ~ScopedMethodCallProbe() {
+    FLUTTER_DESKTOP_PROBE2(method_call_return, channel_, method_);
+  }
+#else
+  ScopedMethodCallProbe(const char *channel, const char *method) {}
+#endif
+
+  // Prevent copying.
+  ScopedMethodCallProbe(ScopedMethodCallProbe const &) = delete;
+  ScopedMethodCallProbe &operator=(ScopedMethodCallProbe const &) = delete;
+
+#ifdef FLUTTER_DESKTOP_PROBES_ENABLED
+ private:
+  const char *channel_;
+  const char *method_;
+#endif
+};
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_PROBES_H_
@@ -0,0 +1,523 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_STANDARD_CODEC_STREAM_H_
+#define PLUGINS_COMMON_LINUX_STANDARD_CODEC_STREAM_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "plugins/common/linux/arena.h"
+
+// Streaming access to the standard message codec's wire format, so that
+// values can be decoded directly into plain structs (and encoded from them)
+// without building an EncodableValue tree.
+//
+// The Encode and Decode overloads at the end of this file handle the
+// primitive types; tools/generate_channel_bindings.dart generates overloads
+// for the structs described by a plugin's channel schema. ArenaStrings and
+// ArenaVectors are decoded into the reader's arena, if it has one.
+
+namespace plugins_common {
+
+namespace internal {
+
+// The type tags of the standard message codec.
+enum class StandardCodecType : uint8_t {
+  kNull = 0,
+  kTrue = 1,
+  kFalse = 2,
+  kInt32 = 3,
+  kInt64 = 4,
+  kLargeInt = 5,
+  kFloat64 = 6,
+  kString = 7,
+  kUInt8List = 8,
+  kInt32List = 9,
+  kInt64List = 10,
+  kFloat64List = 11,
+  kList = 12,
+  kMap = 13,
+};
+
+}  // namespace internal
+
+// Reads values in the standard message codec's format from a buffer, in
+// order. Every Read method returns false, without consuming anything, if
+// the next value isn't of the expected type or the buffer is truncated.
+class StandardCodecReader {
+ public:
+  // Creates a reader for |size| bytes at |data|, which must outlive it.
+  // If |arena| is provided, decoded ArenaStrings and ArenaVectors are
+  // allocated from it.
+  StandardCodecReader(const uint8_t *data, size_t size,
+                      Arena *arena = nullptr)
+      : data_(data), size_(size), arena_(arena) {}
+
+  // Returns the arena for decoded values, or nullptr to use the heap.
+  Arena *arena() const { return arena_; }
+
+  // Consumes the next value and returns true if it is null.
+  bool ReadNull() {
+    if (PeekType() != Type::kNull) {
+      return false;
+    }
+    ++position_;
+    return true;
+  }
+
+  bool ReadBool(bool *value) {
+    Type type = PeekType();
+    if (type != Type::kTrue && type != Type::kFalse) {
+      return false;
+    }
+    ++position_;
+    *value = type == Type::kTrue;
+    return true;
+  }
+
+  // Reads an int32 or int64.
+  bool ReadInt(int64_t *value) {
+    size_t start = position_;
+    Type type;
+    if (!ReadType(&type)) {
+      return false;
+    }
+    if (type == Type::kInt32) {
+      int32_t int32_value;
+      if (ReadBytes(&int32_value, sizeof(int32_value))) {
+        *value = int32_value;
+        return true;
+      }
+    } else if (type == Type::kInt64) {
+      if (ReadBytes(value, sizeof(*value))) {
+        return true;
+      }
+    }
+    position_ = start;
+    return false;
+  }
+
+  // Reads a float64. Integers are also accepted, since the sender may not
+  // distinguish them from doubles with no fractional part.
+  bool ReadDouble(double *value) {
+    if (PeekType() != Type::kFloat64) {
+      int64_t int_value;
+      if (!ReadInt(&int_value)) {
+        return false;
+      }
+      *value = static_cast<double>(int_value);
+      return true;
+    }
+    size_t start = position_;
+    ++position_;
+    if (!Align(8) || !ReadBytes(value, sizeof(*value))) {
+      position_ = start;
+      return false;
+    }
+    return true;
+  }
+
+  // Sets |data| and |size| to the UTF-8 bytes of the next value, which must
+  // be a string. The bytes point into the reader's buffer, and are not
+  // null-terminated.
+  bool ReadStringView(const char **data, size_t *size) {
+    size_t start = position_;
+    Type type;
+    if (!ReadType(&type) || type != Type::kString || !ReadSize(size) ||
+        *size > size_ - position_) {
+      position_ = start;
+      return false;
+    }
+    *data = reinterpret_cast<const char *>(data_ + position_);
+    position_ += *size;
+    return true;
+  }
+
+  bool ReadString(std::string *value) {
+    const char *data;
+    size_t size;
+    if (!ReadStringView(&data, &size)) {
+      return false;
+    }
+    value->assign(data, size);
+    return true;
+  }
+
+  // Reads the header of a list, setting |size| to its element count. The
+  // elements follow.
+  bool ReadListSize(size_t *size) {
+    return ReadContainerSize(Type::kList, size);
+  }
+
+  // Reads the header of a map, setting |size| to its entry count. The keys
+  // and values follow, alternating.
+  bool ReadMapSize(size_t *size) {
+    return ReadContainerSize(Type::kMap, size);
+  }
+
+  // Consumes the next value, whatever its type.
+  bool Skip() {
+    size_t start = position_;
+    if (!SkipValue()) {
+      position_ = start;
+      return false;
+    }
+    return true;
+  }
+
+  // Returns true if the whole buffer has been read.
+  bool AtEnd() const { return position_ == size_; }
+
+ private:
+  using Type = internal::StandardCodecType;
+
+  // Returns the type of the next value, or kLargeInt (which is never
+  // otherwise accepted) at the end of the buffer.
+  Type PeekType() const {
+    return position_ < size_ ? static_cast<Type>(data_[position_])
+                             : Type::kLargeInt;
+  }
+
+  bool ReadType(Type *type) {
+    if (position_ >= size_) {
+      return false;
+    }
+    *type = static_cast<Type>(data_[position_++]);
+    return true;
+  }
+
+  bool ReadBytes(void *destination, size_t count) {
+    if (count > size_ - position_) {
+      return false;
+    }
+    memcpy(destination, data_ + position_, count);
+    position_ += count;
+    return true;
+  }
+
+  // Reads a size, which is one byte below 254, or a marker byte followed by
+  // a uint16 (254) or uint32 (255).
+  bool ReadSize(size_t *size) {
+    uint8_t first;
+    if (!ReadBytes(&first, 1)) {
+      return false;
+    }
+    if (first < 254) {
+      *size = first;
+      return true;
+    }
+    if (first == 254) {
+      uint16_t value;
+      if (!ReadBytes(&value, sizeof(value))) {
+        return false;
+      }
+      *size = value;
+      return true;
+    }
+    uint32_t value;
+    if (!ReadBytes(&value, sizeof(value))) {
+      return false;
+    }
+    *size = value;
+    return true;
+  }
+
+  // Skips padding to a multiple of |alignment| from the start of the buffer.
+  bool Align(size_t alignment) {
+    size_t padding = (alignment - position_ % alignment) % alignment;
+    if (padding > size_ - position_) {
+      return false;
+    }
+    position_ += padding;
+    return true;
+  }
+
+  // Reads a list or map header. Every element takes at least a byte, so a
+  // size beyond the end of the buffer is rejected before anything is
+  // allocated for it.
+  bool ReadContainerSize(Type expected_type, size_t *size) {
+    size_t start = position_;
+    Type type;
+    if (!ReadType(&type) || type != expected_type || !ReadSize(size) ||
+        *size > size_ - position_) {
+      position_ = start;
+      return false;
+    }
+    return true;
+  }
+
+  // Skips |count| elements of |element_size| bytes, after aligning to
+  // |element_size|.
+  bool SkipArray(size_t count, size_t element_size) {
+    if (!Align(element_size) || count > (size_ - position_) / element_size) {
+      return false;
+    }
+    position_ += count * element_size;
+    return true;
+  }
+
+  // Skips the next value. On failure, the position is unspecified.
+  bool SkipValue() {
+    Type type;
+    if (!ReadType(&type)) {
+      return false;
+    }
+    size_t size;
+    switch (type) {
+      case Type::kNull:
+      case Type::kTrue:
+      case Type::kFalse:
+        return true;
+      case Type::kInt32:
+        return SkipArray(4, 1);
+      case Type::kInt64:
+        return SkipArray(8, 1);
+      case Type::kFloat64:
+        return SkipArray(1, 8);
+      case Type::kLargeInt:
+      case Type::kString:
+      case Type::kUInt8List:
+        return ReadSize(&size) && SkipArray(size, 1);
+      case Type::kInt32List:
+        return ReadSize(&size) && SkipArray(size, 4);
+      case Type::kInt64List:
+      case Type::kFloat64List:
+        return ReadSize(&size) && SkipArray(size, 8);
+      case Type::kList:
+        if (!ReadSize(&size)) {
+          return false;
+        }
+        for (size_t i = 0; i < size; ++i) {
+          if (!SkipValue()) {
+            return false;
+          }
+        }
+        return true;
+      case Type::kMap:
+        if (!ReadSize(&size)) {
+          return false;
+        }
+        for (size_t i = 0; i < size; ++i) {
+          if (!SkipValue() || !SkipValue()) {
+            return false;
+          }
+        }
+        return true;
+    }
+    return false;
+  }
+
+  const uint8_t *data_;
+  size_t size_;
+  size_t position_ = 0;
+  Arena *arena_;
+};
+
+// Writes values in the standard message codec's format to a growing buffer.
+class StandardCodecWriter {
+ public:
+  StandardCodecWriter() { buffer_.reserve(64); }
+
+  // Returns the encoded bytes.
+  const std::vector<uint8_t> &buffer() const { return buffer_; }
+
+  // Writes a raw byte, such as a method codec envelope's status byte.
+  void WriteByte(uint8_t byte) { buffer_.push_back(byte); }
+
+  void WriteNull() { WriteType(Type::kNull); }
+
+  void WriteBool(bool value) { WriteType(value ? Type::kTrue : Type::kFalse); }
+
+  // Writes |value| as an int32 if it fits, or an int64.
+  void WriteInt(int64_t value) {
+    if (value >= INT32_MIN && value <= INT32_MAX) {
+      WriteType(Type::kInt32);
+      int32_t int32_value = static_cast<int32_t>(value);
+      WriteBytes(&int32_value, sizeof(int32_value));
+    } else {
+      WriteType(Type::kInt64);
+      WriteBytes(&value, sizeof(value));
+    }
+  }
+
+  void WriteDouble(double value) {
+    WriteType(Type::kFloat64);
+    Align(8);
+    WriteBytes(&value, sizeof(value));
+  }
+
+  void WriteString(const char *data, size_t size) {
+    WriteType(Type::kString);
+    WriteSize(size);
+    WriteBytes(data, size);
+  }
+
+  void WriteString(const std::string &value) {
+    WriteString(value.data(), value.size());
+  }
+
+  // Writes |count| doubles from |values| as a Float64List.
+  void WriteFloat64List(const double *values, size_t count) {
+    WriteType(Type::kFloat64List);
+    WriteSize(count);
+    Align(8);
+    WriteBytes(values, count * sizeof(double));
+  }
+
+  // Writes the header of a list of |size| elements, which the caller must
+  // then write.
+  void WriteListSize(size_t size) {
+    WriteType(Type::kList);
+    WriteSize(size);
+  }
+
+  // Writes the header of a map of |size| entries, whose keys and values the
+  // caller must then write, alternating.
+  void WriteMapSize(size_t size) {
+    WriteType(Type::kMap);
+    WriteSize(size);
+  }
+
+ private:
+  using Type = internal::StandardCodecType;
+
+  void WriteType(Type type) { buffer_.push_back(static_cast<uint8_t>(type)); }
+
+  void WriteBytes(const void *data, size_t count) {
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    buffer_.insert(buffer_.end(), bytes, bytes + count);
+  }
+
+  void WriteSize(size_t size) {
+    if (size < 254) {
+      buffer_.push_back(static_cast<uint8_t>(size));
+    } else if (size <= 0xffff) {
+      buffer_.push_back(254);
+      uint16_t value = static_cast<uint16_t>(size);
+      WriteBytes(&value, sizeof(value));
+    } else {
+      buffer_.push_back(255);
+      uint32_t value = static_cast<uint32_t>(size);
+      WriteBytes(&value, sizeof(value));
+    }
+  }
+
+  // Pads to a multiple of |alignment| from the start of the buffer.
+  void Align(size_t alignment) {
+    size_t padding = (alignment - buffer_.size() % alignment) % alignment;
+    buffer_.insert(buffer_.end(), padding, 0);
+  }
+
+  std::vector<uint8_t> buffer_;
+};
+
+// Encode and Decode overloads for the primitive types of channel schemas.
+// Each Decode returns false if the next value is of the wrong type.
+
+inline void Encode(bool value, StandardCodecWriter *writer) {
+  writer->WriteBool(value);
+}
+
+inline void Encode(int64_t value, StandardCodecWriter *writer) {
+  writer->WriteInt(value);
+}
+
+inline void Encode(double value, StandardCodecWriter *writer) {
+  writer->WriteDouble(value);
+}
+
+inline void Encode(const std::string &value, StandardCodecWriter *writer) {
+  writer->WriteString(value);
+}
+
+inline void Encode(const ArenaString &value, StandardCodecWriter *writer) {
+  writer->WriteString(value.data(), value.size());
+}
+
+template <typename T, typename Allocator>
+void Encode(const std::vector<T, Allocator> &value,
+            StandardCodecWriter *writer) {
+  writer->WriteListSize(value.size());
+  for (const T &element : value) {
+    Encode(element, writer);
+  }
+}
+
+inline bool Decode(StandardCodecReader *reader, bool *value) {
+  return reader->ReadBool(value);
+}
+
+inline bool Decode(StandardCodecReader *reader, int64_t *value) {
+  return reader->ReadInt(value);
+}
+
+inline bool Decode(StandardCodecReader *reader, double *value) {
+  return reader->ReadDouble(value);
+}
+
+inline bool Decode(StandardCodecReader *reader, std::string *value) {
+  return reader->ReadString(value);
+}
+
+inline bool Decode(StandardCodecReader *reader, ArenaString *value) {
+  const char *data;
+  size_t size;
+  if (!reader->ReadStringView(&data, &size)) {
+    return false;
+  }
+  ReplaceWithAllocator(value, data, size,
+                       ArenaAllocator<char>(reader->arena()));
+  return true;
+}
+
+template <typename T>
+bool Decode(StandardCodecReader *reader, std::vector<T> *value) {
+  size_t size;
+  if (!reader->ReadListSize(&size)) {
+    return false;
+  }
+  value->clear();
+  value->resize(size);
+  for (T &element : *value) {
+    if (!Decode(reader, &element)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename T>
+bool Decode(StandardCodecReader *reader, ArenaVector<T> *value) {
+  size_t size;
+  if (!reader->ReadListSize(&size)) {
+    return false;
+  }
+  // Elements are default-constructed with heap allocators, but decoding
+  // replaces any arena-aware members of theirs as well, without allocating
+  // from the heap.
+  ReplaceWithAllocator(value, size, ArenaAllocator<T>(reader->arena()));
+  for (T &element : *value) {
+    if (!Decode(reader, &element)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_STANDARD_CODEC_STREAM_H_
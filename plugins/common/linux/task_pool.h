@@ -0,0 +1,402 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_TASK_POOL_H_
+#define PLUGINS_COMMON_LINUX_TASK_POOL_H_
+
+#include <glib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Background work for plugins, so that blocking or CPU-heavy parts of a
+// method call don't stall the platform thread, which also handles input and
+// rendering.
+//
+// Work runs on a TaskPool: a fixed set of worker threads, each with its own
+// queue, that take work from each other's queues when theirs is empty. Each
+// plugin submits work through its own TaskQueue, which runs the completion
+// for each piece of work back on the platform thread, tracks queue depth,
+// and cancels outstanding work when destroyed.
+//
+// Usage:
+//   TaskQueue queue(&TaskPool::GetShared(), "my_plugin");
+//   ...
+//   TaskHandle handle = queue.Post(
+//       [](const CancellationToken &token) { return ComputeSomething(); },
+//       [reply](std::string value) mutable { reply.Success(value); },
+//       [reply]() mutable { reply.Error("Cancelled"); });
+//   if (!handle) {
+//     reply.Error("Busy", "Too many pending requests");
+//   }
+//
+// Work must not call GTK or GDK, which may only be used from the platform
+// thread; do that in the completion instead.
+
+namespace plugins_common {
+
+// Schedules |task| to run on the platform thread.
+//
+// This uses the default GLib main context, which the platform thread
+// iterates on each pass of the runner's event loop, so it is safe to call
+// from any thread.
+inline void PostToPlatformThread(std::function<void()> task) {
+  g_idle_add_full(
+      G_PRIORITY_DEFAULT,
+      [](gpointer data) -> gboolean {
+        (*static_cast<std::function<void()> *>(data))();
+        return G_SOURCE_REMOVE;
+      },
+      new std::function<void()>(std::move(task)),
+      [](gpointer data) { delete static_cast<std::function<void()> *>(data); });
+}
+
+// Lets long-running work check whether it has been cancelled, so that it can
+// stop early. Its result is discarded either way.
+class CancellationToken {
+ public:
+  explicit CancellationToken(std::shared_ptr<std::atomic<bool>> cancelled)
+      : cancelled_(std::move(cancelled)) {}
+
+  bool IsCancelled() const { return cancelled_->load(); }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// A piece of work posted to a TaskQueue. Converts to false if the work was
+// rejected because the pool was full.
+class TaskHandle {
+ public:
+  TaskHandle() = default;
+  explicit TaskHandle(std::shared_ptr<std::atomic<bool>> cancelled)
+      : cancelled_(std::move(cancelled)) {}
+
+  explicit operator bool() const { return cancelled_ != nullptr; }
+
+  // Cancels the work. If it hasn't started it won't run, and either way its
+  // cancellation callback runs instead of its completion. Must be called on
+  // the platform thread.
+  void Cancel() {
+    if (cancelled_) {
+      cancelled_->store(true);
+    }
+  }
+
+ private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+// A snapshot of a TaskQueue's activity.
+struct TaskQueueMetrics {
+  // Work waiting for a worker thread.
+  size_t queued = 0;
+  // Work running on a worker thread.
+  size_t running = 0;
+  // The largest value of |queued| so far.
+  size_t max_queued = 0;
+  // Work whose completion has run.
+  uint64_t completed = 0;
+  // Work whose cancellation callback has run, or would have if it had one.
+  uint64_t cancelled = 0;
+  // Work that was rejected because the pool was full.
+  uint64_t rejected = 0;
+};
+
+// A bounded pool of worker threads.
+class TaskPool {
+ public:
+  // Creates a pool with |thread_count| workers, which accepts at most
+  // |max_queued_tasks| tasks waiting to run at once.
+  TaskPool(size_t thread_count, size_t max_queued_tasks)
+      : max_queued_tasks_(max_queued_tasks) {
+    for (size_t i = 0; i < std::max<size_t>(thread_count, 1); ++i) {
+      workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < workers_.size(); ++i) {
+      workers_[i]->thread = std::thread(&TaskPool::Run, this, i);
+    }
+  }
+
+  ~TaskPool() {
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto &worker : workers_) {
+      worker->thread.join();
+    }
+  }
+
+  // Prevent copying.
+  TaskPool(TaskPool const &) = delete;
+  TaskPool &operator=(TaskPool const &) = delete;
+
+  // Returns the pool shared by the plugins in this library, with a worker
+  // per core, up to four.
+  static TaskPool &GetShared() {
+    static auto *pool = new TaskPool(
+        std::min<size_t>(std::max(std::thread::hardware_concurrency(), 1u), 4),
+        kDefaultMaxQueuedTasks);
+    return *pool;
+  }
+
+  // Queues |task| to run on a worker thread. Returns false, without queuing
+  // it, if the pool already has its maximum number of tasks waiting.
+  bool Submit(std::function<void()> task) {
+    // Reserve a place without ever exceeding the limit, even briefly.
+    size_t reserved = reserved_tasks_.load();
+    do {
+      if (reserved >= max_queued_tasks_) {
+        return false;
+      }
+    } while (!reserved_tasks_.compare_exchange_weak(reserved, reserved + 1));
+    Worker &worker = *workers_[next_worker_.fetch_add(1) % workers_.size()];
+    {
+      // Counted under the queue's lock, so that a worker woken by the count
+      // finds the task.
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      worker.tasks.push_back(std::move(task));
+      queued_tasks_.fetch_add(1);
+    }
+    {
+      // Taking the lock ensures that a worker about to wait sees the task.
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_.notify_one();
+    return true;
+  }
+
+ private:
+  static constexpr size_t kDefaultMaxQueuedTasks = 256;
+
+  struct Worker {
+    std::mutex mutex;
+    // Tasks are taken from the front by the owner, and from the back by
+    // other workers, so that a thief takes the work its owner would reach
+    // last.
+    std::deque<std::function<void()>> tasks;
+    std::thread thread;
+  };
+
+  // Removes a task for worker |index| to run, preferring its own queue.
+  // Returns false if every queue is empty.
+  bool TakeTask(size_t index, std::function<void()> *task) {
+    for (size_t offset = 0; offset < workers_.size(); ++offset) {
+      Worker &worker = *workers_[(index + offset) % workers_.size()];
+      std::lock_guard<std::mutex> lock(worker.mutex);
+      if (worker.tasks.empty()) {
+        continue;
+      }
+      if (offset == 0) {
+        *task = std::move(worker.tasks.front());
+        worker.tasks.pop_front();
+      } else {
+        *task = std::move(worker.tasks.back());
+        worker.tasks.pop_back();
+      }
+      queued_tasks_.fetch_sub(1);
+      reserved_tasks_.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  // The loop run by worker |index|.
+  void Run(size_t index) {
+    while (true) {
+      std::function<void()> task;
+      if (TakeTask(index, &task)) {
+        task();
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_.wait(lock, [this] { return stopping_ || queued_tasks_ > 0; });
+      if (stopping_) {
+        return;
+      }
+    }
+  }
+
+  const size_t max_queued_tasks_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::atomic<size_t> next_worker_{0};
+  // The number of tasks in all workers' queues, which changes only while
+  // holding the lock of the queue a task is added to or taken from.
+  std::atomic<size_t> queued_tasks_{0};
+  // The number of tasks queued or being queued, which |max_queued_tasks_|
+  // limits.
+  std::atomic<size_t> reserved_tasks_{0};
+
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  bool stopping_ = false;
+};
+
+// One plugin's work on a TaskPool. Must be created, used, and destroyed on
+// the platform thread.
+class TaskQueue {
+ public:
+  // Creates a queue for work on |pool|, which must outlive it. |name|
+  // identifies the queue in diagnostics.
+  TaskQueue(TaskPool *pool, std::string name)
+      : pool_(pool), state_(std::make_shared<State>()) {
+    state_->name = std::move(name);
+  }
+
+  // Cancels all outstanding work, and waits for any that is running to
+  // return. No completions or cancellation callbacks run after this.
+  ~TaskQueue() {
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->alive = false;
+    state_->idle.wait(lock, [this] { return state_->running == 0; });
+  }
+
+  // Prevent copying.
+  TaskQueue(TaskQueue const &) = delete;
+  TaskQueue &operator=(TaskQueue const &) = delete;
+
+  const std::string &name() const { return state_->name; }
+
+  // Runs |work| on a worker thread, then |on_complete| with its result on
+  // the platform thread. If the work is cancelled, |on_cancelled|, if any,
+  // runs on the platform thread instead of |on_complete|.
+  //
+  // |work| is called with a CancellationToken, and must return a value of a
+  // movable type. |work| and the callbacks must be copyable.
+  //
+  // Returns a handle that converts to false if the pool is full, in which
+  // case none of the functions will run.
+  template <typename Work, typename Completion>
+  TaskHandle Post(Work work, Completion on_complete,
+                  std::function<void()> on_cancelled = nullptr) {
+    using Result =
+        typename std::result_of<Work(const CancellationToken &)>::type;
+    auto cancelled = std::make_shared<std::atomic<bool>>(false);
+    std::shared_ptr<State> state = state_;
+    auto task = [state, cancelled, work, on_complete, on_cancelled]() {
+      --state->queued;
+      {
+        // Checked under the lock, so that the destructor either sees this
+        // work running and waits for it, or this sees the queue destroyed.
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (*cancelled || !state->alive) {
+          PostCancellation(state, on_cancelled);
+          return;
+        }
+        ++state->running;
+      }
+      auto result =
+          std::make_shared<Result>(work(CancellationToken(cancelled)));
+      {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        --state->running;
+      }
+      state->idle.notify_all();
+      if (*cancelled) {
+        PostCancellation(state, on_cancelled);
+        return;
+      }
+      PostToPlatformThread([state, cancelled, result, on_complete,
+                            on_cancelled]() mutable {
+        if (!state->alive) {
+          return;
+        }
+        if (*cancelled) {
+          ++state->cancelled;
+          if (on_cancelled) {
+            on_cancelled();
+          }
+          return;
+        }
+        ++state->completed;
+        on_complete(std::move(*result));
+      });
+    };
+
+    size_t queued = ++state_->queued;
+    if (!pool_->Submit(std::move(task))) {
+      --state_->queued;
+      ++state_->rejected;
+      return TaskHandle();
+    }
+    size_t max_queued = state_->max_queued;
+    while (queued > max_queued &&
+           !state_->max_queued.compare_exchange_weak(max_queued, queued)) {
+    }
+    return TaskHandle(cancelled);
+  }
+
+  // Returns the current state of the queue.
+  TaskQueueMetrics GetMetrics() const {
+    TaskQueueMetrics metrics;
+    metrics.queued = state_->queued;
+    metrics.running = state_->running;
+    metrics.max_queued = state_->max_queued;
+    metrics.completed = state_->completed;
+    metrics.cancelled = state_->cancelled;
+    metrics.rejected = state_->rejected;
+    return metrics;
+  }
+
+ private:
+  // The state shared with posted work, which can outlive the queue.
+  struct State {
+    std::string name;
+    std::atomic<bool> alive{true};
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> running{0};
+    std::atomic<size_t> max_queued{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> cancelled{0};
+    std::atomic<uint64_t> rejected{0};
+    // Signalled when |running| drops, for the destructor.
+    std::mutex mutex;
+    std::condition_variable idle;
+  };
+
+  // Runs |on_cancelled|, if any, on the platform thread, unless the queue
+  // has been destroyed by then.
+  static void PostCancellation(const std::shared_ptr<State> &state,
+                               std::function<void()> on_cancelled) {
+    PostToPlatformThread([state, on_cancelled]() {
+      if (!state->alive) {
+        return;
+      }
+      ++state->cancelled;
+      if (on_cancelled) {
+        on_cancelled();
+      }
+    });
+  }
+
+  TaskPool *pool_;
+  std::shared_ptr<State> state_;
+};
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_TASK_POOL_H_
@@ -0,0 +1,170 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_TYPED_METHOD_CHANNEL_H_
+#define PLUGINS_COMMON_LINUX_TYPED_METHOD_CHANNEL_H_
+
+#include <flutter/binary_messenger.h>
+
+#include <functional>
+#include <string>
+#include <utility>
+
+#include "plugins/common/linux/method_table.h"
+#include "plugins/common/linux/probes.h"
+#include "plugins/common/linux/standard_codec_stream.h"
+
+namespace plugins_common {
+
+// Sends the response to a method call, in the standard method codec's
+// envelope format. Exactly one response method should be called.
+class MethodReply {
+ public:
+  explicit MethodReply(flutter::BinaryReply reply) : reply_(std::move(reply)) {}
+
+  // Replies with a null result.
+  void Success() {
+    StandardCodecWriter writer;
+    writer.WriteByte(kSuccessEnvelope);
+    writer.WriteNull();
+    Send(writer);
+  }
+
+  // Replies with |result|, which can be of any type with an Encode overload.
+  template <typename T>
+  void Success(const T &result) {
+    StandardCodecWriter writer;
+    writer.WriteByte(kSuccessEnvelope);
+    Encode(result, &writer);
+    Send(writer);
+  }
+
+  void Error(const std::string &code, const std::string &message = "") {
+    StandardCodecWriter writer;
+    writer.WriteByte(kErrorEnvelope);
+    writer.WriteString(code);
+    if (message.empty()) {
+      writer.WriteNull();
+    } else {
+      writer.WriteString(message);
+    }
+    // No details.
+    writer.WriteNull();
+    Send(writer);
+  }
+
+  void NotImplemented() { reply_(nullptr, 0); }
+
+ private:
+  static constexpr uint8_t kSuccessEnvelope = 0;
+  static constexpr uint8_t kErrorEnvelope = 1;
+
+  void Send(const StandardCodecWriter &writer) {
+    reply_(writer.buffer().data(), writer.buffer().size());
+  }
+
+  flutter::BinaryReply reply_;
+};
+
+// A method channel using the standard method codec that hands its handler
+// the method as a MethodTable value and the arguments as an unread stream,
+// so that they can be decoded straight into the generated structs for the
+// channel's schema.
+//
+// The reader allocates decoded ArenaStrings and ArenaVectors from an arena
+// owned by the channel, which is reset in one step after the handler
+// returns, so decoding a message makes few or no heap allocations. Decoded
+// values must therefore not be kept beyond the handler; copy any that are
+// needed later, since copies use the heap. Assigning a decoded value, even
+// with std::move, to an existing heap-allocated container also copies it,
+// but move-constructing a new container from one keeps the arena, so never
+// initialize a longer-lived value with std::move of a decoded one.
+//
+// Usage:
+//   channel.SetMethodCallHandler(
+//       kMethods, [](Method method, StandardCodecReader *arguments,
+//                    MethodReply reply) {
+//         SomeMessage message;
+//         if (!Decode(arguments, &message)) { ... }
+//       });
+class TypedMethodChannel {
+ public:
+  // Creates a channel named |name| on |messenger|, which must outlive it.
+  TypedMethodChannel(flutter::BinaryMessenger *messenger, std::string name)
+      : messenger_(messenger), name_(std::move(name)) {}
+
+  // Prevent copying.
+  TypedMethodChannel(TypedMethodChannel const &) = delete;
+  TypedMethodChannel &operator=(TypedMethodChannel const &) = delete;
+
+  // Registers |handler| for calls to the methods in |methods|, which must
+  // outlive the channel. Calls to other methods are answered as not
+  // implemented. The channel must outlive the registration.
+  template <typename Method, size_t N>
+  void SetMethodCallHandler(
+      const MethodTable<Method, N> &methods,
+      std::function<void(Method, StandardCodecReader *, MethodReply)>
+          handler) {
+    messenger_->SetMessageHandler(
+        name_, [this, &methods, handler](const uint8_t *message,
+                                         size_t message_size,
+                                         flutter::BinaryReply binary_reply) {
+          MethodReply reply(std::move(binary_reply));
+          StandardCodecReader reader(message, message_size, &arena_);
+          const char *method_name;
+          size_t method_name_size;
+          if (!reader.ReadStringView(&method_name, &method_name_size)) {
+            reply.Error("Bad Method Call", "Unable to read method name");
+            return;
+          }
+          const MethodEntry<Method> *method =
+              methods.FindEntry(method_name, method_name_size);
+          if (!method) {
+            reply.NotImplemented();
+            return;
+          }
+          ScopedMethodCallProbe probe(name_.c_str(), method->name);
+          // Handlers that run a nested event loop, such as for a modal
+          // dialog, can receive another call before returning, so the arena
+          // is only reset once the outermost call is done.
+          ++active_calls_;
+          handler(method->handler, &reader, std::move(reply));
+          if (--active_calls_ == 0) {
+            arena_.Reset();
+          }
+        });
+  }
+
+  // Calls |method| on the Dart side of the channel with |arguments|, which
+  // can be of any type with an Encode overload. Any response is ignored.
+  template <typename T>
+  void InvokeMethod(const char *method, const T &arguments) {
+    StandardCodecWriter writer;
+    writer.WriteString(method, strlen(method));
+    Encode(arguments, &writer);
+    messenger_->Send(name_, writer.buffer().data(), writer.buffer().size());
+  }
+
+ private:
+  flutter::BinaryMessenger *messenger_;
+  std::string name_;
+
+  // The arena for values decoded from incoming calls.
+  Arena arena_;
+  // The number of calls whose handlers are running.
+  int active_calls_ = 0;
+};
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_TYPED_METHOD_CHANNEL_H_
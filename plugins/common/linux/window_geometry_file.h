@@ -0,0 +1,110 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_COMMON_LINUX_WINDOW_GEOMETRY_FILE_H_
+#define PLUGINS_COMMON_LINUX_WINDOW_GEOMETRY_FILE_H_
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <string>
+
+// The window geometry file, which the window_size plugin writes as the window
+// moves and the runner reads before creating the window, so that the window
+// is created with its last size and position instead of being moved by Dart
+// after the first frame.
+//
+// The file is a single line of text:
+//   <version> <left> <top> <width> <height> <monitor left> <monitor top>
+//       <monitor width> <monitor height>
+// where the monitor values are the frame of the monitor that the window was
+// on, or all 0 if it wasn't known. All values are in screen coordinates.
+
+namespace plugins_common {
+
+struct WindowGeometry {
+  int left = 0;
+  int top = 0;
+  int width = 0;
+  int height = 0;
+  int monitor_left = 0;
+  int monitor_top = 0;
+  int monitor_width = 0;
+  int monitor_height = 0;
+};
+
+inline bool operator==(const WindowGeometry &a, const WindowGeometry &b) {
+  return a.left == b.left && a.top == b.top && a.width == b.width &&
+         a.height == b.height && a.monitor_left == b.monitor_left &&
+         a.monitor_top == b.monitor_top &&
+         a.monitor_width == b.monitor_width &&
+         a.monitor_height == b.monitor_height;
+}
+
+namespace internal {
+
+constexpr int kWindowGeometryVersion = 1;
+
+}  // namespace internal
+
+// Reads the geometry saved at |path| into |geometry|. Returns false if there
+// is no file, or it is malformed or from a different version.
+inline bool ReadWindowGeometry(const std::string &path,
+                               WindowGeometry *geometry) {
+  FILE *file = fopen(path.c_str(), "re");
+  if (!file) {
+    return false;
+  }
+  int version = 0;
+  WindowGeometry read;
+  int fields = fscanf(file, "%d %d %d %d %d %d %d %d %d", &version,
+                      &read.left, &read.top, &read.width, &read.height,
+                      &read.monitor_left, &read.monitor_top,
+                      &read.monitor_width, &read.monitor_height);
+  fclose(file);
+  if (fields != 9 || version != internal::kWindowGeometryVersion ||
+      read.width <= 0 || read.height <= 0) {
+    return false;
+  }
+  *geometry = read;
+  return true;
+}
+
+// Saves |geometry| to |path|, whose directory must exist. Returns false on
+// failure.
+inline bool WriteWindowGeometry(const std::string &path,
+                                const WindowGeometry &geometry) {
+  // Write to a temporary file and rename, so that a runner starting at the
+  // same time never reads a partial file.
+  std::string temporary_path = path + "." + std::to_string(getpid());
+  FILE *file = fopen(temporary_path.c_str(), "we");
+  if (!file) {
+    return false;
+  }
+  bool written =
+      fprintf(file, "%d %d %d %d %d %d %d %d %d\n",
+              internal::kWindowGeometryVersion, geometry.left, geometry.top,
+              geometry.width, geometry.height, geometry.monitor_left,
+              geometry.monitor_top, geometry.monitor_width,
+              geometry.monitor_height) > 0;
+  written = fclose(file) == 0 && written;
+  if (!written || rename(temporary_path.c_str(), path.c_str()) != 0) {
+    remove(temporary_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace plugins_common
+
+#endif  // PLUGINS_COMMON_LINUX_WINDOW_GEOMETRY_FILE_H_
@@ -20,8 +20,21 @@
 #include <memory>
 #include <sstream>
 
+#include "plugins/common/linux/method_table.h"
+#include "plugins/common/linux/probes.h"
+
 namespace {
 
+constexpr char kChannelName[] = "example_plugin";
+constexpr char kGetPlatformVersionMethod[] = "getPlatformVersion";
+
+enum class Method { kGetPlatformVersion };
+
+constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {
+    {kGetPlatformVersionMethod, Method::kGetPlatformVersion},
+};
+constexpr auto kMethods = plugins_common::MakeMethodTable(kMethodEntries);
+
 class ExamplePlugin : public flutter::Plugin {
  public:
   static void RegisterWithRegistrar(flutter::PluginRegistrar *registrar);
@@ -46,7 +59,7 @@ class ExamplePlugin : public flutter::Plugin {
 void ExamplePlugin::RegisterWithRegistrar(flutter::PluginRegistrar *registrar) {
   auto channel =
       std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
-          registrar->messenger(), "example_plugin",
+          registrar->messenger(), kChannelName,
           &flutter::StandardMethodCodec::GetInstance());
   auto *channel_pointer = channel.get();
 
@@ -69,15 +82,23 @@ ExamplePlugin::~ExamplePlugin(){};
 void ExamplePlugin::HandleMethodCall(
     const flutter::MethodCall<flutter::EncodableValue> &method_call,
     std::unique_ptr<flutter::MethodResult<flutter::EncodableValue>> result) {
-  if (method_call.method_name().compare("getPlatformVersion") == 0) {
-    struct utsname uname_data = {};
-    uname(&uname_data);
-    std::ostringstream version_stream;
-    version_stream << "Linux " << uname_data.version;
-    flutter::EncodableValue response(version_stream.str());
-    result->Success(&response);
-  } else {
+  plugins_common::ScopedMethodCallProbe probe(
+      kChannelName, method_call.method_name().c_str());
+  const Method *method = kMethods.Find(method_call.method_name());
+  if (!method) {
     result->NotImplemented();
+    return;
+  }
+  switch (*method) {
+    case Method::kGetPlatformVersion: {
+      struct utsname uname_data = {};
+      uname(&uname_data);
+      std::ostringstream version_stream;
+      version_stream << "Linux " << uname_data.version;
+      flutter::EncodableValue response(version_stream.str());
+      result->Success(&response);
+      break;
+    }
   }
 }
 
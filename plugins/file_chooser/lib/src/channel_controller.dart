@@ -14,37 +14,7 @@
 import 'package:flutter/services.dart';
 
 import 'callbacks.dart';
-
-/// The name of the plugin's platform channel.
-const String _kChannelName = 'flutter/filechooser';
-
-/// The method name to instruct the native plugin to show an open panel.
-const String _kShowOpenPanelMethod = 'FileChooser.Show.Open';
-/// The method name to instruct the native plugin to show a save panel.
-const String _kShowSavePanelMethod = 'FileChooser.Show.Save';
-
-// Configuration parameters for file chooser panels:
-
-/// The path, as a string, for initial directory to display. Default behavior is
-/// left to the OS if not provided.]
-const String _kInitialDirectoryKey = 'initialDirectory';
-/// The initial file name that should appears in the file chooser. Defaults to
-/// an empty string if not provided.
-const String _kInitialFileNameKey = 'initialFileName';
-/// An array of UTI or file extension strings a panel is allowed to choose.
-const String _kAllowedFileTypesKey = 'allowedFileTypes';
-/// The text that appears on the panel's confirmation button. If not provided,
-/// the OS default is used.
-const String _kConfirmButtonTextKey = 'confirmButtonText';
-
-// Configuration parameters that only apply to open panels:
-
-/// A boolean indicating whether a panel should allow choosing multiple file
-/// paths. Defaults to false if not set.
-const String _kAllowsMultipleSelectionKey = 'allowsMultipleSelection';
-/// A boolean indicating whether a panel should allow choosing directories
-/// instead of files. Defaults to false if not set.
-const String _kCanChooseDirectoriesKey = 'canChooseDirectories';
+import 'file_chooser_messages.dart';
 
 /// A File chooser type.
 enum FileChooserType {
@@ -66,8 +36,9 @@ class FileChooserConfigurationOptions {
       this.canSelectDirectories,
       this.confirmButtonText});
 
-  // See the constants above for documentation; these correspond exactly to
-  // the configuration parameters defined in the channel protocol.
+  // See FileChooserOptions in file_chooser_messages.idl for documentation;
+  // these correspond exactly to the configuration parameters defined in the
+  // channel protocol.
   final String initialDirectory; // ignore: public_member_api_docs
   final String initialFileName; // ignore: public_member_api_docs
   final List<String> allowedFileTypes; // ignore: public_member_api_docs
@@ -76,32 +47,21 @@ class FileChooserConfigurationOptions {
   final String confirmButtonText; // ignore: public_member_api_docs
 
   /// Returns the configuration as a map that can be passed as the
-  /// arguments to invokeMethod for [_kShowOpenPanelMethod] or
-  /// [_kShowSavePanelMethod].
+  /// arguments to invokeMethod for [kShowOpenPanelMethod] or
+  /// [kShowSavePanelMethod].
   Map<String, dynamic> asInvokeMethodArguments() {
-    final args = <String, dynamic>{};
-    if (initialDirectory != null && initialDirectory.isNotEmpty) {
-      args[_kInitialDirectoryKey] = initialDirectory;
-    }
-    if (allowsMultipleSelection != null) {
-      args[_kAllowsMultipleSelectionKey] = allowsMultipleSelection;
-    }
-    if (canSelectDirectories != null) {
-      args[_kCanChooseDirectoriesKey] = canSelectDirectories;
-    }
-    if (allowedFileTypes != null && allowedFileTypes.isNotEmpty) {
-      args[_kAllowedFileTypesKey] = allowedFileTypes;
-    }
-    if (confirmButtonText != null && confirmButtonText.isNotEmpty) {
-      args[_kConfirmButtonTextKey] = confirmButtonText;
-    }
-    if (confirmButtonText != null && confirmButtonText.isNotEmpty) {
-      args[_kConfirmButtonTextKey] = confirmButtonText;
-    }
-    if (initialFileName != null && initialFileName.isNotEmpty) {
-      args[_kInitialFileNameKey] = initialFileName;
-    }
-    return args;
+    String nonEmpty(String value) =>
+        value != null && value.isNotEmpty ? value : null;
+    return FileChooserOptions(
+      initialDirectory: nonEmpty(initialDirectory),
+      initialFileName: nonEmpty(initialFileName),
+      allowedFileTypes: allowedFileTypes != null && allowedFileTypes.isNotEmpty
+          ? allowedFileTypes
+          : null,
+      confirmButtonText: nonEmpty(confirmButtonText),
+      allowsMultipleSelection: allowsMultipleSelection,
+      canChooseDirectories: canSelectDirectories,
+    ).encode();
   }
 }
 
@@ -110,7 +70,7 @@ class FileChooserChannelController {
   FileChooserChannelController._();
 
   /// The platform channel used to manage native file chooser affordances.
-  final _channel = new MethodChannel(_kChannelName);
+  final _channel = new MethodChannel(kChannelName);
 
   /// A reference to the singleton instance of the class.
   static final FileChooserChannelController instance =
@@ -122,8 +82,8 @@ class FileChooserChannelController {
       FileChooserCallback callback) {
     try {
       final methodName = type == FileChooserType.open
-          ? _kShowOpenPanelMethod
-          : _kShowSavePanelMethod;
+          ? kShowOpenPanelMethod
+          : kShowSavePanelMethod;
       _channel
           .invokeMethod(methodName, options.asInvokeMethodArguments())
           .then((response) {
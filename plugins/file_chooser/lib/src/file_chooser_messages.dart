@@ -0,0 +1,99 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/generate_channel_bindings.dart from
+// plugins/file_chooser/file_chooser_messages.idl. Do not edit.
+
+/// The name of the platform channel.
+const String kChannelName = 'flutter/filechooser';
+
+/// Shows an open panel configured by a FileChooserOptions argument. The
+/// result is a list of the chosen paths, or null if the panel is cancelled.
+const String kShowOpenPanelMethod = 'FileChooser.Show.Open';
+
+/// Shows a save panel configured by a FileChooserOptions argument. The
+/// result is a list containing the chosen path, or null if the panel is
+/// cancelled.
+const String kShowSavePanelMethod = 'FileChooser.Show.Save';
+
+/// Configuration for a file chooser panel.
+class FileChooserOptions {
+  /// Creates a message with the given field values.
+  FileChooserOptions({
+    this.initialDirectory,
+    this.initialFileName,
+    this.allowedFileTypes,
+    this.confirmButtonText,
+    this.allowsMultipleSelection,
+    this.canChooseDirectories,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory FileChooserOptions.decode(Object message) {
+    final Map<dynamic, dynamic> map = message;
+    return FileChooserOptions(
+      initialDirectory: map['initialDirectory'],
+      initialFileName: map['initialFileName'],
+      allowedFileTypes: map['allowedFileTypes']?.cast<String>(),
+      confirmButtonText: map['confirmButtonText'],
+      allowsMultipleSelection: map['allowsMultipleSelection'],
+      canChooseDirectories: map['canChooseDirectories'],
+    );
+  }
+
+  /// The path of the directory to show initially. Default behavior is left to
+  /// the OS if not provided.
+  String initialDirectory;
+
+  /// The file name that should appear in the panel initially.
+  String initialFileName;
+
+  /// The file extensions the panel is allowed to choose.
+  List<String> allowedFileTypes;
+
+  /// The text of the panel's confirmation button. If not provided, the OS
+  /// default is used.
+  String confirmButtonText;
+
+  /// Whether an open panel allows choosing multiple paths. Defaults to false.
+  bool allowsMultipleSelection;
+
+  /// Whether an open panel chooses directories instead of files. Defaults to
+  /// false.
+  bool canChooseDirectories;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    final map = <String, dynamic>{};
+    if (initialDirectory != null) {
+      map['initialDirectory'] = initialDirectory;
+    }
+    if (initialFileName != null) {
+      map['initialFileName'] = initialFileName;
+    }
+    if (allowedFileTypes != null) {
+      map['allowedFileTypes'] = allowedFileTypes;
+    }
+    if (confirmButtonText != null) {
+      map['confirmButtonText'] = confirmButtonText;
+    }
+    if (allowsMultipleSelection != null) {
+      map['allowsMultipleSelection'] = allowsMultipleSelection;
+    }
+    if (canChooseDirectories != null) {
+      map['canChooseDirectories'] = canChooseDirectories;
+    }
+    return map;
+  }
+}
@@ -0,0 +1,227 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/generate_channel_bindings.dart from
+// plugins/file_chooser/file_chooser_messages.idl. Do not edit.
+//
+// String and list fields use the reader's arena, if any; see
+// plugins/common/linux/arena.h.
+
+#ifndef PLUGINS_FILE_CHOOSER_LINUX_FILE_CHOOSER_MESSAGES_H_
+#define PLUGINS_FILE_CHOOSER_LINUX_FILE_CHOOSER_MESSAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plugins/common/linux/arena.h"
+#include "plugins/common/linux/method_table.h"
+#include "plugins/common/linux/standard_codec_stream.h"
+
+namespace plugins_file_chooser {
+
+using plugins_common::Decode;
+using plugins_common::Encode;
+
+constexpr char kChannelName[] = "flutter/filechooser";
+
+// Shows an open panel configured by a FileChooserOptions argument. The
+// result is a list of the chosen paths, or null if the panel is cancelled.
+constexpr char kShowOpenPanelMethod[] = "FileChooser.Show.Open";
+
+// Shows a save panel configured by a FileChooserOptions argument. The
+// result is a list containing the chosen path, or null if the panel is
+// cancelled.
+constexpr char kShowSavePanelMethod[] = "FileChooser.Show.Save";
+
+// The methods handled by the plugin, for TypedMethodChannel.
+enum class Method {
+  kShowOpenPanel,
+  kShowSavePanel,
+};
+
+constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {
+    {kShowOpenPanelMethod, Method::kShowOpenPanel},
+    {kShowSavePanelMethod, Method::kShowSavePanel},
+};
+constexpr auto kMethods = plugins_common::MakeMethodTable(kMethodEntries);
+
+// Configuration for a file chooser panel.
+struct FileChooserOptions {
+  // The path of the directory to show initially. Default behavior is left to
+  // the OS if not provided.
+  plugins_common::ArenaString initial_directory;
+  bool has_initial_directory = false;
+  // The file name that should appear in the panel initially.
+  plugins_common::ArenaString initial_file_name;
+  bool has_initial_file_name = false;
+  // The file extensions the panel is allowed to choose.
+  plugins_common::ArenaVector<plugins_common::ArenaString> allowed_file_types;
+  bool has_allowed_file_types = false;
+  // The text of the panel's confirmation button. If not provided, the OS
+  // default is used.
+  plugins_common::ArenaString confirm_button_text;
+  bool has_confirm_button_text = false;
+  // Whether an open panel allows choosing multiple paths. Defaults to false.
+  bool allows_multiple_selection = false;
+  bool has_allows_multiple_selection = false;
+  // Whether an open panel chooses directories instead of files. Defaults to
+  // false.
+  bool can_choose_directories = false;
+  bool has_can_choose_directories = false;
+};
+
+inline void Encode(const FileChooserOptions &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   FileChooserOptions *value);
+
+inline void Encode(const FileChooserOptions &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  size_t size = 0;
+  if (value.has_initial_directory) {
+    ++size;
+  }
+  if (value.has_initial_file_name) {
+    ++size;
+  }
+  if (value.has_allowed_file_types) {
+    ++size;
+  }
+  if (value.has_confirm_button_text) {
+    ++size;
+  }
+  if (value.has_allows_multiple_selection) {
+    ++size;
+  }
+  if (value.has_can_choose_directories) {
+    ++size;
+  }
+  writer->WriteMapSize(size);
+  if (value.has_initial_directory) {
+    writer->WriteString("initialDirectory", 16);
+    Encode(value.initial_directory, writer);
+  }
+  if (value.has_initial_file_name) {
+    writer->WriteString("initialFileName", 15);
+    Encode(value.initial_file_name, writer);
+  }
+  if (value.has_allowed_file_types) {
+    writer->WriteString("allowedFileTypes", 16);
+    Encode(value.allowed_file_types, writer);
+  }
+  if (value.has_confirm_button_text) {
+    writer->WriteString("confirmButtonText", 17);
+    Encode(value.confirm_button_text, writer);
+  }
+  if (value.has_allows_multiple_selection) {
+    writer->WriteString("allowsMultipleSelection", 23);
+    Encode(value.allows_multiple_selection, writer);
+  }
+  if (value.has_can_choose_directories) {
+    writer->WriteString("canChooseDirectories", 20);
+    Encode(value.can_choose_directories, writer);
+  }
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   FileChooserOptions *value) {
+  size_t size;
+  enum class Field {
+    kInitialDirectory,
+    kInitialFileName,
+    kAllowedFileTypes,
+    kConfirmButtonText,
+    kAllowsMultipleSelection,
+    kCanChooseDirectories,
+  };
+  static constexpr plugins_common::MethodEntry<Field> kFields[] = {
+      {"initialDirectory", Field::kInitialDirectory},
+      {"initialFileName", Field::kInitialFileName},
+      {"allowedFileTypes", Field::kAllowedFileTypes},
+      {"confirmButtonText", Field::kConfirmButtonText},
+      {"allowsMultipleSelection", Field::kAllowsMultipleSelection},
+      {"canChooseDirectories", Field::kCanChooseDirectories},
+  };
+  static constexpr auto kFieldTable =
+      plugins_common::MakeMethodTable(kFields);
+  if (!reader->ReadMapSize(&size)) {
+    return false;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    const char *key;
+    size_t key_size;
+    if (!reader->ReadStringView(&key, &key_size)) {
+      return false;
+    }
+    const Field *field = kFieldTable.Find(key, key_size);
+    if (!field) {
+      // Ignore fields this version of the schema doesn't have.
+      if (!reader->Skip()) {
+        return false;
+      }
+      continue;
+    }
+    switch (*field) {
+      case Field::kInitialDirectory:
+        value->has_initial_directory = !reader->ReadNull();
+        if (value->has_initial_directory &&
+            !Decode(reader, &value->initial_directory)) {
+          return false;
+        }
+        break;
+      case Field::kInitialFileName:
+        value->has_initial_file_name = !reader->ReadNull();
+        if (value->has_initial_file_name &&
+            !Decode(reader, &value->initial_file_name)) {
+          return false;
+        }
+        break;
+      case Field::kAllowedFileTypes:
+        value->has_allowed_file_types = !reader->ReadNull();
+        if (value->has_allowed_file_types &&
+            !Decode(reader, &value->allowed_file_types)) {
+          return false;
+        }
+        break;
+      case Field::kConfirmButtonText:
+        value->has_confirm_button_text = !reader->ReadNull();
+        if (value->has_confirm_button_text &&
+            !Decode(reader, &value->confirm_button_text)) {
+          return false;
+        }
+        break;
+      case Field::kAllowsMultipleSelection:
+        value->has_allows_multiple_selection = !reader->ReadNull();
+        if (value->has_allows_multiple_selection &&
+            !Decode(reader, &value->allows_multiple_selection)) {
+          return false;
+        }
+        break;
+      case Field::kCanChooseDirectories:
+        value->has_can_choose_directories = !reader->ReadNull();
+        if (value->has_can_choose_directories &&
+            !Decode(reader, &value->can_choose_directories)) {
+          return false;
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace plugins_file_chooser
+
+#endif  // PLUGINS_FILE_CHOOSER_LINUX_FILE_CHOOSER_MESSAGES_H_
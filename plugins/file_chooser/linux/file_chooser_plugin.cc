@@ -18,39 +18,22 @@
 #include <memory>
 #include <vector>
 
-#include <flutter/method_channel.h>
 #include <flutter/plugin_registrar.h>
-#include <flutter/standard_method_codec.h>
+
+#include "plugins/common/linux/probes.h"
+#include "plugins/common/linux/typed_method_channel.h"
+#include "plugins/file_chooser/linux/file_chooser_messages.h"
 
 namespace plugins_file_chooser {
 
 namespace {
 
-using flutter::EncodableList;
-using flutter::EncodableMap;
-using flutter::EncodableValue;
-
-// See channel_controller.dart for documentation.
-const char kChannelName[] = "flutter/filechooser";
-const char kShowOpenPanelMethod[] = "FileChooser.Show.Open";
-const char kShowSavePanelMethod[] = "FileChooser.Show.Save";
-const char kInitialDirectoryKey[] = "initialDirectory";
-const char kInitialFileNameKey[] = "initialFileName";
-const char kAllowedFileTypesKey[] = "allowedFileTypes";
-const char kConfirmButtonTextKey[] = "confirmButtonText";
-const char kAllowsMultipleSelectionKey[] = "allowsMultipleSelection";
-const char kCanChooseDirectoriesKey[] = "canChooseDirectories";
+// The name of the dialog in probes.
+const char kProbeName[] = "file_chooser";
 
-// Looks for |key| in |map|, returning the associated value if it is present, or
-// a Null EncodableValue if not.
-const EncodableValue &ValueOrNull(const EncodableMap &map, const char *key) {
-  static EncodableValue null_value;
-  auto it = map.find(EncodableValue(key));
-  if (it == map.end()) {
-    return null_value;
-  }
-  return it->second;
-}
+using plugins_common::MethodReply;
+using plugins_common::StandardCodecReader;
+using plugins_common::TypedMethodChannel;
 
 }  // namespace
 
@@ -62,33 +45,29 @@ class FileChooserPlugin : public flutter::Plugin {
 
  private:
   // Creates a plugin that communicates on the given channel.
-  FileChooserPlugin(
-      std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel);
+  FileChooserPlugin(std::unique_ptr<TypedMethodChannel> channel);
 
   // Called when a method is called on |channel_|;
-  void HandleMethodCall(
-      const flutter::MethodCall<EncodableValue> &method_call,
-      std::unique_ptr<flutter::MethodResult<EncodableValue>> result);
+  void HandleMethodCall(Method method, StandardCodecReader *arguments,
+                        MethodReply reply);
 
-  // The MethodChannel used for communication with the Flutter engine.
-  std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel_;
+  // The channel used for communication with the Flutter engine.
+  std::unique_ptr<TypedMethodChannel> channel_;
 };
 
 // Applies filters to the file chooser.
 //
-// Takes the method args and attempts to apply filters to the file chooser
+// Takes the options and attempts to apply filters to the file chooser
 // (in the event that they exist).
-static void ProcessFilters(const EncodableMap &method_args,
+static void ProcessFilters(const FileChooserOptions &options,
                            GtkFileChooser *chooser) {
-  const EncodableValue &allowed_file_types =
-      ValueOrNull(method_args, kAllowedFileTypesKey);
-  if (allowed_file_types.IsList() && !allowed_file_types.ListValue().empty()) {
+  if (options.has_allowed_file_types && !options.allowed_file_types.empty()) {
     GtkFileFilter *filter = gtk_file_filter_new();
     const std::string comma_delimiter = ", ";
     const std::string file_wildcard = "*.";
     std::string filter_name = "";
-    for (const EncodableValue &element : allowed_file_types.ListValue()) {
-      std::string pattern = file_wildcard + element.StringValue();
+    for (const auto &element : options.allowed_file_types) {
+      std::string pattern = file_wildcard + element.c_str();
       filter_name.append(pattern + comma_delimiter);
       gtk_file_filter_add_pattern(filter, pattern.c_str());
     }
@@ -100,115 +79,89 @@ static void ProcessFilters(const EncodableMap &method_args,
   }
 }
 
-// Applies attributes from method args to the file chooser.
+// Applies attributes from the options to the file chooser.
 //
-// Take the method args and attempts to apply the possible attributes that
+// Take the options and attempts to apply the possible attributes that
 // would modify the file chooser: whether multiple files can be selected,
 // whether a directory is a valid target, etc.
-static void ProcessAttributes(const EncodableMap &method_args,
+static void ProcessAttributes(const FileChooserOptions &options,
                               GtkFileChooser *chooser) {
-  EncodableValue allow_multiple_selection =
-      ValueOrNull(method_args, kAllowsMultipleSelectionKey);
-  if (!allow_multiple_selection.IsNull()) {
+  if (options.has_allows_multiple_selection) {
     gtk_file_chooser_set_select_multiple(chooser,
-                                         allow_multiple_selection.BoolValue());
+                                         options.allows_multiple_selection);
   }
-  EncodableValue choose_dirs =
-      ValueOrNull(method_args, kCanChooseDirectoriesKey);
-  if (!choose_dirs.IsNull() && choose_dirs.BoolValue()) {
+  if (options.has_can_choose_directories && options.can_choose_directories) {
     gtk_file_chooser_set_action(chooser, GTK_FILE_CHOOSER_ACTION_SELECT_FOLDER);
   }
-  EncodableValue start_dir = ValueOrNull(method_args, kInitialDirectoryKey);
-  if (!start_dir.IsNull()) {
+  if (options.has_initial_directory) {
     gtk_file_chooser_set_current_folder(chooser,
-                                        start_dir.StringValue().c_str());
+                                        options.initial_directory.c_str());
   }
-  EncodableValue initial_file_name =
-      ValueOrNull(method_args, kInitialFileNameKey);
-  if (!initial_file_name.IsNull()) {
+  if (options.has_initial_file_name) {
     gtk_file_chooser_set_current_name(chooser,
-                                      initial_file_name.StringValue().c_str());
+                                      options.initial_file_name.c_str());
   }
 }
 
 // Creates a file chooser based on the method type.
 //
-// If the method type is the open method (defined under kShowOpenFileMethod),
-// then this returns a file opener dialog. If it is a kShowSaveFileMethod
-// string, then this returns a file saver dialog.
-//
-// If the method is not recognized as one of those above, will return a nullptr.
-static GtkWidget *CreateFileChooserFromMethod(const std::string &method,
-                                              const std::string &ok_button) {
+// For the open method (kShowOpenPanelMethod), this returns a file opener
+// dialog. For the save method (kShowSavePanelMethod), this returns a file
+// saver dialog.
+static GtkWidget *CreateFileChooserFromMethod(
+    Method method, const plugins_common::ArenaString &ok_button) {
   GtkWidget *chooser = nullptr;
-  if (method == kShowOpenPanelMethod) {
-    GtkFileChooserAction action = GTK_FILE_CHOOSER_ACTION_OPEN;
-    chooser = gtk_file_chooser_dialog_new(
-        "Open File", NULL, action,
-        ok_button.empty() ? "_Open" : ok_button.c_str(), GTK_RESPONSE_ACCEPT,
-        "_Cancel", GTK_RESPONSE_CANCEL, NULL);
-  } else if (method == kShowSavePanelMethod) {
-    GtkFileChooserAction action = GTK_FILE_CHOOSER_ACTION_SAVE;
-    chooser = gtk_file_chooser_dialog_new(
-        "Save File", NULL, action,
-        ok_button.empty() ? "_Save" : ok_button.c_str(), GTK_RESPONSE_ACCEPT,
-        "_Cancel", GTK_RESPONSE_CANCEL, NULL);
+  switch (method) {
+    case Method::kShowOpenPanel:
+      chooser = gtk_file_chooser_dialog_new(
+          "Open File", NULL, GTK_FILE_CHOOSER_ACTION_OPEN,
+          ok_button.empty() ? "_Open" : ok_button.c_str(), GTK_RESPONSE_ACCEPT,
+          "_Cancel", GTK_RESPONSE_CANCEL, NULL);
+      break;
+    case Method::kShowSavePanel:
+      chooser = gtk_file_chooser_dialog_new(
+          "Save File", NULL, GTK_FILE_CHOOSER_ACTION_SAVE,
+          ok_button.empty() ? "_Save" : ok_button.c_str(), GTK_RESPONSE_ACCEPT,
+          "_Cancel", GTK_RESPONSE_CANCEL, NULL);
+      break;
   }
   return chooser;
 }
 
 // Creates a native file chooser based on the method specified.
 //
-// The args determine the modifications to the file chooser, like filters,
+// The options determine the modifications to the file chooser, like filters,
 // being able to choose multiple files, etc.
-static GtkWidget *CreateFileChooser(const std::string &method,
-                                    const EncodableMap &args) {
-  EncodableValue ok_button_value = ValueOrNull(args, kConfirmButtonTextKey);
-  std::string ok_button_str;
-  if (!ok_button_value.IsNull()) {
-    ok_button_str = ok_button_value.StringValue();
-  }
-  GtkWidget *chooser = CreateFileChooserFromMethod(method, ok_button_str);
+static GtkWidget *CreateFileChooser(Method method,
+                                    const FileChooserOptions &options) {
+  GtkWidget *chooser = CreateFileChooserFromMethod(
+      method, options.has_confirm_button_text ? options.confirm_button_text
+                                              : plugins_common::ArenaString());
   if (chooser == nullptr) {
-    std::cerr << "Could not determine method for file chooser from: " << method
-              << std::endl;
+    std::cerr << "Could not create file chooser" << std::endl;
     return chooser;
   }
-  ProcessFilters(args, GTK_FILE_CHOOSER(chooser));
-  ProcessAttributes(args, GTK_FILE_CHOOSER(chooser));
+  ProcessFilters(options, GTK_FILE_CHOOSER(chooser));
+  ProcessAttributes(options, GTK_FILE_CHOOSER(chooser));
   return chooser;
 }
 
-// Creates a valid channel response object given the list of filenames.
-//
-// An empty array is treated as a cancelled operation.
-static EncodableValue CreateResponseObject(
-    const std::vector<std::string> &filenames) {
-  if (filenames.empty()) {
-    return EncodableValue();
-  }
-  EncodableList response;
-  for (const std::string &filename : filenames) {
-    response.push_back(EncodableValue(filename));
-  }
-  return EncodableValue(std::move(response));
-}
-
 // static
 void FileChooserPlugin::RegisterWithRegistrar(
     flutter::PluginRegistrar *registrar) {
-  auto channel = std::make_unique<flutter::MethodChannel<EncodableValue>>(
-      registrar->messenger(), kChannelName,
-      &flutter::StandardMethodCodec::GetInstance());
+  auto channel = std::make_unique<TypedMethodChannel>(registrar->messenger(),
+                                                      kChannelName);
   auto *channel_pointer = channel.get();
 
   // Uses new instead of make_unique due to private constructor.
   std::unique_ptr<FileChooserPlugin> plugin(
       new FileChooserPlugin(std::move(channel)));
 
-  channel_pointer->SetMethodCallHandler(
-      [plugin_pointer = plugin.get()](const auto &call, auto result) {
-        plugin_pointer->HandleMethodCall(call, std::move(result));
+  channel_pointer->SetMethodCallHandler<Method>(
+      kMethods, [plugin_pointer = plugin.get()](Method method,
+                                                StandardCodecReader *arguments,
+                                                MethodReply reply) {
+        plugin_pointer->HandleMethodCall(method, arguments, std::move(reply));
       });
   registrar->EnableInputBlockingForChannel(kChannelName);
 
@@ -216,26 +169,28 @@ void FileChooserPlugin::RegisterWithRegistrar(
 }
 
 FileChooserPlugin::FileChooserPlugin(
-    std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel)
+    std::unique_ptr<TypedMethodChannel> channel)
     : channel_(std::move(channel)) {}
 
 FileChooserPlugin::~FileChooserPlugin() {}
 
-void FileChooserPlugin::HandleMethodCall(
-    const flutter::MethodCall<EncodableValue> &method_call,
-    std::unique_ptr<flutter::MethodResult<EncodableValue>> result) {
-  if (!method_call.arguments() || !method_call.arguments()->IsMap()) {
-    result->Error("Bad Arguments", "Argument map missing or malformed");
+void FileChooserPlugin::HandleMethodCall(Method method,
+                                         StandardCodecReader *arguments,
+                                         MethodReply reply) {
+  FileChooserOptions options;
+  if (!Decode(arguments, &options)) {
+    reply.Error("Bad Arguments", "Argument map missing or malformed");
     return;
   }
 
-  auto chooser = CreateFileChooser(method_call.method_name(),
-                                   method_call.arguments()->MapValue());
+  auto chooser = CreateFileChooser(method, options);
   if (chooser == nullptr) {
-    result->NotImplemented();
+    reply.Error("Unable to create file chooser");
     return;
   }
+  FLUTTER_DESKTOP_PROBE1(dialog_open, kProbeName);
   gint chooser_result = gtk_dialog_run(GTK_DIALOG(chooser));
+  FLUTTER_DESKTOP_PROBE1(dialog_close, kProbeName);
   std::vector<std::string> filenames;
   if (chooser_result == GTK_RESPONSE_ACCEPT) {
     GSList *files = gtk_file_chooser_get_filenames(GTK_FILE_CHOOSER(chooser));
@@ -254,8 +209,12 @@ void FileChooserPlugin::HandleMethodCall(
   }
   gtk_widget_destroy(chooser);
 
-  EncodableValue response_object(CreateResponseObject(filenames));
-  result->Success(&response_object);
+  // An empty list is treated as a cancelled operation.
+  if (filenames.empty()) {
+    reply.Success();
+  } else {
+    reply.Success(filenames);
+  }
 }
 
 }  // namespace plugins_file_chooser
@@ -17,73 +17,15 @@ import 'package:flutter/services.dart';
 import 'package:flutter/widgets.dart';
 
 import 'menu_item.dart';
+import 'menubar_messages.dart';
 
-/// Whether or not the menu item is a divider, as a boolean. If true, no other
-/// The name of the plugin's platform channel.
-const String _kMenuChannelName = 'flutter/menubar';
-
-/// The method name to instruct the native plugin to set the menu.
-//
-/// The argument to this method will be an array of map representations
-/// of menus that should be set as top-level menu items.
-const String _kMenuSetMethod = 'Menubar.SetMenu';
-
-/// The method name for the Dart-side callback called when a menu item is
-/// selected.
-//
-/// The argument to this method must be the ID of the selected menu item, as
-/// provided in the kIdKey field in the kMenuSetMethod call.
-const String _kMenuItemSelectedCallbackMethod = 'Menubar.SelectedCallback';
-
-// Keys for the map representations of menus sent to kMenuSetMethod.
-
-/// The ID of the menu item, as an integer. If present, this indicates that the
-/// menu item should trigger a kMenuItemSelectedCallbackMethod call when
-/// selected.
-const String _kIdKey = 'id';
-
-/// The label that should be displayed for the menu, as a string.
-const String _kLabelKey = 'label';
-
-/// The string corresponding to the shortcut key equivalent without modifiers.
-///
-/// When menu support moves into Flutter itself, this will likely use keyId.
-/// That's not useable for this plugin-based prototype however, since keyId is
-/// not stable.
-const String _kShortcutKeyEquivalent = 'keyEquivalent';
-
-/// An alternative to _kShortcutKeyEquivalent for keys that have no string
-/// equivalent. Only this or _kShortcutKeyEquivalent should be specified.
-///
-/// This is a partial workaround for the lack of keyId discussed above, to
-/// handle common shortcut keys that _kShortcutKeyEquivalent can't represent.
-///
-/// See _ShortcutSpecialKeys for possible values.
-const String _kShortcutSpecialKey = 'specialKey';
-
-/// The modifier flags to apply to the shortcut key.
-///
-/// The value is an int representing a flag set; see below for possible values.
-const String _kShortcutKeyModifiers = 'keyModifiers';
-
-/// Whether or not the menu item should be enabled, as a boolean. If not present
-/// the defualt is to enabled the item.
-const String _kEnabledKey = 'enabled';
-
-/// Menu items that should be shown as a submenu of this item, as an array.
-const String _kChildrenKey = 'children';
-
-/// Whether or not the menu item is a divider, as a boolean. If true, no other
-/// keys will be present.
-const String _kDividerKey = 'isDivider';
-
-// Values for _kShortcutKeyModifiers.
+// Values for MenuItemInfo.keyModifiers.
 const int _shortcutModifierMeta = 1 << 0;
 const int _shortcutModifierShift = 1 << 1;
 const int _shortcutModifierAlt = 1 << 2;
 const int _shortcutModifierControl = 1 << 3;
 
-/// Values for _kShortcutSpecialKey.
+/// Values for MenuItemInfo.specialKey.
 final _shortcutSpecialKeyValues = <LogicalKeyboardKey, int>{
   LogicalKeyboardKey.f1: 1,
   LogicalKeyboardKey.f2: 2,
@@ -109,7 +51,7 @@ class MenuChannel {
     _platformChannel.setMethodCallHandler(_callbackHandler);
   }
 
-  final MethodChannel _platformChannel = const MethodChannel(_kMenuChannelName);
+  final MethodChannel _platformChannel = const MethodChannel(kChannelName);
 
   /// Map from unique identifiers assigned by this class to the callbacks for
   /// those menu items.
@@ -118,7 +60,7 @@ class MenuChannel {
   /// The ID to use the next time a menu item needs an ID assigned.
   int _nextMenuItemId = 1;
 
-  /// Whether or not a call to [_kMenuSetMethod] is outstanding.
+  /// Whether or not a call to [kSetMenuMethod] is outstanding.
   ///
   /// This is used to drop any menu callbacks that aren't received until
   /// after a new call to setMenu, so that clients don't received unexpected
@@ -137,7 +79,7 @@ class MenuChannel {
     try {
       _updateInProgress = true;
       await _platformChannel.invokeMethod(
-          _kMenuSetMethod, _channelRepresentationForMenus(menus));
+          kSetMenuMethod, _channelRepresentationForMenus(menus));
       _updateInProgress = false;
     } on PlatformException catch (e) {
       print('Platform exception setting menu: ${e.message}');
@@ -145,7 +87,7 @@ class MenuChannel {
   }
 
   /// Converts [menus] to a representation that can be sent in the arguments to
-  /// [_kMenuSetMethod].
+  /// [kSetMenuMethod].
   ///
   /// As a side-effect, repopulates _selectionCallbacks with a mapping from
   /// the IDs assigned to any menu item with a selection handler to the
@@ -154,27 +96,27 @@ class MenuChannel {
     _selectionCallbacks.clear();
     _nextMenuItemId = 1;
 
-    return menus.map(_channelRepresentationForMenuItem).toList();
+    return menus
+        .map((menu) => _channelRepresentationForMenuItem(menu).encode())
+        .toList();
   }
 
   /// Returns a representation of [item] suitable for passing over the
   /// platform channel to the native plugin.
-  Map<String, dynamic> _channelRepresentationForMenuItem(
-      AbstractMenuItem item) {
-    final representation = <String, dynamic>{};
+  MenuItemInfo _channelRepresentationForMenuItem(AbstractMenuItem item) {
+    final representation = MenuItemInfo();
     if (item is MenuDivider) {
-      representation[_kDividerKey] = true;
+      representation.isDivider = true;
     } else {
-      representation[_kLabelKey] = item.label;
+      representation.label = item.label;
       if (item is Submenu) {
-        representation[_kChildrenKey] =
-            _channelRepresentationForMenu(item.children);
+        representation.children = _channelRepresentationForMenu(item.children);
       } else if (item is MenuItem) {
         if (item.onClicked != null) {
-          representation[_kIdKey] = _storeMenuCallback(item.onClicked);
+          representation.id = _storeMenuCallback(item.onClicked);
         }
         if (!item.enabled) {
-          representation[_kEnabledKey] = false;
+          representation.enabled = false;
         }
         if (item.shortcut != null) {
           _addShortcutToRepresentation(item.shortcut, representation);
@@ -189,8 +131,9 @@ class MenuChannel {
 
   /// Returns the representation of [menu] suitable for passing over the
   /// platform channel to the native plugin.
-  List<dynamic> _channelRepresentationForMenu(List<AbstractMenuItem> menu) {
-    final menuItemRepresentations = [];
+  List<MenuItemInfo> _channelRepresentationForMenu(
+      List<AbstractMenuItem> menu) {
+    final menuItemRepresentations = <MenuItemInfo>[];
     // Dividers are only allowed after non-divider items (see ApplicationMenu).
     var skipNextDivider = true;
     for (final menuItem in menu) {
@@ -209,10 +152,9 @@ class MenuChannel {
   }
 
   /// Populates [channelRepresentation] with the platform channel representation
-  /// of [shortcut], using [_kShortcutKeyEquivalent], [_kShortcutSpecialKey],
-  /// and/or [_kShortcutKeyModifiers].
+  /// of [shortcut], using its keyEquivalent, specialKey, and/or keyModifiers.
   void _addShortcutToRepresentation(
-      LogicalKeySet shortcut, Map<String, dynamic> channelRepresentation) {
+      LogicalKeySet shortcut, MenuItemInfo channelRepresentation) {
     var hasNonModifierKey = false;
     var modifiers = 0;
     for (final key in shortcut.keys) {
@@ -231,14 +173,14 @@ class MenuChannel {
         }
 
         if (key.keyLabel != null) {
-          channelRepresentation[_kShortcutKeyEquivalent] = key.keyLabel;
+          channelRepresentation.keyEquivalent = key.keyLabel;
         } else {
           final specialKey = _shortcutSpecialKeyValues[key];
           if (specialKey == null) {
             throw ArgumentError('Unsupported menu shortcut key: $key\n'
                 'Please add this key to the special key mapping.');
           }
-          channelRepresentation[_kShortcutSpecialKey] = specialKey;
+          channelRepresentation.specialKey = specialKey;
         }
         hasNonModifierKey = true;
       }
@@ -248,7 +190,7 @@ class MenuChannel {
       throw ArgumentError('Invalid menu item shortcut: $shortcut\n'
           'Menu items must have exactly one non-modifier key.');
     }
-    channelRepresentation[_kShortcutKeyModifiers] = modifiers;
+    channelRepresentation.keyModifiers = modifiers;
   }
 
   /// Stores [callback] for use plugin callback handling, returning the ID
@@ -264,7 +206,7 @@ class MenuChannel {
 
   /// Mediates between the platform channel callback and the client callback.
   Future<Null> _callbackHandler(MethodCall methodCall) async {
-    if (methodCall.method == _kMenuItemSelectedCallbackMethod) {
+    if (methodCall.method == kMenuItemSelectedMethod) {
       try {
         if (_updateInProgress) {
           // Drop stale callbacks.
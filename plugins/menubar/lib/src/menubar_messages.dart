@@ -0,0 +1,113 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/generate_channel_bindings.dart from
+// plugins/menubar/menubar_messages.idl. Do not edit.
+
+/// The name of the platform channel.
+const String kChannelName = 'flutter/menubar';
+
+/// Sets the menu. The argument is a list of MenuItemInfo for the top-level
+/// menus.
+const String kSetMenuMethod = 'Menubar.SetMenu';
+
+/// Called on the Dart side when a menu item is selected. The argument is the
+/// ID of the item, from MenuItemInfo.id.
+const String kMenuItemSelectedMethod = 'Menubar.SelectedCallback';
+
+/// A menu item, submenu, or divider.
+class MenuItemInfo {
+  /// Creates a message with the given field values.
+  MenuItemInfo({
+    this.id,
+    this.label,
+    this.keyEquivalent,
+    this.specialKey,
+    this.keyModifiers,
+    this.enabled,
+    this.children,
+    this.isDivider,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory MenuItemInfo.decode(Object message) {
+    final Map<dynamic, dynamic> map = message;
+    return MenuItemInfo(
+      id: map['id'],
+      label: map['label'],
+      keyEquivalent: map['keyEquivalent'],
+      specialKey: map['specialKey'],
+      keyModifiers: map['keyModifiers'],
+      enabled: map['enabled'],
+      children: map['children']?.map<MenuItemInfo>((item) => MenuItemInfo.decode(item))?.toList(),
+      isDivider: map['isDivider'],
+    );
+  }
+
+  /// The ID of the item. If present, selecting the item calls the
+  /// MenuItemSelected callback.
+  int id;
+
+  /// The label to display.
+  String label;
+
+  /// The shortcut key without modifiers.
+  String keyEquivalent;
+
+  /// A shortcut key that has no string equivalent, such as a function key.
+  /// Only this or keyEquivalent should be specified.
+  int specialKey;
+
+  /// The shortcut's modifier flags.
+  int keyModifiers;
+
+  /// Whether the item is enabled. Defaults to true.
+  bool enabled;
+
+  /// The items of a submenu.
+  List<MenuItemInfo> children;
+
+  /// Whether the item is a divider. If true, no other fields are present.
+  bool isDivider;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    final map = <String, dynamic>{};
+    if (id != null) {
+      map['id'] = id;
+    }
+    if (label != null) {
+      map['label'] = label;
+    }
+    if (keyEquivalent != null) {
+      map['keyEquivalent'] = keyEquivalent;
+    }
+    if (specialKey != null) {
+      map['specialKey'] = specialKey;
+    }
+    if (keyModifiers != null) {
+      map['keyModifiers'] = keyModifiers;
+    }
+    if (enabled != null) {
+      map['enabled'] = enabled;
+    }
+    if (children != null) {
+      map['children'] = children.map((item) => item.encode()).toList();
+    }
+    if (isDivider != null) {
+      map['isDivider'] = isDivider;
+    }
+    return map;
+  }
+}
@@ -0,0 +1,261 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/generate_channel_bindings.dart from
+// plugins/menubar/menubar_messages.idl. Do not edit.
+//
+// String and list fields use the reader's arena, if any; see
+// plugins/common/linux/arena.h.
+
+#ifndef PLUGINS_MENUBAR_LINUX_MENUBAR_MESSAGES_H_
+#define PLUGINS_MENUBAR_LINUX_MENUBAR_MESSAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plugins/common/linux/arena.h"
+#include "plugins/common/linux/method_table.h"
+#include "plugins/common/linux/standard_codec_stream.h"
+
+namespace plugins_menubar {
+
+using plugins_common::Decode;
+using plugins_common::Encode;
+
+constexpr char kChannelName[] = "flutter/menubar";
+
+// Sets the menu. The argument is a list of MenuItemInfo for the top-level
+// menus.
+constexpr char kSetMenuMethod[] = "Menubar.SetMenu";
+
+// Called on the Dart side when a menu item is selected. The argument is the
+// ID of the item, from MenuItemInfo.id.
+constexpr char kMenuItemSelectedMethod[] = "Menubar.SelectedCallback";
+
+// The methods handled by the plugin, for TypedMethodChannel.
+enum class Method {
+  kSetMenu,
+};
+
+constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {
+    {kSetMenuMethod, Method::kSetMenu},
+};
+constexpr auto kMethods = plugins_common::MakeMethodTable(kMethodEntries);
+
+// A menu item, submenu, or divider.
+struct MenuItemInfo {
+  // The ID of the item. If present, selecting the item calls the
+  // MenuItemSelected callback.
+  int64_t id = 0;
+  bool has_id = false;
+  // The label to display.
+  plugins_common::ArenaString label;
+  bool has_label = false;
+  // The shortcut key without modifiers.
+  plugins_common::ArenaString key_equivalent;
+  bool has_key_equivalent = false;
+  // A shortcut key that has no string equivalent, such as a function key.
+  // Only this or keyEquivalent should be specified.
+  int64_t special_key = 0;
+  bool has_special_key = false;
+  // The shortcut's modifier flags.
+  int64_t key_modifiers = 0;
+  bool has_key_modifiers = false;
+  // Whether the item is enabled. Defaults to true.
+  bool enabled = false;
+  bool has_enabled = false;
+  // The items of a submenu.
+  plugins_common::ArenaVector<MenuItemInfo> children;
+  bool has_children = false;
+  // Whether the item is a divider. If true, no other fields are present.
+  bool is_divider = false;
+  bool has_is_divider = false;
+};
+
+inline void Encode(const MenuItemInfo &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   MenuItemInfo *value);
+
+inline void Encode(const MenuItemInfo &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  size_t size = 0;
+  if (value.has_id) {
+    ++size;
+  }
+  if (value.has_label) {
+    ++size;
+  }
+  if (value.has_key_equivalent) {
+    ++size;
+  }
+  if (value.has_special_key) {
+    ++size;
+  }
+  if (value.has_key_modifiers) {
+    ++size;
+  }
+  if (value.has_enabled) {
+    ++size;
+  }
+  if (value.has_children) {
+    ++size;
+  }
+  if (value.has_is_divider) {
+    ++size;
+  }
+  writer->WriteMapSize(size);
+  if (value.has_id) {
+    writer->WriteString("id", 2);
+    Encode(value.id, writer);
+  }
+  if (value.has_label) {
+    writer->WriteString("label", 5);
+    Encode(value.label, writer);
+  }
+  if (value.has_key_equivalent) {
+    writer->WriteString("keyEquivalent", 13);
+    Encode(value.key_equivalent, writer);
+  }
+  if (value.has_special_key) {
+    writer->WriteString("specialKey", 10);
+    Encode(value.special_key, writer);
+  }
+  if (value.has_key_modifiers) {
+    writer->WriteString("keyModifiers", 12);
+    Encode(value.key_modifiers, writer);
+  }
+  if (value.has_enabled) {
+    writer->WriteString("enabled", 7);
+    Encode(value.enabled, writer);
+  }
+  if (value.has_children) {
+    writer->WriteString("children", 8);
+    Encode(value.children, writer);
+  }
+  if (value.has_is_divider) {
+    writer->WriteString("isDivider", 9);
+    Encode(value.is_divider, writer);
+  }
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   MenuItemInfo *value) {
+  size_t size;
+  enum class Field {
+    kId,
+    kLabel,
+    kKeyEquivalent,
+    kSpecialKey,
+    kKeyModifiers,
+    kEnabled,
+    kChildren,
+    kIsDivider,
+  };
+  static constexpr plugins_common::MethodEntry<Field> kFields[] = {
+      {"id", Field::kId},
+      {"label", Field::kLabel},
+      {"keyEquivalent", Field::kKeyEquivalent},
+      {"specialKey", Field::kSpecialKey},
+      {"keyModifiers", Field::kKeyModifiers},
+      {"enabled", Field::kEnabled},
+      {"children", Field::kChildren},
+      {"isDivider", Field::kIsDivider},
+  };
+  static constexpr auto kFieldTable =
+      plugins_common::MakeMethodTable(kFields);
+  if (!reader->ReadMapSize(&size)) {
+    return false;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    const char *key;
+    size_t key_size;
+    if (!reader->ReadStringView(&key, &key_size)) {
+      return false;
+    }
+    const Field *field = kFieldTable.Find(key, key_size);
+    if (!field) {
+      // Ignore fields this version of the schema doesn't have.
+      if (!reader->Skip()) {
+        return false;
+      }
+      continue;
+    }
+    switch (*field) {
+      case Field::kId:
+        value->has_id = !reader->ReadNull();
+        if (value->has_id &&
+            !Decode(reader, &value->id)) {
+          return false;
+        }
+        break;
+      case Field::kLabel:
+        value->has_label = !reader->ReadNull();
+        if (value->has_label &&
+            !Decode(reader, &value->label)) {
+          return false;
+        }
+        break;
+      case Field::kKeyEquivalent:
+        value->has_key_equivalent = !reader->ReadNull();
+        if (value->has_key_equivalent &&
+            !Decode(reader, &value->key_equivalent)) {
+          return false;
+        }
+        break;
+      case Field::kSpecialKey:
+        value->has_special_key = !reader->ReadNull();
+        if (value->has_special_key &&
+            !Decode(reader, &value->special_key)) {
+          return false;
+        }
+        break;
+      case Field::kKeyModifiers:
+        value->has_key_modifiers = !reader->ReadNull();
+        if (value->has_key_modifiers &&
+            !Decode(reader, &value->key_modifiers)) {
+          return false;
+        }
+        break;
+      case Field::kEnabled:
+        value->has_enabled = !reader->ReadNull();
+        if (value->has_enabled &&
+            !Decode(reader, &value->enabled)) {
+          return false;
+        }
+        break;
+      case Field::kChildren:
+        value->has_children = !reader->ReadNull();
+        if (value->has_children &&
+            !Decode(reader, &value->children)) {
+          return false;
+        }
+        break;
+      case Field::kIsDivider:
+        value->has_is_divider = !reader->ReadNull();
+        if (value->has_is_divider &&
+            !Decode(reader, &value->is_divider)) {
+          return false;
+        }
+        break;
+    }
+  }
+  return true;
+}
+
+}  // namespace plugins_menubar
+
+#endif  // PLUGINS_MENUBAR_LINUX_MENUBAR_MESSAGES_H_
@@ -17,9 +17,11 @@
 #include <gtk/gtk.h>
 #include <memory>
 
-#include <flutter/method_channel.h>
 #include <flutter/plugin_registrar.h>
-#include <flutter/standard_method_codec.h>
+
+#include "plugins/common/linux/probes.h"
+#include "plugins/common/linux/typed_method_channel.h"
+#include "plugins/menubar/linux/menubar_messages.h"
 
 static constexpr char kWindowTitle[] = "Flutter Menubar";
 
@@ -27,20 +29,11 @@ namespace plugins_menubar {
 
 namespace {
 
-using flutter::EncodableMap;
-using flutter::EncodableValue;
-
-// See menu_channel.dart for documentation.
-const char kChannelName[] = "flutter/menubar";
-const char kMenuSetMethod[] = "Menubar.SetMenu";
-const char kMenuItemSelectedCallbackMethod[] = "Menubar.SelectedCallback";
-const char kIdKey[] = "id";
-const char kLabelKey[] = "label";
-const char kEnabledKey[] = "enabled";
-const char kChildrenKey[] = "children";
-const char kDividerKey[] = "isDivider";
+using plugins_common::MethodReply;
+using plugins_common::StandardCodecReader;
+using plugins_common::TypedMethodChannel;
 
-}
+}  // namespace
 
 class MenubarPlugin : public flutter::Plugin {
  public:
@@ -50,16 +43,14 @@ class MenubarPlugin : public flutter::Plugin {
 
  private:
   // Creates a plugin that communicates on the given channel.
-  MenubarPlugin(
-      std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel);
+  MenubarPlugin(std::unique_ptr<TypedMethodChannel> channel);
 
   // Called when a method is called on |channel_|;
-  void HandleMethodCall(
-      const flutter::MethodCall<EncodableValue> &method_call,
-      std::unique_ptr<flutter::MethodResult<EncodableValue>> result);
+  void HandleMethodCall(Method method, StandardCodecReader *arguments,
+                        MethodReply reply);
 
-  // The MethodChannel used for communication with the Flutter engine.
-  std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel_;
+  // The channel used for communication with the Flutter engine.
+  std::unique_ptr<TypedMethodChannel> channel_;
 
   class Menubar;
   std::unique_ptr<Menubar> menubar_;
@@ -67,24 +58,24 @@ class MenubarPlugin : public flutter::Plugin {
 
 // static
 void MenubarPlugin::RegisterWithRegistrar(flutter::PluginRegistrar *registrar) {
-  auto channel = std::make_unique<flutter::MethodChannel<EncodableValue>>(
-      registrar->messenger(), kChannelName,
-      &flutter::StandardMethodCodec::GetInstance());
+  auto channel = std::make_unique<TypedMethodChannel>(registrar->messenger(),
+                                                      kChannelName);
   auto *channel_pointer = channel.get();
 
   // Uses new instead of make_unique due to private constructor.
   std::unique_ptr<MenubarPlugin> plugin(new MenubarPlugin(std::move(channel)));
 
-  channel_pointer->SetMethodCallHandler(
-      [plugin_pointer = plugin.get()](const auto &call, auto result) {
-        plugin_pointer->HandleMethodCall(call, std::move(result));
+  channel_pointer->SetMethodCallHandler<Method>(
+      kMethods, [plugin_pointer = plugin.get()](Method method,
+                                                StandardCodecReader *arguments,
+                                                MethodReply reply) {
+        plugin_pointer->HandleMethodCall(method, arguments, std::move(reply));
       });
 
   registrar->AddPlugin(std::move(plugin));
 }
 
-MenubarPlugin::MenubarPlugin(
-    std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel)
+MenubarPlugin::MenubarPlugin(std::unique_ptr<TypedMethodChannel> channel)
     : channel_(std::move(channel)) {}
 
 MenubarPlugin::~MenubarPlugin() {}
@@ -120,56 +111,43 @@ class MenubarPlugin::Menubar {
   static void MenuItemSelected(GtkWidget *menuItem, gpointer *data) {
     auto plugin = reinterpret_cast<MenubarPlugin *>(data);
 
-    plugin->channel_->InvokeMethod(kMenuItemSelectedCallbackMethod,
-                                   std::make_unique<EncodableValue>(std::stoi(
-                                       gtk_widget_get_name(menuItem))));
+    int64_t id = std::stoll(gtk_widget_get_name(menuItem));
+    plugin->channel_->InvokeMethod(kMenuItemSelectedMethod, id);
   }
 
   // Creates the menu items heirarchy from a given channel representation.
-  void SetMenuItems(const EncodableValue &root, flutter::Plugin *plugin,
-                    GtkWidget *parentWidget) {
-    if (root.IsList()) {
-      // This is the base of the menu representation. It's not a menu item
-      // itself, so there's no need to create a widget.
-      for (const auto &menu : root.ListValue()) {
-        SetMenuItems(menu, plugin, parentWidget);
-      }
-      gtk_widget_show_all(menubar_window_);
-
-      return;
+  void SetMenuItems(const plugins_common::ArenaVector<MenuItemInfo> &items,
+                    flutter::Plugin *plugin, GtkWidget *parentWidget) {
+    for (const MenuItemInfo &item : items) {
+      SetMenuItem(item, plugin, parentWidget);
     }
+    gtk_widget_show_all(menubar_window_);
+  }
 
-    // Everything else is a map.
-    const EncodableMap &menu_info = root.MapValue();
-    auto label_it = menu_info.find(EncodableValue(kLabelKey));
-    if (label_it != menu_info.end()) {
-      std::string label = label_it->second.StringValue();
-
-      auto enabled_it = menu_info.find(EncodableValue(kEnabledKey));
-      bool enabled =
-          enabled_it == menu_info.end() ? true : enabled_it->second.BoolValue();
+  // Creates the widget for |item|, and any children, in |parentWidget|.
+  void SetMenuItem(const MenuItemInfo &item, flutter::Plugin *plugin,
+                   GtkWidget *parentWidget) {
+    if (item.has_label) {
+      bool enabled = !item.has_enabled || item.enabled;
 
-      auto children_it = menu_info.find(EncodableValue(kChildrenKey));
-      if (children_it != menu_info.end()) {
+      if (item.has_children) {
         // A parent menu item. Creates a widget with its label and then build
         // the children.
-        const EncodableValue &children = children_it->second;
         auto menu = gtk_menu_new();
-        auto menuItem = gtk_menu_item_new_with_label(label.c_str());
+        auto menuItem = gtk_menu_item_new_with_label(item.label.c_str());
 
         gtk_widget_set_sensitive(menuItem, enabled);
         gtk_menu_item_set_submenu(GTK_MENU_ITEM(menuItem), menu);
         gtk_menu_shell_append(GTK_MENU_SHELL(parentWidget), menuItem);
 
-        SetMenuItems(children, plugin, menu);
+        SetMenuItems(item.children, plugin, menu);
       } else {
         // A leaf menu item. Only these items will have a callback.
-        auto menuItem = gtk_menu_item_new_with_label(label.c_str());
+        auto menuItem = gtk_menu_item_new_with_label(item.label.c_str());
         gtk_widget_set_sensitive(menuItem, enabled);
 
-        auto id_it = menu_info.find(EncodableValue(kIdKey));
-        if (id_it != menu_info.end()) {
-          std::string idString = std::to_string(id_it->second.IntValue());
+        if (item.has_id) {
+          std::string idString = std::to_string(item.id);
           gtk_widget_set_name(menuItem, idString.c_str());
         }
         g_signal_connect(G_OBJECT(menuItem), "activate",
@@ -178,12 +156,10 @@ class MenubarPlugin::Menubar {
       }
     }
 
-    auto divider_it = menu_info.find(EncodableValue(kDividerKey));
-    if (divider_it != menu_info.end() && divider_it->second.BoolValue()) {
+    if (item.has_is_divider && item.is_divider) {
       auto separator = gtk_separator_menu_item_new();
       gtk_menu_shell_append(GTK_MENU_SHELL(parentWidget), separator);
     }
-    gtk_widget_show_all(menubar_window_);
   }
 
   // Removes all items from the menubar.
@@ -202,26 +178,29 @@ class MenubarPlugin::Menubar {
   GtkWidget *menubar_;
 };
 
-void MenubarPlugin::HandleMethodCall(
-    const flutter::MethodCall<EncodableValue> &method_call,
-    std::unique_ptr<flutter::MethodResult<EncodableValue>> result) {
-  if (method_call.method_name().compare(kMenuSetMethod) == 0) {
-    if (!method_call.arguments() || method_call.arguments()->IsNull()) {
-      result->Error("Bad Arguments", "Null menu bar arguments received");
-      return;
-    }
+void MenubarPlugin::HandleMethodCall(Method method,
+                                     StandardCodecReader *arguments,
+                                     MethodReply reply) {
+  switch (method) {
+    case Method::kSetMenu: {
+      plugins_common::ArenaVector<MenuItemInfo> menus;
+      if (!Decode(arguments, &menus)) {
+        reply.Error("Bad Arguments", "Missing or malformed menu bar arguments");
+        return;
+      }
 
-    if (menubar_ == nullptr) {
-      menubar_ = std::make_unique<MenubarPlugin::Menubar>(this);
+      if (menubar_ == nullptr) {
+        menubar_ = std::make_unique<MenubarPlugin::Menubar>(this);
+      }
+      // The menubar will be redrawn after every interaction. Clear items to
+      // avoid duplication.
+      FLUTTER_DESKTOP_PROBE1(menu_rebuild_start, menus.size());
+      menubar_->ClearMenuItems();
+      menubar_->SetMenuItems(menus, this, menubar_->GetRootMenuBar());
+      FLUTTER_DESKTOP_PROBE(menu_rebuild_done);
+      reply.Success();
+      break;
     }
-    // The menubar will be redrawn after every interaction. Clear items to avoid
-    // duplication.
-    menubar_->ClearMenuItems();
-    menubar_->SetMenuItems(*method_call.arguments(), this,
-                           menubar_->GetRootMenuBar());
-    result->Success();
-  } else {
-    result->NotImplemented();
   }
 }
 
@@ -12,76 +12,91 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 import 'dart:async';
+import 'dart:typed_data';
 import 'dart:ui';
 
 import 'package:flutter/services.dart';
 
 import 'platform_window.dart';
 import 'screen.dart';
+import 'window_size_messages.dart';
 
-/// The name of the plugin's platform channel.
-const String _windowSizeChannelName = 'flutter/windowsize';
-
-/// The method name to request information about the available screens.
-///
-/// Returns a list of screen info maps; see keys below.
-const String _getScreenListMethod = 'getScreenList';
-/// The method name to request information about the window containing the
-/// Flutter instance.
-///
-/// Returns a list of window info maps; see keys below.
-const String _getWindowInfoMethod = 'getWindowInfo';
-/// The method name to set the frame of a window.
-///
-/// Takes a frame array, as documented for the value of _frameKey.
-const String _setWindowFrameMethod = 'setWindowFrame';
-
-// Keys for screen and window maps returned by _getScreenListMethod.
-
-/// The frame of a screen or window. The value is a list of four doubles:
-///   [left, top, width, height]
-const String _frameKey = 'frame';
-/// The frame of a screen available for use by applications. The value format
-/// is the same as _frameKey's.
-///
-/// Only used for screens.
-const String _visibleFrameKey = 'visibleFrame';
-/// The scale factor for a screen or window, as a double.
-///
-/// This is the number of pixels per screen coordinate, and thus the ratio
-/// between sizes as seen by Flutter and sizes in native screen coordinates.
-const String _scaleFactorKey = 'scaleFactor';
-/// The screen containing this window, if any. The value is a screen map, or
-/// null if the window is not visible on a screen.
-///
-/// Only used for windows.
-///
-/// If a window is on multiple screens, it is up to the platform to decide which
-/// screen to report.
-const String _screenKey = 'screen';
+/// An easing curve for [WindowSizeChannel.animateWindowFrame].
+enum WindowFrameCurve {
+  /// Constant speed.
+  linear,
+
+  /// Starts slowly, then speeds up (cubic).
+  easeIn,
+
+  /// Starts quickly, then slows down (cubic).
+  easeOut,
+
+  /// Starts and ends slowly (cubic).
+  easeInOut,
+}
+
+// The channel's names for each curve.
+const Map<WindowFrameCurve, String> _curveNames = {
+  WindowFrameCurve.linear: 'linear',
+  WindowFrameCurve.easeIn: 'easeIn',
+  WindowFrameCurve.easeOut: 'easeOut',
+  WindowFrameCurve.easeInOut: 'easeInOut',
+};
+
+// The indices of the fields in a kWindowUpdatedMethod callback's Float64List.
+const int _windowStateLeft = 0;
+const int _windowStateTop = 1;
+const int _windowStateWidth = 2;
+const int _windowStateHeight = 3;
+const int _windowStateScaleFactor = 4;
+const int _windowStateScreenIndex = 5;
 
 /// A singleton object that handles the interaction with the platform channel.
 class WindowSizeChannel {
   /// Private constructor.
-  WindowSizeChannel._();
+  WindowSizeChannel._() {
+    _platformChannel.setMethodCallHandler(_callbackHandler);
+    _windowUpdatesController = StreamController<PlatformWindow>.broadcast(
+        onListen: () => _setWindowUpdatesEnabled(true),
+        onCancel: () => _setWindowUpdatesEnabled(false));
+  }
 
   final MethodChannel _platformChannel =
-      const MethodChannel(_windowSizeChannelName);
+      const MethodChannel(kChannelName);
 
   /// The static instance of the menu channel.
   static final WindowSizeChannel instance = new WindowSizeChannel._();
 
+  final StreamController<List<Screen>> _screensChangedController =
+      StreamController<List<Screen>>.broadcast();
+
+  /// A stream of the new screen list, sent whenever screens are added or
+  /// removed, or change size or scale factor.
+  ///
+  /// Currently only sent on Linux.
+  Stream<List<Screen>> get screensChanged => _screensChangedController.stream;
+
+  StreamController<PlatformWindow> _windowUpdatesController;
+
+  /// The latest screen list, used to look up the screen in window updates.
+  List<Screen> _screens = <Screen>[];
+
+  /// A stream of the state of the window containing this Flutter instance,
+  /// sent while there are listeners whenever its frame, scale factor, or
+  /// screen changes. The platform sends at most one update per frame
+  /// interval, with only the latest state.
+  ///
+  /// Currently only sent on Linux.
+  Stream<PlatformWindow> get windowUpdates => _windowUpdatesController.stream;
+
   /// Returns a list of screens.
   Future<List<Screen>> getScreenList() async {
     try {
-      final screenList = <Screen>[];
       final response =
-          await _platformChannel.invokeMethod(_getScreenListMethod);
-
-      for (final screenInfo in response) {
-        screenList.add(_screenFromInfoMap(screenInfo));
-      }
-      return screenList;
+          await _platformChannel.invokeMethod(kGetScreenListMethod);
+      _screens = _screenListFromResponse(response);
+      return _screens;
     } on PlatformException catch (e) {
       print('Platform exception getting screen list: ${e.message}');
     }
@@ -91,55 +106,188 @@ class WindowSizeChannel {
   /// Returns information about the window containing this Flutter instance.
   Future<PlatformWindow> getWindowInfo() async {
     try {
-      final response =
-          await _platformChannel.invokeMethod(_getWindowInfoMethod);
+      final response = WindowInfo.decode(
+          await _platformChannel.invokeMethod(kGetWindowInfoMethod));
 
-      return PlatformWindow(
-          _rectFromLTWHList(response[_frameKey].cast<double>()),
-          response[_scaleFactorKey],
-          _screenFromInfoMap(response[_screenKey]));
+      return PlatformWindow(_rectFromFrameRect(response.frame),
+          response.scaleFactor, _screenFromInfo(response.screen));
     } on PlatformException catch (e) {
       print('Platform exception getting window info: ${e.message}');
     }
     return null;
   }
 
+  /// Returns whether the platform created the window containing this
+  /// Flutter instance with the geometry it had when last closed.
+  Future<bool> isWindowGeometryRestored() async {
+    try {
+      return await _platformChannel
+          .invokeMethod(kIsWindowGeometryRestoredMethod);
+    } on PlatformException catch (e) {
+      print('Platform exception checking window geometry: ${e.message}');
+    } on MissingPluginException {
+      // Platforms that don't restore geometry don't implement the method.
+    }
+    return false;
+  }
+
   /// Sets the frame of the window containing this Flutter instance, in
-  /// screen coordinates.
+  /// screen coordinates, completing once the frame has been applied.
   ///
   /// The platform may adjust the frame as necessary if the provided frame would
   /// cause significant usability issues (e.g., a window with no visible portion
   /// that can be used to move the window).
-  void setWindowFrame(Rect frame) async {
+  Future<void> setWindowFrame(Rect frame) async {
     assert(!frame.isEmpty, 'Cannot set window frame to an empty rect.');
     assert(frame.isFinite, 'Cannot set window frame to a non-finite rect.');
     try {
-      await _platformChannel.invokeMethod(_setWindowFrameMethod,
-          [frame.left, frame.top, frame.width, frame.height]);
+      await _platformChannel.invokeMethod(
+          kSetWindowFrameMethod,
+          FrameRect(
+                  left: frame.left,
+                  top: frame.top,
+                  width: frame.width,
+                  height: frame.height)
+              .encode());
     } on PlatformException catch (e) {
       print('Platform exception setting window frame: ${e.message}');
     }
   }
 
-  /// Given an array of the form [left, top, width, height], return the
-  /// corresponding [Rect].
+  /// Animates the frame of the window containing this Flutter instance to
+  /// [target], in screen coordinates, over [duration], completing when the
+  /// animation ends.
+  ///
+  /// The animation runs natively, paced to the display's refresh rate.
+  /// Starting another animation, or calling [setWindowFrame], stops it where
+  /// it is.
+  Future<void> animateWindowFrame(Rect target, Duration duration,
+      WindowFrameCurve curve) async {
+    assert(!target.isEmpty, 'Cannot animate window frame to an empty rect.');
+    assert(
+        target.isFinite, 'Cannot animate window frame to a non-finite rect.');
+    try {
+      await _platformChannel.invokeMethod(
+          kAnimateWindowFrameMethod,
+          WindowFrameAnimation(
+                  target: FrameRect(
+                      left: target.left,
+                      top: target.top,
+                      width: target.width,
+                      height: target.height),
+                  durationMs: duration.inMilliseconds,
+                  curve: _curveNames[curve])
+              .encode());
+    } on PlatformException catch (e) {
+      print('Platform exception animating window frame: ${e.message}');
+    }
+  }
+
+  /// Sets the minimum size of the window containing this Flutter instance, in
+  /// screen coordinates. A dimension of 0 has no minimum.
   ///
-  /// Used for frame deserialization in the platform channel.
-  Rect _rectFromLTWHList(List<double> ltwh) {
-    return Rect.fromLTWH(ltwh[0], ltwh[1], ltwh[2], ltwh[3]);
+  /// The platform enforces the limit natively, including while the user
+  /// resizes the window.
+  Future<void> setWindowMinSize(Size size) async {
+    await _setSizeLimit(kSetWindowMinSizeMethod, size);
   }
 
-  /// Given a map of information about a screen, return the corresponding
-  /// [Screen] object, or null.
+  /// Sets the maximum size of the window containing this Flutter instance, in
+  /// screen coordinates. A dimension of 0 or infinity has no maximum.
   ///
-  /// Used for screen deserialization in the platform channel.
-  Screen _screenFromInfoMap(Map<dynamic, dynamic> map) {
-    if (map == null) {
+  /// The platform enforces the limit natively, including while the user
+  /// resizes the window.
+  Future<void> setWindowMaxSize(Size size) async {
+    await _setSizeLimit(kSetWindowMaxSizeMethod, size);
+  }
+
+  /// Constrains the width of the window containing this Flutter instance
+  /// divided by its height to [aspectRatio], or removes the constraint if it
+  /// is 0.
+  ///
+  /// The platform enforces the constraint natively, including while the user
+  /// resizes the window.
+  Future<void> setAspectRatio(double aspectRatio) async {
+    assert(aspectRatio >= 0 && aspectRatio.isFinite,
+        'Aspect ratio must be finite and non-negative.');
+    try {
+      await _platformChannel.invokeMethod(kSetAspectRatioMethod, aspectRatio);
+    } on PlatformException catch (e) {
+      print('Platform exception setting aspect ratio: ${e.message}');
+    }
+  }
+
+  /// Sends [size] as the size limit set by [method], with infinite
+  /// dimensions sent as 0.
+  Future<void> _setSizeLimit(String method, Size size) async {
+    assert(size.width >= 0 && size.height >= 0,
+        'Window size limits cannot be negative.');
+    try {
+      await _platformChannel.invokeMethod(
+          method,
+          WindowSize(
+                  width: size.width.isFinite ? size.width : 0.0,
+                  height: size.height.isFinite ? size.height : 0.0)
+              .encode());
+    } on PlatformException catch (e) {
+      print('Platform exception setting window size limit: ${e.message}');
+    }
+  }
+
+  /// Handles calls from the platform side of the channel.
+  Future<void> _callbackHandler(MethodCall methodCall) async {
+    if (methodCall.method == kScreensChangedMethod) {
+      _screens = _screenListFromResponse(methodCall.arguments);
+      _screensChangedController.add(_screens);
+    } else if (methodCall.method == kWindowUpdatedMethod) {
+      final Float64List state = methodCall.arguments;
+      final screenIndex = state[_windowStateScreenIndex].toInt();
+      _windowUpdatesController.add(PlatformWindow(
+          Rect.fromLTWH(state[_windowStateLeft], state[_windowStateTop],
+              state[_windowStateWidth], state[_windowStateHeight]),
+          state[_windowStateScaleFactor],
+          screenIndex >= 0 && screenIndex < _screens.length
+              ? _screens[screenIndex]
+              : null));
+    }
+  }
+
+  /// Enables or disables window updates from the platform.
+  Future<void> _setWindowUpdatesEnabled(bool enabled) async {
+    try {
+      if (enabled) {
+        // Updates identify the screen by its index in the screen list.
+        await getScreenList();
+      }
+      await _platformChannel.invokeMethod(
+          kSetWindowUpdatesEnabledMethod, enabled);
+    } on PlatformException catch (e) {
+      print('Platform exception setting window updates: ${e.message}');
+    } on MissingPluginException {
+      // Platforms without updates just don't send any.
+    }
+  }
+
+  /// Returns the screens in a response containing a list of [ScreenInfo].
+  List<Screen> _screenListFromResponse(dynamic response) {
+    final screenList = <Screen>[];
+    for (final screenInfo in response) {
+      screenList.add(_screenFromInfo(ScreenInfo.decode(screenInfo)));
+    }
+    return screenList;
+  }
+
+  /// Returns the [Rect] corresponding to [frame].
+  Rect _rectFromFrameRect(FrameRect frame) {
+    return Rect.fromLTWH(frame.left, frame.top, frame.width, frame.height);
+  }
+
+  /// Returns the [Screen] corresponding to [info], or null.
+  Screen _screenFromInfo(ScreenInfo info) {
+    if (info == null) {
       return null;
     }
-    return Screen(
-        _rectFromLTWHList(map[_frameKey].cast<double>()),
-        _rectFromLTWHList(map[_visibleFrameKey].cast<double>()),
-        map[_scaleFactorKey]);
+    return Screen(_rectFromFrameRect(info.frame),
+        _rectFromFrameRect(info.visibleFrame), info.scaleFactor);
   }
 }
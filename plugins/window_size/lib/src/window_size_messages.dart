@@ -0,0 +1,274 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/generate_channel_bindings.dart from
+// plugins/window_size/window_size_messages.idl. Do not edit.
+
+/// The name of the platform channel.
+const String kChannelName = 'flutter/windowsize';
+
+/// Returns a list of ScreenInfo for the available screens.
+const String kGetScreenListMethod = 'getScreenList';
+
+/// Returns a WindowInfo for the window containing the Flutter instance.
+const String kGetWindowInfoMethod = 'getWindowInfo';
+
+/// Sets the frame of the window to a FrameRect argument. Frames set within
+/// one iteration of the event loop are coalesced, so only the last is
+/// applied. Returns once that frame has been applied.
+const String kSetWindowFrameMethod = 'setWindowFrame';
+
+/// Animates the window's frame according to a WindowFrameAnimation argument,
+/// paced to the display's refresh rate. Returns once the animation finishes,
+/// or is replaced by another animation or by SetWindowFrame, which stop it
+/// where it is.
+const String kAnimateWindowFrameMethod = 'animateWindowFrame';
+
+/// Sets the minimum size of the window to a WindowSize argument; a dimension
+/// of 0 has no minimum. The window system enforces the limit, including
+/// during interactive resizing, and frames from SetWindowFrame and
+/// AnimateWindowFrame are clamped to it. A window outside the limit is
+/// resized to fit. Fails for a negative or NaN dimension, or for a minimum
+/// above the maximum.
+const String kSetWindowMinSizeMethod = 'setWindowMinSize';
+
+/// As SetWindowMinSize, for the maximum size.
+const String kSetWindowMaxSizeMethod = 'setWindowMaxSize';
+
+/// Constrains the window's width divided by its height to a double argument,
+/// or removes the constraint if it is 0. Enforced as for SetWindowMinSize.
+/// Fails for a ratio that no window can have, such as a negative one.
+const String kSetAspectRatioMethod = 'setAspectRatio';
+
+/// Returns a bool: whether the runner created the window with the geometry
+/// it had when last closed, in which case the app shouldn't apply its own
+/// initial placement. On Linux, this is whether the file passed to
+/// WindowSizeSetGeometryFile held a saved geometry.
+const String kIsWindowGeometryRestoredMethod = 'isWindowGeometryRestored';
+
+/// Enables or disables WindowUpdated callbacks. The argument is a bool.
+const String kSetWindowUpdatesEnabledMethod = 'setWindowUpdatesEnabled';
+
+/// Called on the Dart side, while enabled by SetWindowUpdatesEnabled, when the
+/// window's frame, scale factor, or screen changes, at most once per frame
+/// interval and with only the latest state. The argument is a Float64List of
+/// the frame's left, top, width, and height, the scale factor, and the index
+/// of the window's screen in the list from GetScreenList, or -1 if it isn't on
+/// one.
+const String kWindowUpdatedMethod = 'windowUpdated';
+
+/// Called on the Dart side when screens are added, removed, or change size or
+/// scale factor. The argument is the new list of ScreenInfo, as returned by
+/// GetScreenList.
+const String kScreensChangedMethod = 'screensChanged';
+
+/// A rectangle in screen coordinates.
+class FrameRect {
+  /// Creates a message with the given field values.
+  FrameRect({
+    this.left,
+    this.top,
+    this.width,
+    this.height,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory FrameRect.decode(Object message) {
+    final List<dynamic> list = message;
+    return FrameRect(
+      left: list[0],
+      top: list[1],
+      width: list[2],
+      height: list[3],
+    );
+  }
+
+  /// The left edge.
+  double left;
+
+  /// The top edge.
+  double top;
+
+  /// The width.
+  double width;
+
+  /// The height.
+  double height;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    return <dynamic>[
+      left,
+      top,
+      width,
+      height,
+    ];
+  }
+}
+
+/// A size in screen coordinates.
+class WindowSize {
+  /// Creates a message with the given field values.
+  WindowSize({
+    this.width,
+    this.height,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory WindowSize.decode(Object message) {
+    final List<dynamic> list = message;
+    return WindowSize(
+      width: list[0],
+      height: list[1],
+    );
+  }
+
+  /// The width.
+  double width;
+
+  /// The height.
+  double height;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    return <dynamic>[
+      width,
+      height,
+    ];
+  }
+}
+
+/// An animation of the window's frame from its current frame to a target.
+class WindowFrameAnimation {
+  /// Creates a message with the given field values.
+  WindowFrameAnimation({
+    this.target,
+    this.durationMs,
+    this.curve,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory WindowFrameAnimation.decode(Object message) {
+    final Map<dynamic, dynamic> map = message;
+    return WindowFrameAnimation(
+      target: FrameRect.decode(map['target']),
+      durationMs: map['durationMs'],
+      curve: map['curve'],
+    );
+  }
+
+  /// The frame to animate to.
+  FrameRect target;
+
+  /// The duration of the animation, in milliseconds.
+  int durationMs;
+
+  /// The easing curve: "linear", or the cubic "easeIn", "easeOut", or
+  /// "easeInOut". Defaults to "easeInOut".
+  String curve;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    final map = <String, dynamic>{
+      'target': target.encode(),
+      'durationMs': durationMs,
+    };
+    if (curve != null) {
+      map['curve'] = curve;
+    }
+    return map;
+  }
+}
+
+/// Information about a screen.
+class ScreenInfo {
+  /// Creates a message with the given field values.
+  ScreenInfo({
+    this.frame,
+    this.visibleFrame,
+    this.scaleFactor,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory ScreenInfo.decode(Object message) {
+    final Map<dynamic, dynamic> map = message;
+    return ScreenInfo(
+      frame: FrameRect.decode(map['frame']),
+      visibleFrame: FrameRect.decode(map['visibleFrame']),
+      scaleFactor: map['scaleFactor'],
+    );
+  }
+
+  /// The frame of the screen.
+  FrameRect frame;
+
+  /// The portion of the screen's frame that is available for use by
+  /// application windows. E.g., on macOS, this excludes the menu bar.
+  FrameRect visibleFrame;
+
+  /// The number of pixels per screen coordinate for the screen.
+  double scaleFactor;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    final map = <String, dynamic>{
+      'frame': frame.encode(),
+      'visibleFrame': visibleFrame.encode(),
+      'scaleFactor': scaleFactor,
+    };
+    return map;
+  }
+}
+
+/// Information about a window.
+class WindowInfo {
+  /// Creates a message with the given field values.
+  WindowInfo({
+    this.frame,
+    this.scaleFactor,
+    this.screen,
+  });
+
+  /// Creates a message from its platform channel representation.
+  factory WindowInfo.decode(Object message) {
+    final Map<dynamic, dynamic> map = message;
+    return WindowInfo(
+      frame: FrameRect.decode(map['frame']),
+      scaleFactor: map['scaleFactor'],
+      screen: map['screen'] == null ? null : ScreenInfo.decode(map['screen']),
+    );
+  }
+
+  /// The frame of the window.
+  FrameRect frame;
+
+  /// The number of pixels per screen coordinate for the window.
+  double scaleFactor;
+
+  /// The screen containing the window, if it is on one. If a window is on
+  /// multiple screens, it is up to the platform to decide which to report.
+  ScreenInfo screen;
+
+  /// Returns the platform channel representation of this message.
+  Object encode() {
+    final map = <String, dynamic>{
+      'frame': frame.encode(),
+      'scaleFactor': scaleFactor,
+    };
+    if (screen != null) {
+      map['screen'] = screen.encode();
+    }
+    return map;
+  }
+}
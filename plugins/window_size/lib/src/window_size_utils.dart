@@ -26,6 +26,23 @@ Future<List<Screen>> getScreenList() async {
   return await WindowSizeChannel.instance.getScreenList();
 }
 
+/// A stream of the new list of [Screen]s, sent whenever screens are added or
+/// removed, or change size or scale factor, so that there's no need to poll
+/// [getScreenList].
+///
+/// Currently only sent on Linux.
+Stream<List<Screen>> get onScreensChanged =>
+    WindowSizeChannel.instance.screensChanged;
+
+/// A stream of the state of the window containing this Flutter instance, sent
+/// whenever its frame, scale factor, or screen changes, so that there's no need
+/// to poll [getWindowInfo]. Updates are sent at most once per frame interval,
+/// with only the latest state, and only while the stream has listeners.
+///
+/// Currently only sent on Linux.
+Stream<PlatformWindow> get onWindowChanged =>
+    WindowSizeChannel.instance.windowUpdates;
+
 /// Returns the [Screen] showing the window that contains this Flutter instance.
 ///
 /// If the window is not being displayed, returns null. If the window is being
@@ -40,12 +57,74 @@ Future<PlatformWindow> getWindowInfo() async {
   return await WindowSizeChannel.instance.getWindowInfo();
 }
 
+/// Returns whether the window containing this Flutter instance was created
+/// with the size and position it had when last closed, in which case an app
+/// shouldn't apply its own initial placement.
+///
+/// Currently only restored on Linux, by runners that enable it.
+Future<bool> isWindowGeometryRestored() async {
+  return await WindowSizeChannel.instance.isWindowGeometryRestored();
+}
+
 /// Sets the frame of the window containing this Flutter instance, in
 /// screen coordinates.
 ///
 /// The platform may adjust the frame as necessary if the provided frame would
 /// cause significant usability issues (e.g., a window with no visible portion
-/// that can be used to move the window).
-void setWindowFrame(Rect frame) async {
-  WindowSizeChannel.instance.setWindowFrame(frame);
+/// that can be used to move the window). Frames set in quick succession may be
+/// coalesced, so that only the last is applied; to move the window smoothly,
+/// use [animateWindowFrame].
+///
+/// Completes once the frame, or one set after it, has been applied, so that
+/// [getWindowInfo] then reports it.
+Future<void> setWindowFrame(Rect frame) async {
+  await WindowSizeChannel.instance.setWindowFrame(frame);
+}
+
+/// Animates the frame of the window containing this Flutter instance to
+/// [target], in screen coordinates, over [duration], completing when the
+/// animation ends.
+///
+/// Unlike calling [setWindowFrame] on every tick of a Dart animation, the
+/// animation runs natively, paced to the display's refresh rate. Starting
+/// another animation, or calling [setWindowFrame], stops it where it is.
+///
+/// Currently only supported on Linux.
+Future<void> animateWindowFrame(Rect target,
+    {Duration duration = const Duration(milliseconds: 200),
+    WindowFrameCurve curve = WindowFrameCurve.easeInOut}) async {
+  await WindowSizeChannel.instance.animateWindowFrame(target, duration, curve);
+}
+
+/// Sets the minimum size of the window containing this Flutter instance, in
+/// screen coordinates. A dimension of 0 has no minimum.
+///
+/// The limit is enforced natively, including while the user resizes the
+/// window, so there's no need to clamp the window from Dart. Frames set with
+/// [setWindowFrame] and [animateWindowFrame] are adjusted to satisfy it.
+///
+/// Currently only supported on Linux.
+Future<void> setWindowMinSize(Size size) async {
+  await WindowSizeChannel.instance.setWindowMinSize(size);
+}
+
+/// Sets the maximum size of the window containing this Flutter instance, in
+/// screen coordinates. A dimension of 0 or infinity has no maximum.
+///
+/// Enforced as for [setWindowMinSize].
+///
+/// Currently only supported on Linux.
+Future<void> setWindowMaxSize(Size size) async {
+  await WindowSizeChannel.instance.setWindowMaxSize(size);
+}
+
+/// Constrains the width of the window containing this Flutter instance divided
+/// by its height to [aspectRatio], or removes the constraint if it is 0.
+///
+/// Enforced as for [setWindowMinSize]. If the constraints conflict, the size
+/// limits take precedence.
+///
+/// Currently only supported on Linux.
+Future<void> setAspectRatio(double aspectRatio) async {
+  await WindowSizeChannel.instance.setAspectRatio(aspectRatio);
 }
@@ -13,4 +13,5 @@
 // limitations under the License.
 export 'src/platform_window.dart';
 export 'src/screen.dart';
+export 'src/window_size_channel.dart' show WindowFrameCurve;
 export 'src/window_size_utils.dart';
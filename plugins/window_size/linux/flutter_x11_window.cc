@@ -0,0 +1,267 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "plugins/window_size/linux/flutter_x11_window.h"
+
+#include <X11/Xatom.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <gdk/gdkx.h>
+#include <gtk/gtk.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace plugins_window_size {
+
+namespace {
+
+// The smaller term of the fraction given to the window manager for an aspect
+// ratio, which sets its precision.
+constexpr int kAspectRatioPrecision = 10000;
+
+// The most 32-bit values read from a property.
+constexpr long kMaxPropertyLength = 1 << 16;
+
+// Returns |value| limited to the range [minimum, maximum], where a limit of 0
+// means that there is no limit.
+int ApplyLimits(int value, int minimum, int maximum) {
+  if (maximum > 0) {
+    value = std::min(value, maximum);
+  }
+  if (minimum > 0) {
+    value = std::max(value, minimum);
+  }
+  return value;
+}
+
+// Returns |value| rounded to the nearest int from 1 to |maximum|, treating NaN
+// as 1, so that computations with extreme aspect ratios can't overflow.
+int RoundAndClamp(double value, int maximum) {
+  if (!(value >= 1)) {
+    return 1;
+  }
+  if (value >= maximum) {
+    return maximum;
+  }
+  return static_cast<int>(std::lround(value));
+}
+
+// Returns the values of |window|'s |property|, which must be a list of 32-bit
+// values of type |type|, or an empty list if it isn't set.
+std::vector<unsigned long> GetProperty(Display *display, Window window,
+                                       Atom property, Atom type) {
+  Atom actual_type;
+  int actual_format;
+  unsigned long count;
+  unsigned long bytes_after;
+  unsigned char *data = nullptr;
+  std::vector<unsigned long> values;
+  if (XGetWindowProperty(display, window, property, 0, kMaxPropertyLength,
+                         False, type, &actual_type, &actual_format, &count,
+                         &bytes_after, &data) == Success &&
+      data && actual_type == type && actual_format == 32) {
+    // Xlib returns 32-bit values as longs.
+    auto *longs = reinterpret_cast<unsigned long *>(data);
+    values.assign(longs, longs + count);
+  }
+  if (data) {
+    XFree(data);
+  }
+  return values;
+}
+
+// Returns whether |window| is the Flutter window: a window of this process,
+// other than GDK's own windows such as dialogs, with the size of |frame|.
+bool IsFlutterWindow(GdkDisplay *gdk_display, Window window,
+                     const flutter::WindowFrame &frame) {
+  if (gdk_x11_window_lookup_for_display(gdk_display, window)) {
+    return false;
+  }
+  Display *display = gdk_x11_display_get_xdisplay(gdk_display);
+  Atom pid_atom =
+      gdk_x11_get_xatom_by_name_for_display(gdk_display, "_NET_WM_PID");
+  std::vector<unsigned long> window_pid =
+      GetProperty(display, window, pid_atom, XA_CARDINAL);
+  if (window_pid.size() != 1 ||
+      window_pid[0] != static_cast<unsigned long>(getpid())) {
+    return false;
+  }
+  XWindowAttributes attributes;
+  return XGetWindowAttributes(display, window, &attributes) &&
+         attributes.width == frame.width && attributes.height == frame.height;
+}
+
+// Returns the children of |window|, bottom-most first.
+std::vector<Window> GetChildren(Display *display, Window window) {
+  Window root;
+  Window parent;
+  Window *children = nullptr;
+  unsigned int count = 0;
+  std::vector<Window> result;
+  if (XQueryTree(display, window, &root, &parent, &children, &count) &&
+      children) {
+    result.assign(children, children + count);
+    XFree(children);
+  }
+  return result;
+}
+
+// Returns the Flutter window, or 0 if it isn't found. It is either a child of
+// the root window or, once a reparenting window manager has framed it, a
+// child of one. The window manager's client list isn't used since a window
+// that was just mapped may not be in it yet.
+Window FindFlutterWindow(GdkDisplay *gdk_display,
+                         const flutter::WindowFrame &frame) {
+  Display *display = gdk_x11_display_get_xdisplay(gdk_display);
+  for (Window top_level : GetChildren(display, DefaultRootWindow(display))) {
+    if (IsFlutterWindow(gdk_display, top_level, frame)) {
+      return top_level;
+    }
+    for (Window child : GetChildren(display, top_level)) {
+      if (IsFlutterWindow(gdk_display, child, frame)) {
+        return child;
+      }
+    }
+  }
+  return 0;
+}
+
+}  // namespace
+
+flutter::WindowFrame ConstrainFrame(const flutter::WindowFrame &frame,
+                                    const SizeConstraints &constraints) {
+  flutter::WindowFrame result = frame;
+  result.width =
+      ApplyLimits(frame.width, constraints.min_width, constraints.max_width);
+  result.height = ApplyLimits(frame.height, constraints.min_height,
+                              constraints.max_height);
+  if (constraints.aspect_ratio > 0) {
+    // Keep the width if the matching height is within the limits.
+    result.height = ApplyLimits(
+        RoundAndClamp(result.width / constraints.aspect_ratio, kMaxWindowSize),
+        constraints.min_height, constraints.max_height);
+    result.width = ApplyLimits(
+        RoundAndClamp(result.height * constraints.aspect_ratio, kMaxWindowSize),
+        constraints.min_width, constraints.max_width);
+  }
+  return result;
+}
+
+FlutterX11Window::~FlutterX11Window() {
+  if (filtering_events_) {
+    gdk_window_remove_filter(nullptr, FilterEvent, this);
+  }
+}
+
+bool FlutterX11Window::Find(const flutter::WindowFrame &frame) {
+  if (window_) {
+    return true;
+  }
+  GdkDisplay *gdk_display = gdk_display_get_default();
+  if (!gdk_display || !GDK_IS_X11_DISPLAY(gdk_display)) {
+    return false;
+  }
+  // Errors, such as from a window being destroyed while it is being
+  // examined, just mean that the window isn't found.
+  gdk_x11_display_error_trap_push(gdk_display);
+  window_ = FindFlutterWindow(gdk_display, frame);
+  gdk_x11_display_error_trap_pop_ignored(gdk_display);
+  return window_ != 0;
+}
+
+void FlutterX11Window::SetSizeHints(const SizeConstraints &constraints) {
+  if (!window_) {
+    return;
+  }
+  GdkDisplay *gdk_display = gdk_display_get_default();
+  Display *display = gdk_x11_display_get_xdisplay(gdk_display);
+  gdk_x11_display_error_trap_push(gdk_display);
+  XSizeHints *hints = XAllocSizeHints();
+  long supplied = 0;
+  // Keep the hints that GLFW set, such as the window gravity.
+  XGetWMNormalHints(display, window_, hints, &supplied);
+  hints->flags &= ~(PMinSize | PMaxSize | PAspect);
+  if (constraints.min_width > 0 || constraints.min_height > 0) {
+    hints->flags |= PMinSize;
+    hints->min_width = constraints.min_width;
+    hints->min_height = constraints.min_height;
+  }
+  if (constraints.max_width > 0 || constraints.max_height > 0) {
+    hints->flags |= PMaxSize;
+    hints->max_width =
+        constraints.max_width > 0 ? constraints.max_width : kMaxWindowSize;
+    hints->max_height =
+        constraints.max_height > 0 ? constraints.max_height : kMaxWindowSize;
+  }
+  if (constraints.aspect_ratio > 0) {
+    hints->flags |= PAspect;
+    // Keep the smaller term fixed, so that neither rounds to 0.
+    int max_term = std::numeric_limits<int>::max();
+    if (constraints.aspect_ratio >= 1) {
+      hints->min_aspect.x = RoundAndClamp(
+          constraints.aspect_ratio * kAspectRatioPrecision, max_term);
+      hints->min_aspect.y = kAspectRatioPrecision;
+    } else {
+      hints->min_aspect.x = kAspectRatioPrecision;
+      hints->min_aspect.y = RoundAndClamp(
+          kAspectRatioPrecision / constraints.aspect_ratio, max_term);
+    }
+    hints->max_aspect = hints->min_aspect;
+  }
+  XSetWMNormalHints(display, window_, hints);
+  XFree(hints);
+  XFlush(display);
+  gdk_x11_display_error_trap_pop_ignored(gdk_display);
+}
+
+void FlutterX11Window::SetConfigureHandler(std::function<void()> handler) {
+  if (!window_) {
+    return;
+  }
+  if (!filtering_events_) {
+    GdkDisplay *gdk_display = gdk_display_get_default();
+    Display *display = gdk_x11_display_get_xdisplay(gdk_display);
+    // Event masks are per client, so this doesn't change the events that
+    // GLFW receives. Window managers report moves of framed windows with
+    // synthetic ConfigureNotify events, which are sent with this mask.
+    gdk_x11_display_error_trap_push(gdk_display);
+    XSelectInput(display, window_, StructureNotifyMask);
+    XFlush(display);
+    gdk_x11_display_error_trap_pop_ignored(gdk_display);
+    // GDK passes events for windows it doesn't know to filters that aren't
+    // attached to a window.
+    gdk_window_add_filter(nullptr, FilterEvent, this);
+    filtering_events_ = true;
+  }
+  configure_handler_ = std::move(handler);
+}
+
+// static
+GdkFilterReturn FlutterX11Window::FilterEvent(GdkXEvent *xevent,
+                                              GdkEvent *event, gpointer data) {
+  auto *window = static_cast<FlutterX11Window *>(data);
+  auto *x_event = static_cast<XEvent *>(xevent);
+  if (x_event->type == ConfigureNotify &&
+      x_event->xconfigure.window == window->window_ &&
+      window->configure_handler_) {
+    window->configure_handler_();
+  }
+  return GDK_FILTER_CONTINUE;
+}
+
+}  // namespace plugins_window_size
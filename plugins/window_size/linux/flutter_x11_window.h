@@ -0,0 +1,100 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef PLUGINS_WINDOW_SIZE_LINUX_FLUTTER_X11_WINDOW_H_
+#define PLUGINS_WINDOW_SIZE_LINUX_FLUTTER_X11_WINDOW_H_
+
+#include <flutter/flutter_window.h>
+#include <gdk/gdk.h>
+
+#include <functional>
+
+namespace plugins_window_size {
+
+// The largest window dimension that X11 supports.
+constexpr int kMaxWindowSize = 32767;
+
+// The most extreme aspect ratios a window can have: those of windows 1 by
+// kMaxWindowSize and kMaxWindowSize by 1.
+constexpr double kMinAspectRatio = 1.0 / kMaxWindowSize;
+constexpr double kMaxAspectRatio = kMaxWindowSize;
+
+// Limits on the window's size, in screen coordinates. A limit of 0 means
+// that there is no limit.
+struct SizeConstraints {
+  // At most kMaxWindowSize, and no more than the maximum where both are set.
+  int min_width = 0;
+  int min_height = 0;
+  int max_width = 0;
+  int max_height = 0;
+  // The width divided by the height, from kMinAspectRatio to kMaxAspectRatio,
+  // or 0.
+  double aspect_ratio = 0;
+};
+
+// Returns |frame| resized, keeping its top left corner in place, to satisfy
+// |constraints| as closely as possible. The size limits take precedence over
+// the aspect ratio if they conflict.
+flutter::WindowFrame ConstrainFrame(const flutter::WindowFrame &frame,
+                                    const SizeConstraints &constraints);
+
+// The Flutter window's X11 window, used for what GLFW doesn't expose: passing
+// size constraints to the window manager as WM_NORMAL_HINTS, so that they are
+// enforced during interactive resizing without Flutter seeing sizes outside
+// them, and observing moves and resizes.
+//
+// GLFW creates the window outside of GDK, and the Flutter wrapper doesn't
+// expose it, so the X11 window is found among the top-level windows by its
+// process ID and size. Xlib is only used in the implementation, since its
+// macros (such as Success) clash with names used by the plugin.
+class FlutterX11Window {
+ public:
+  FlutterX11Window() = default;
+  ~FlutterX11Window();
+
+  // Prevent copying.
+  FlutterX11Window(FlutterX11Window const &) = delete;
+  FlutterX11Window &operator=(FlutterX11Window const &) = delete;
+
+  // Finds the window, whose current frame is |frame|, if it hasn't already
+  // been found. Returns false if it can't be found, such as when not running
+  // on X11.
+  bool Find(const flutter::WindowFrame &frame);
+
+  // Sets the window's hints for |constraints|. Does nothing if the window
+  // hasn't been found.
+  void SetSizeHints(const SizeConstraints &constraints);
+
+  // Sets the function called after each move or resize of the window,
+  // whether by the user, the window manager, or the application. Does
+  // nothing if the window hasn't been found.
+  void SetConfigureHandler(std::function<void()> handler);
+
+ private:
+  // GDK event filter that calls |configure_handler_| for the window's
+  // ConfigureNotify events; |data| is the FlutterX11Window.
+  static GdkFilterReturn FilterEvent(GdkXEvent *xevent, GdkEvent *event,
+                                     gpointer data);
+
+  // The window's XID, once found, or 0.
+  unsigned long window_ = 0;
+
+  // The function set by SetConfigureHandler, or null, and whether
+  // FilterEvent has been added to GDK to call it.
+  std::function<void()> configure_handler_;
+  bool filtering_events_ = false;
+};
+
+}  // namespace plugins_window_size
+
+#endif  // PLUGINS_WINDOW_SIZE_LINUX_FLUTTER_X11_WINDOW_H_
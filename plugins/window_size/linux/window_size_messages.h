@@ -0,0 +1,477 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generated by tools/generate_channel_bindings.dart from
+// plugins/window_size/window_size_messages.idl. Do not edit.
+//
+// String and list fields use the reader's arena, if any; see
+// plugins/common/linux/arena.h.
+
+#ifndef PLUGINS_WINDOW_SIZE_LINUX_WINDOW_SIZE_MESSAGES_H_
+#define PLUGINS_WINDOW_SIZE_LINUX_WINDOW_SIZE_MESSAGES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "plugins/common/linux/arena.h"
+#include "plugins/common/linux/method_table.h"
+#include "plugins/common/linux/standard_codec_stream.h"
+
+namespace plugins_window_size {
+
+using plugins_common::Decode;
+using plugins_common::Encode;
+
+constexpr char kChannelName[] = "flutter/windowsize";
+
+// Returns a list of ScreenInfo for the available screens.
+constexpr char kGetScreenListMethod[] = "getScreenList";
+
+// Returns a WindowInfo for the window containing the Flutter instance.
+constexpr char kGetWindowInfoMethod[] = "getWindowInfo";
+
+// Sets the frame of the window to a FrameRect argument. Frames set within
+// one iteration of the event loop are coalesced, so only the last is
+// applied. Returns once that frame has been applied.
+constexpr char kSetWindowFrameMethod[] = "setWindowFrame";
+
+// Animates the window's frame according to a WindowFrameAnimation argument,
+// paced to the display's refresh rate. Returns once the animation finishes,
+// or is replaced by another animation or by SetWindowFrame, which stop it
+// where it is.
+constexpr char kAnimateWindowFrameMethod[] = "animateWindowFrame";
+
+// Sets the minimum size of the window to a WindowSize argument; a dimension
+// of 0 has no minimum. The window system enforces the limit, including
+// during interactive resizing, and frames from SetWindowFrame and
+// AnimateWindowFrame are clamped to it. A window outside the limit is
+// resized to fit. Fails for a negative or NaN dimension, or for a minimum
+// above the maximum.
+constexpr char kSetWindowMinSizeMethod[] = "setWindowMinSize";
+
+// As SetWindowMinSize, for the maximum size.
+constexpr char kSetWindowMaxSizeMethod[] = "setWindowMaxSize";
+
+// Constrains the window's width divided by its height to a double argument,
+// or removes the constraint if it is 0. Enforced as for SetWindowMinSize.
+// Fails for a ratio that no window can have, such as a negative one.
+constexpr char kSetAspectRatioMethod[] = "setAspectRatio";
+
+// Returns a bool: whether the runner created the window with the geometry
+// it had when last closed, in which case the app shouldn't apply its own
+// initial placement. On Linux, this is whether the file passed to
+// WindowSizeSetGeometryFile held a saved geometry.
+constexpr char kIsWindowGeometryRestoredMethod[] = "isWindowGeometryRestored";
+
+// Enables or disables WindowUpdated callbacks. The argument is a bool.
+constexpr char kSetWindowUpdatesEnabledMethod[] = "setWindowUpdatesEnabled";
+
+// Called on the Dart side, while enabled by SetWindowUpdatesEnabled, when the
+// window's frame, scale factor, or screen changes, at most once per frame
+// interval and with only the latest state. The argument is a Float64List of
+// the frame's left, top, width, and height, the scale factor, and the index
+// of the window's screen in the list from GetScreenList, or -1 if it isn't on
+// one.
+constexpr char kWindowUpdatedMethod[] = "windowUpdated";
+
+// Called on the Dart side when screens are added, removed, or change size or
+// scale factor. The argument is the new list of ScreenInfo, as returned by
+// GetScreenList.
+constexpr char kScreensChangedMethod[] = "screensChanged";
+
+// The methods handled by the plugin, for TypedMethodChannel.
+enum class Method {
+  kGetScreenList,
+  kGetWindowInfo,
+  kSetWindowFrame,
+  kAnimateWindowFrame,
+  kSetWindowMinSize,
+  kSetWindowMaxSize,
+  kSetAspectRatio,
+  kIsWindowGeometryRestored,
+  kSetWindowUpdatesEnabled,
+};
+
+constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {
+    {kGetScreenListMethod, Method::kGetScreenList},
+    {kGetWindowInfoMethod, Method::kGetWindowInfo},
+    {kSetWindowFrameMethod, Method::kSetWindowFrame},
+    {kAnimateWindowFrameMethod, Method::kAnimateWindowFrame},
+    {kSetWindowMinSizeMethod, Method::kSetWindowMinSize},
+    {kSetWindowMaxSizeMethod, Method::kSetWindowMaxSize},
+    {kSetAspectRatioMethod, Method::kSetAspectRatio},
+    {kIsWindowGeometryRestoredMethod, Method::kIsWindowGeometryRestored},
+    {kSetWindowUpdatesEnabledMethod, Method::kSetWindowUpdatesEnabled},
+};
+constexpr auto kMethods = plugins_common::MakeMethodTable(kMethodEntries);
+
+// A rectangle in screen coordinates.
+struct FrameRect {
+  // The left edge.
+  double left = 0.0;
+  // The top edge.
+  double top = 0.0;
+  // The width.
+  double width = 0.0;
+  // The height.
+  double height = 0.0;
+};
+
+// A size in screen coordinates.
+struct WindowSize {
+  // The width.
+  double width = 0.0;
+  // The height.
+  double height = 0.0;
+};
+
+// An animation of the window's frame from its current frame to a target.
+struct WindowFrameAnimation {
+  // The frame to animate to.
+  FrameRect target;
+  // The duration of the animation, in milliseconds.
+  int64_t duration_ms = 0;
+  // The easing curve: "linear", or the cubic "easeIn", "easeOut", or
+  // "easeInOut". Defaults to "easeInOut".
+  plugins_common::ArenaString curve;
+  bool has_curve = false;
+};
+
+// Information about a screen.
+struct ScreenInfo {
+  // The frame of the screen.
+  FrameRect frame;
+  // The portion of the screen's frame that is available for use by
+  // application windows. E.g., on macOS, this excludes the menu bar.
+  FrameRect visible_frame;
+  // The number of pixels per screen coordinate for the screen.
+  double scale_factor = 0.0;
+};
+
+// Information about a window.
+struct WindowInfo {
+  // The frame of the window.
+  FrameRect frame;
+  // The number of pixels per screen coordinate for the window.
+  double scale_factor = 0.0;
+  // The screen containing the window, if it is on one. If a window is on
+  // multiple screens, it is up to the platform to decide which to report.
+  ScreenInfo screen;
+  bool has_screen = false;
+};
+
+inline void Encode(const FrameRect &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   FrameRect *value);
+inline void Encode(const WindowSize &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   WindowSize *value);
+inline void Encode(const WindowFrameAnimation &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   WindowFrameAnimation *value);
+inline void Encode(const ScreenInfo &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   ScreenInfo *value);
+inline void Encode(const WindowInfo &value,
+                   plugins_common::StandardCodecWriter *writer);
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   WindowInfo *value);
+
+inline void Encode(const FrameRect &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  writer->WriteListSize(4);
+  Encode(value.left, writer);
+  Encode(value.top, writer);
+  Encode(value.width, writer);
+  Encode(value.height, writer);
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   FrameRect *value) {
+  size_t size;
+  if (!reader->ReadListSize(&size) || size != 4) {
+    return false;
+  }
+  if (!Decode(reader, &value->left)) {
+    return false;
+  }
+  if (!Decode(reader, &value->top)) {
+    return false;
+  }
+  if (!Decode(reader, &value->width)) {
+    return false;
+  }
+  if (!Decode(reader, &value->height)) {
+    return false;
+  }
+  return true;
+}
+
+inline void Encode(const WindowSize &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  writer->WriteListSize(2);
+  Encode(value.width, writer);
+  Encode(value.height, writer);
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   WindowSize *value) {
+  size_t size;
+  if (!reader->ReadListSize(&size) || size != 2) {
+    return false;
+  }
+  if (!Decode(reader, &value->width)) {
+    return false;
+  }
+  if (!Decode(reader, &value->height)) {
+    return false;
+  }
+  return true;
+}
+
+inline void Encode(const WindowFrameAnimation &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  size_t size = 2;
+  if (value.has_curve) {
+    ++size;
+  }
+  writer->WriteMapSize(size);
+  writer->WriteString("target", 6);
+  Encode(value.target, writer);
+  writer->WriteString("durationMs", 10);
+  Encode(value.duration_ms, writer);
+  if (value.has_curve) {
+    writer->WriteString("curve", 5);
+    Encode(value.curve, writer);
+  }
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   WindowFrameAnimation *value) {
+  size_t size;
+  enum class Field {
+    kTarget,
+    kDurationMs,
+    kCurve,
+  };
+  static constexpr plugins_common::MethodEntry<Field> kFields[] = {
+      {"target", Field::kTarget},
+      {"durationMs", Field::kDurationMs},
+      {"curve", Field::kCurve},
+  };
+  static constexpr auto kFieldTable =
+      plugins_common::MakeMethodTable(kFields);
+  // Set as each field that isn't optional is read.
+  bool read_target = false;
+  bool read_duration_ms = false;
+  if (!reader->ReadMapSize(&size)) {
+    return false;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    const char *key;
+    size_t key_size;
+    if (!reader->ReadStringView(&key, &key_size)) {
+      return false;
+    }
+    const Field *field = kFieldTable.Find(key, key_size);
+    if (!field) {
+      // Ignore fields this version of the schema doesn't have.
+      if (!reader->Skip()) {
+        return false;
+      }
+      continue;
+    }
+    switch (*field) {
+      case Field::kTarget:
+        if (!Decode(reader, &value->target)) {
+          return false;
+        }
+        read_target = true;
+        break;
+      case Field::kDurationMs:
+        if (!Decode(reader, &value->duration_ms)) {
+          return false;
+        }
+        read_duration_ms = true;
+        break;
+      case Field::kCurve:
+        value->has_curve = !reader->ReadNull();
+        if (value->has_curve &&
+            !Decode(reader, &value->curve)) {
+          return false;
+        }
+        break;
+    }
+  }
+  return read_target && read_duration_ms;
+}
+
+inline void Encode(const ScreenInfo &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  size_t size = 3;
+  writer->WriteMapSize(size);
+  writer->WriteString("frame", 5);
+  Encode(value.frame, writer);
+  writer->WriteString("visibleFrame", 12);
+  Encode(value.visible_frame, writer);
+  writer->WriteString("scaleFactor", 11);
+  Encode(value.scale_factor, writer);
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   ScreenInfo *value) {
+  size_t size;
+  enum class Field {
+    kFrame,
+    kVisibleFrame,
+    kScaleFactor,
+  };
+  static constexpr plugins_common::MethodEntry<Field> kFields[] = {
+      {"frame", Field::kFrame},
+      {"visibleFrame", Field::kVisibleFrame},
+      {"scaleFactor", Field::kScaleFactor},
+  };
+  static constexpr auto kFieldTable =
+      plugins_common::MakeMethodTable(kFields);
+  // Set as each field that isn't optional is read.
+  bool read_frame = false;
+  bool read_visible_frame = false;
+  bool read_scale_factor = false;
+  if (!reader->ReadMapSize(&size)) {
+    return false;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    const char *key;
+    size_t key_size;
+    if (!reader->ReadStringView(&key, &key_size)) {
+      return false;
+    }
+    const Field *field = kFieldTable.Find(key, key_size);
+    if (!field) {
+      // Ignore fields this version of the schema doesn't have.
+      if (!reader->Skip()) {
+        return false;
+      }
+      continue;
+    }
+    switch (*field) {
+      case Field::kFrame:
+        if (!Decode(reader, &value->frame)) {
+          return false;
+        }
+        read_frame = true;
+        break;
+      case Field::kVisibleFrame:
+        if (!Decode(reader, &value->visible_frame)) {
+          return false;
+        }
+        read_visible_frame = true;
+        break;
+      case Field::kScaleFactor:
+        if (!Decode(reader, &value->scale_factor)) {
+          return false;
+        }
+        read_scale_factor = true;
+        break;
+    }
+  }
+  return read_frame && read_visible_frame && read_scale_factor;
+}
+
+inline void Encode(const WindowInfo &value,
+                   plugins_common::StandardCodecWriter *writer) {
+  size_t size = 2;
+  if (value.has_screen) {
+    ++size;
+  }
+  writer->WriteMapSize(size);
+  writer->WriteString("frame", 5);
+  Encode(value.frame, writer);
+  writer->WriteString("scaleFactor", 11);
+  Encode(value.scale_factor, writer);
+  if (value.has_screen) {
+    writer->WriteString("screen", 6);
+    Encode(value.screen, writer);
+  }
+}
+
+inline bool Decode(plugins_common::StandardCodecReader *reader,
+                   WindowInfo *value) {
+  size_t size;
+  enum class Field {
+    kFrame,
+    kScaleFactor,
+    kScreen,
+  };
+  static constexpr plugins_common::MethodEntry<Field> kFields[] = {
+      {"frame", Field::kFrame},
+      {"scaleFactor", Field::kScaleFactor},
+      {"screen", Field::kScreen},
+  };
+  static constexpr auto kFieldTable =
+      plugins_common::MakeMethodTable(kFields);
+  // Set as each field that isn't optional is read.
+  bool read_frame = false;
+  bool read_scale_factor = false;
+  if (!reader->ReadMapSize(&size)) {
+    return false;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    const char *key;
+    size_t key_size;
+    if (!reader->ReadStringView(&key, &key_size)) {
+      return false;
+    }
+    const Field *field = kFieldTable.Find(key, key_size);
+    if (!field) {
+      // Ignore fields this version of the schema doesn't have.
+      if (!reader->Skip()) {
+        return false;
+      }
+      continue;
+    }
+    switch (*field) {
+      case Field::kFrame:
+        if (!Decode(reader, &value->frame)) {
+          return false;
+        }
+        read_frame = true;
+        break;
+      case Field::kScaleFactor:
+        if (!Decode(reader, &value->scale_factor)) {
+          return false;
+        }
+        read_scale_factor = true;
+        break;
+      case Field::kScreen:
+        value->has_screen = !reader->ReadNull();
+        if (value->has_screen &&
+            !Decode(reader, &value->screen)) {
+          return false;
+        }
+        break;
+    }
+  }
+  return read_frame && read_scale_factor;
+}
+
+}  // namespace plugins_window_size
+
+#endif  // PLUGINS_WINDOW_SIZE_LINUX_WINDOW_SIZE_MESSAGES_H_
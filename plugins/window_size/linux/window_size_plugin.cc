@@ -14,32 +14,32 @@
 #include "plugins/window_size/linux/window_size_plugin.h"
 
 #include <flutter/flutter_window.h>
-#include <flutter/method_channel.h>
 #include <flutter/plugin_registrar_glfw.h>
-#include <flutter/standard_method_codec.h>
 #include <gtk/gtk.h>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "plugins/common/linux/typed_method_channel.h"
+#include "plugins/common/linux/window_geometry_file.h"
+#include "plugins/window_size/linux/flutter_x11_window.h"
+#include "plugins/window_size/linux/window_size_messages.h"
+
 namespace plugins_window_size {
 
 namespace {
 
-using flutter::EncodableList;
-using flutter::EncodableMap;
-using flutter::EncodableValue;
-
-// See window_size_channel.dart for documentation.
-const char kChannelName[] = "flutter/windowsize";
-const char kGetScreenListMethod[] = "getScreenList";
-const char kGetWindowInfoMethod[] = "getWindowInfo";
-const char kSetWindowFrameMethod[] = "setWindowFrame";
-const char kFrameKey[] = "frame";
-const char kVisibleFrameKey[] = "visibleFrame";
-const char kScaleFactorKey[] = "scaleFactor";
-const char kScreenKey[] = "screen";
+using plugins_common::MethodReply;
+using plugins_common::StandardCodecReader;
+using plugins_common::TypedMethodChannel;
+using plugins_common::WindowGeometry;
 
 // Returns the screen object that contains monitors.
 GdkScreen *GetScreen() {
@@ -51,94 +51,411 @@ GdkScreen *GetScreen() {
   return screen;
 }
 
-// Returns the serializable form of |frame| expected by the platform channel.
-EncodableValue GetPlatformChannelRepresentationForFrame(
-    const GdkRectangle &frame) {
-  return EncodableValue(EncodableList{
-      EncodableValue(static_cast<double>(frame.x)),
-      EncodableValue(static_cast<double>(frame.y)),
-      EncodableValue(static_cast<double>(frame.width)),
-      EncodableValue(static_cast<double>(frame.height)),
-  });
+// Returns the channel message for |frame|.
+FrameRect GetFrameRect(const GdkRectangle &frame) {
+  FrameRect rect;
+  rect.left = frame.x;
+  rect.top = frame.y;
+  rect.width = frame.width;
+  rect.height = frame.height;
+  return rect;
 }
 
-// Extracts information from monitor |monitor_index| of |screen| and returns the
-// serializable form expected by the platform channel.
+// Returns the channel message for monitor |monitor_index| of |screen|, and
+// its frame in |frame|.
 // TODO: Switch to GdkMonitor once GTK-3.22 is sufficiently available.
-EncodableValue GetPlatformChannelRepresentationForMonitor(GdkScreen *screen,
-                                                          gint monitor_index) {
-  if (!screen || monitor_index == -1) {
-    return EncodableValue();
-  }
-
-  GdkRectangle frame = {};
-  gdk_screen_get_monitor_geometry(screen, monitor_index, &frame);
+ScreenInfo GetScreenInfo(GdkScreen *screen, gint monitor_index,
+                         GdkRectangle *frame) {
+  gdk_screen_get_monitor_geometry(screen, monitor_index, frame);
   GdkRectangle visible_frame = {};
   gdk_screen_get_monitor_workarea(screen, monitor_index, &visible_frame);
-  double scale_factor =
+  ScreenInfo info;
+  info.frame = GetFrameRect(*frame);
+  info.visible_frame = GetFrameRect(visible_frame);
+  info.scale_factor =
       gdk_screen_get_monitor_scale_factor(screen, monitor_index);
-  return EncodableValue(EncodableMap{
-      {EncodableValue(kFrameKey),
-       GetPlatformChannelRepresentationForFrame(frame)},
-      {EncodableValue(kVisibleFrameKey),
-       GetPlatformChannelRepresentationForFrame(visible_frame)},
-      {EncodableValue(kScaleFactorKey), EncodableValue(scale_factor)},
-  });
+  return info;
 }
 
-// Returns the monitor treated as containing a window with the given frame,
-// if any.
-//
-// The heuristic used is:
-// - If a monitor contains the frame's origin, return that.
-// - If not, but there is at least one monitor, return the first one.
-// - Otherwise, return -1.
+// Returns the area of the intersection of |a| and |b|.
+int64_t OverlapArea(const GdkRectangle &a, const GdkRectangle &b) {
+  int64_t width = std::min(a.x + a.width, b.x + b.width) - std::max(a.x, b.x);
+  int64_t height =
+      std::min(a.y + a.height, b.y + b.height) - std::max(a.y, b.y);
+  return width > 0 && height > 0 ? width * height : 0;
+}
+
+// A cached table of the default screen's monitors, so that method calls don't
+// query GDK for every monitor each time.
 //
-// TODO: Switch to returning GdkMonitor once GTK-3.22 is sufficiently available.
-gint GetMonitorIndexForWindowFrame(const GdkRectangle &frame) {
-  // Treat the window as being on whichever monitor contains its origin. If
-  // none do, use the first monitor (if there is one).
-  GdkScreen *screen = GetScreen();
-  if (!screen) {
+// The table is rebuilt only when GDK reports a change: the screen's
+// monitors-changed or size-changed signals, or (with GTK 3.22 or later) a
+// change in a monitor's scale factor. Changes usually arrive as several
+// signals at once, so they are coalesced in an idle callback, which rebuilds
+// the table and then calls the change handler.
+class MonitorTable {
+ public:
+  // Creates a table that calls |on_changed| after each change to the
+  // monitors.
+  explicit MonitorTable(std::function<void()> on_changed);
+  ~MonitorTable();
+
+  // Prevent copying.
+  MonitorTable(MonitorTable const &) = delete;
+  MonitorTable &operator=(MonitorTable const &) = delete;
+
+  // Returns the channel message for each monitor.
+  const std::vector<ScreenInfo> &screens() {
+    Update();
+    return screens_;
+  }
+
+  // Returns the index in screens() of the monitor treated as containing a
+  // window with the given frame, or -1 if there are no monitors.
+  //
+  // This is the monitor with the largest overlap with the frame or, if none
+  // overlap it, the first monitor.
+  int MonitorIndexForFrame(const GdkRectangle &frame);
+
+  // Returns the frame of the monitor at |index| in screens().
+  const GdkRectangle &monitor_frame(int index) {
+    Update();
+    return frames_[index];
+  }
+
+ private:
+  // Rebuilds the table if it is out of date.
+  void Update();
+
+  // Connects to the change signals of |screen_| and, if available, its
+  // monitors.
+  void ConnectSignals();
+  void DisconnectSignals();
+
+  // Signal handler for all changes; |user_data| is the table.
+  static void OnMonitorsChanged(gpointer user_data);
+
+  // Idle callback that applies the changes reported since it was scheduled.
+  static gboolean ApplyChanges(gpointer user_data);
+
+  std::function<void()> on_changed_;
+  GdkScreen *screen_ = nullptr;
+  // The objects that |this| is connected to, each with a reference held.
+  std::vector<GObject *> connected_objects_;
+  // The idle source scheduled by a change, or 0.
+  guint apply_changes_source_ = 0;
+
+  bool valid_ = false;
+  std::vector<ScreenInfo> screens_;
+  // The frame of each monitor in |screens_|.
+  std::vector<GdkRectangle> frames_;
+};
+
+MonitorTable::MonitorTable(std::function<void()> on_changed)
+    : on_changed_(std::move(on_changed)), screen_(GetScreen()) {
+  ConnectSignals();
+}
+
+MonitorTable::~MonitorTable() {
+  DisconnectSignals();
+  if (apply_changes_source_) {
+    g_source_remove(apply_changes_source_);
+  }
+}
+
+int MonitorTable::MonitorIndexForFrame(const GdkRectangle &frame) {
+  Update();
+  if (screens_.empty()) {
     return -1;
   }
-  int monitor_count = gdk_screen_get_n_monitors(screen);
-  for (int i = 0; i < monitor_count; ++i) {
-    GdkRectangle monitor_frame = {};
-    gdk_screen_get_monitor_geometry(screen, i, &monitor_frame);
-    if ((frame.x >= monitor_frame.x &&
-         frame.x <= monitor_frame.x + monitor_frame.width) &&
-        (frame.y >= monitor_frame.y &&
-         frame.y <= monitor_frame.y + monitor_frame.width)) {
-      return i;
+  size_t best_index = 0;
+  int64_t best_area = 0;
+  for (size_t i = 0; i < frames_.size(); ++i) {
+    int64_t area = OverlapArea(frame, frames_[i]);
+    if (area > best_area) {
+      best_index = i;
+      best_area = area;
     }
   }
-  if (monitor_count > 0) {
-    return 0;
+  return static_cast<int>(best_index);
+}
+
+void MonitorTable::Update() {
+  if (!screen_) {
+    // There may have been no display when the table was created.
+    screen_ = GetScreen();
+    ConnectSignals();
+    if (screen_) {
+      valid_ = false;
+    }
+  }
+  if (valid_) {
+    return;
+  }
+  valid_ = true;
+  screens_.clear();
+  frames_.clear();
+  if (!screen_) {
+    return;
+  }
+  int monitor_count = gdk_screen_get_n_monitors(screen_);
+  screens_.reserve(monitor_count);
+  frames_.resize(monitor_count);
+  for (int i = 0; i < monitor_count; ++i) {
+    screens_.push_back(GetScreenInfo(screen_, i, &frames_[i]));
+  }
+}
+
+void MonitorTable::ConnectSignals() {
+  if (!screen_) {
+    return;
+  }
+  connected_objects_.push_back(G_OBJECT(g_object_ref(screen_)));
+  g_signal_connect_swapped(screen_, "monitors-changed",
+                           G_CALLBACK(OnMonitorsChanged), this);
+  g_signal_connect_swapped(screen_, "size-changed",
+                           G_CALLBACK(OnMonitorsChanged), this);
+#if GTK_CHECK_VERSION(3, 22, 0)
+  GdkDisplay *display = gdk_screen_get_display(screen_);
+  int monitor_count = gdk_display_get_n_monitors(display);
+  for (int i = 0; i < monitor_count; ++i) {
+    GdkMonitor *monitor = gdk_display_get_monitor(display, i);
+    connected_objects_.push_back(G_OBJECT(g_object_ref(monitor)));
+    g_signal_connect_swapped(monitor, "notify::scale-factor",
+                             G_CALLBACK(OnMonitorsChanged), this);
+  }
+#endif
+}
+
+void MonitorTable::DisconnectSignals() {
+  for (GObject *object : connected_objects_) {
+    g_signal_handlers_disconnect_by_data(object, this);
+    g_object_unref(object);
   }
-  return -1;
+  connected_objects_.clear();
 }
 
-// Extracts information from |window| and returns the serializable form expected
-// by the platform channel.
-EncodableValue GetPlatformChannelRepresentationForWindow(
-    flutter::FlutterWindow *window) {
+// static
+void MonitorTable::OnMonitorsChanged(gpointer user_data) {
+  auto *table = static_cast<MonitorTable *>(user_data);
+  table->valid_ = false;
+  if (!table->apply_changes_source_) {
+    table->apply_changes_source_ = g_idle_add(ApplyChanges, table);
+  }
+}
+
+// static
+gboolean MonitorTable::ApplyChanges(gpointer user_data) {
+  auto *table = static_cast<MonitorTable *>(user_data);
+  table->apply_changes_source_ = 0;
+  // The set of monitors may have changed, so reconnect to the current ones.
+  table->DisconnectSignals();
+  table->ConnectSignals();
+  table->Update();
+  table->on_changed_();
+  return G_SOURCE_REMOVE;
+}
+
+// Returns the frame of |window|.
+GdkRectangle GetWindowFrame(flutter::FlutterWindow *window) {
   flutter::WindowFrame frame = window->GetFrame();
   GdkRectangle gdk_frame = {};
   gdk_frame.x = frame.left;
   gdk_frame.y = frame.top;
   gdk_frame.width = frame.width;
   gdk_frame.height = frame.height;
+  return gdk_frame;
+}
 
-  return EncodableValue(EncodableMap{
-      {EncodableValue(kFrameKey),
-       GetPlatformChannelRepresentationForFrame(gdk_frame)},
-      {EncodableValue(kScreenKey),
-       GetPlatformChannelRepresentationForMonitor(
-           GetScreen(), GetMonitorIndexForWindowFrame(gdk_frame))},
-      {EncodableValue(kScaleFactorKey),
-       EncodableValue(window->GetScaleFactor())},
-  });
+// Returns the channel message for |window|, using |monitors| to find its
+// screen.
+WindowInfo GetWindowInfo(flutter::FlutterWindow *window,
+                         MonitorTable *monitors) {
+  GdkRectangle frame = GetWindowFrame(window);
+  WindowInfo info;
+  info.frame = GetFrameRect(frame);
+  info.scale_factor = window->GetScaleFactor();
+  int monitor_index = monitors->MonitorIndexForFrame(frame);
+  if (monitor_index != -1) {
+    info.screen = monitors->screens()[monitor_index];
+    info.has_screen = true;
+  }
+  return info;
+}
+
+// The window state sent by the WindowUpdated callback, whose argument is a
+// Float64List of |values| rather than a map, so that frequent updates are
+// cheap to encode and decode.
+struct WindowState {
+  enum Field {
+    kLeft,
+    kTop,
+    kWidth,
+    kHeight,
+    kScaleFactor,
+    kScreenIndex,
+    kFieldCount,
+  };
+  double values[kFieldCount];
+};
+
+bool operator==(const WindowState &a, const WindowState &b) {
+  return std::equal(std::begin(a.values), std::end(a.values),
+                    std::begin(b.values));
+}
+
+void Encode(const WindowState &state,
+            plugins_common::StandardCodecWriter *writer) {
+  writer->WriteFloat64List(state.values, WindowState::kFieldCount);
+}
+
+// Returns the current state of |window|, using |monitors| to find its screen.
+WindowState GetWindowState(flutter::FlutterWindow *window,
+                           MonitorTable *monitors) {
+  GdkRectangle frame = GetWindowFrame(window);
+  WindowState state;
+  state.values[WindowState::kLeft] = frame.x;
+  state.values[WindowState::kTop] = frame.y;
+  state.values[WindowState::kWidth] = frame.width;
+  state.values[WindowState::kHeight] = frame.height;
+  state.values[WindowState::kScaleFactor] = window->GetScaleFactor();
+  state.values[WindowState::kScreenIndex] =
+      monitors->MonitorIndexForFrame(frame);
+  return state;
+}
+
+// Returns the geometry of |window| to save, using |monitors| to find the
+// monitor it is on.
+WindowGeometry GetWindowGeometry(flutter::FlutterWindow *window,
+                                 MonitorTable *monitors) {
+  GdkRectangle frame = GetWindowFrame(window);
+  WindowGeometry geometry;
+  geometry.left = frame.x;
+  geometry.top = frame.y;
+  geometry.width = frame.width;
+  geometry.height = frame.height;
+  int monitor_index = monitors->MonitorIndexForFrame(frame);
+  if (monitor_index != -1) {
+    const GdkRectangle &monitor = monitors->monitor_frame(monitor_index);
+    geometry.monitor_left = monitor.x;
+    geometry.monitor_top = monitor.y;
+    geometry.monitor_width = monitor.width;
+    geometry.monitor_height = monitor.height;
+  }
+  return geometry;
+}
+
+// The path set by WindowSizeSetGeometryFile, or empty if the window's
+// geometry isn't saved.
+std::string *GetGeometryFilePath() {
+  static auto *path = new std::string();
+  return path;
+}
+
+// How long the window must be left unchanged before a change to it is saved
+// to the geometry file, so that a drag or a resize is written once, after it
+// ends.
+constexpr guint kGeometrySaveDelayMs = 500;
+
+// The refresh interval to pace animations to if the display's is unknown.
+constexpr guint kDefaultRefreshIntervalMs = 16;
+
+// Returns the refresh interval of the monitor showing the center of |frame|.
+guint GetRefreshIntervalMs(const flutter::WindowFrame &frame) {
+#if GTK_CHECK_VERSION(3, 22, 0)
+  GdkDisplay *display = gdk_display_get_default();
+  GdkMonitor *monitor =
+      display ? gdk_display_get_monitor_at_point(
+                    display, frame.left + frame.width / 2,
+                    frame.top + frame.height / 2)
+              : nullptr;
+  // In millihertz, or 0 if unknown.
+  int refresh_rate = monitor ? gdk_monitor_get_refresh_rate(monitor) : 0;
+  if (refresh_rate > 0) {
+    return std::max(1, 1000000 / refresh_rate);
+  }
+#endif
+  return kDefaultRefreshIntervalMs;
+}
+
+// An easing curve for window frame animations.
+enum class AnimationCurve { kLinear, kEaseIn, kEaseOut, kEaseInOut };
+
+// Sets |curve| to the curve named |name| in a WindowFrameAnimation. Returns
+// false if there is no such curve.
+bool ParseAnimationCurve(const plugins_common::ArenaString &name,
+                         AnimationCurve *curve) {
+  if (name == "linear") {
+    *curve = AnimationCurve::kLinear;
+  } else if (name == "easeIn") {
+    *curve = AnimationCurve::kEaseIn;
+  } else if (name == "easeOut") {
+    *curve = AnimationCurve::kEaseOut;
+  } else if (name == "easeInOut") {
+    *curve = AnimationCurve::kEaseInOut;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+// Returns the eased progress for linear progress |t|, from 0 to 1.
+double ApplyAnimationCurve(AnimationCurve curve, double t) {
+  switch (curve) {
+    case AnimationCurve::kLinear:
+      return t;
+    case AnimationCurve::kEaseIn:
+      return t * t * t;
+    case AnimationCurve::kEaseOut:
+      return 1 - (1 - t) * (1 - t) * (1 - t);
+    case AnimationCurve::kEaseInOut:
+      return t < 0.5 ? 4 * t * t * t
+                     : 1 - 4 * (1 - t) * (1 - t) * (1 - t);
+  }
+  return t;
+}
+
+// Returns the value |progress| of the way from |from| to |to|.
+int Interpolate(int from, int to, double progress) {
+  return static_cast<int>(std::lround(from + (to - from) * progress));
+}
+
+// Sets |limit| to the limit for a dimension of a SetWindowMinSize or
+// SetWindowMaxSize argument: 0, meaning no limit, for 0 or infinity, and
+// otherwise |value| rounded down. Returns false if |value| is negative, NaN,
+// or larger than any window can be.
+bool GetSizeLimit(double value, int *limit) {
+  if (std::isinf(value) && value > 0) {
+    *limit = 0;
+    return true;
+  }
+  // Also rejects NaN.
+  if (!(value >= 0 && value <= kMaxWindowSize)) {
+    return false;
+  }
+  *limit = static_cast<int>(value);
+  return true;
+}
+
+// Returns whether each minimum in |constraints| is at most the corresponding
+// maximum, where both are set.
+bool MinSizeFitsMaxSize(const SizeConstraints &constraints) {
+  return (constraints.min_width == 0 || constraints.max_width == 0 ||
+          constraints.min_width <= constraints.max_width) &&
+         (constraints.min_height == 0 || constraints.max_height == 0 ||
+          constraints.min_height <= constraints.max_height);
+}
+
+// Returns the window frame for a FrameRect.
+flutter::WindowFrame GetWindowFrameForRect(const FrameRect &rect) {
+  // Frame validity (e.g., non-zero size) is assumed to be checked on the
+  // Dart side of the call.
+  flutter::WindowFrame frame = {};
+  frame.left = static_cast<int>(rect.left);
+  frame.top = static_cast<int>(rect.top);
+  frame.width = static_cast<int>(rect.width);
+  frame.height = static_cast<int>(rect.height);
+  return frame;
 }
 
 }  // namespace
@@ -149,89 +466,601 @@ class WindowSizePlugin : public flutter::Plugin {
 
   virtual ~WindowSizePlugin();
 
+  // Saves the geometry change waiting for kGeometrySaveDelayMs, if any, of
+  // the plugin saving geometry; see WindowSizeSaveGeometry.
+  static void SaveGeometryOfInstance();
+
  private:
   // Creates a plugin that communicates on the given channel.
-  WindowSizePlugin(
-      std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel,
-      flutter::FlutterWindow *window);
+  WindowSizePlugin(std::unique_ptr<TypedMethodChannel> channel,
+                   flutter::FlutterWindow *window,
+                   std::string geometry_path);
 
   // Called when a method is called on |channel_|;
-  void HandleMethodCall(
-      const flutter::MethodCall<EncodableValue> &method_call,
-      std::unique_ptr<flutter::MethodResult<EncodableValue>> result);
+  void HandleMethodCall(Method method, StandardCodecReader *arguments,
+                        MethodReply reply);
 
-  // The MethodChannel used for communication with the Flutter engine.
-  std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel_;
+  // The channel used for communication with the Flutter engine.
+  std::unique_ptr<TypedMethodChannel> channel_;
 
   // The Flutter window.
   flutter::FlutterWindow *window_;
+
+  // Sets the window's frame to |frame| once the current iteration of the
+  // event loop is done, replacing any frame already waiting to be set, so
+  // that a burst of SetWindowFrame calls causes only one resize. Stops any
+  // animation. If |reply| is provided, it is sent once the frame, or one
+  // replacing it, has been set.
+  void SetFrameSoon(const flutter::WindowFrame &frame,
+                    std::unique_ptr<MethodReply> reply = nullptr);
+
+  // Idle callback that sets |pending_frame_|; |user_data| is the plugin.
+  static gboolean SetPendingFrame(gpointer user_data);
+
+  // Sends the replies in |pending_frame_replies_|.
+  void CompletePendingFrameReplies();
+
+  // Starts animating the window's frame as described by |animation|, with
+  // the given |curve|, replacing any animation already running. |reply| is
+  // sent when the animation ends.
+  void StartAnimation(const WindowFrameAnimation &animation,
+                      AnimationCurve curve, MethodReply reply);
+
+  // Stops the running animation, if any, leaving the window where it is.
+  void StopAnimation();
+
+  // Timer callback that moves the window to the next frame of the
+  // animation; |user_data| is the plugin.
+  static gboolean StepAnimation(gpointer user_data);
+
+  // Enables or disables WindowUpdated callbacks.
+  //
+  // Updates are sent in response to the window's ConfigureNotify events and
+  // to monitor changes, coalesced to at most one per refresh interval. If
+  // the X11 window can't be found, such as under another display server,
+  // the window is instead checked once per refresh interval.
+  void SetWindowUpdatesEnabled(bool enabled);
+
+  // Schedules a WindowUpdated callback for the end of the current refresh
+  // interval, if updates are enabled and one isn't already scheduled.
+  void ScheduleWindowUpdate();
+
+  // Timer callbacks that send a WindowUpdated callback if the window has
+  // changed since the last one, once for a scheduled update, or repeatedly
+  // when checking the window periodically; |user_data| is the plugin.
+  static gboolean SendScheduledWindowUpdate(gpointer user_data);
+  static gboolean CheckForWindowUpdate(gpointer user_data);
+
+  // Sends a WindowUpdated callback if the window has changed since the last
+  // one.
+  void SendWindowUpdate();
+
+  // Finds the X11 window and starts handling its ConfigureNotify events, if
+  // that hasn't already been done. Returns false if the window can't be
+  // found.
+  bool ObserveWindow();
+
+  // Replaces the window's size constraints with |constraints|, passing them
+  // to the window manager, and resizes the window if it is outside them.
+  void SetSizeConstraints(const SizeConstraints &constraints);
+
+  // Moves the window onto a connected monitor if the one it was on when
+  // |restored| was saved is no longer connected, since the runner restores
+  // the saved position without knowing what monitors there are.
+  void EnsureRestoredFrameIsVisible(const WindowGeometry &restored);
+
+  // Called after each move or resize of the window once it is observed.
+  // Schedules a window update and, if the geometry is saved, records the new
+  // geometry and schedules it to be saved once the window stops changing.
+  void HandleWindowConfigured();
+
+  // Timer callback that saves the geometry recorded by
+  // HandleWindowConfigured; |user_data| is the plugin.
+  static gboolean SaveGeometryAfterDelay(gpointer user_data);
+
+  // Writes |unsaved_geometry_| to the geometry file if it differs from the
+  // file's contents.
+  void SaveGeometry();
+
+  // The plugin saving geometry, if any, for SaveGeometryOfInstance.
+  static WindowSizePlugin *geometry_saver_;
+
+  // The monitors, which are reported to Dart whenever they change.
+  MonitorTable monitors_;
+
+  // The constraints set from Dart, which frames set by the plugin are
+  // adjusted to satisfy.
+  SizeConstraints size_constraints_;
+
+  // The window's X11 window, which passes the constraints to the window
+  // manager and reports moves and resizes once |observing_window_|.
+  FlutterX11Window x11_window_;
+  bool observing_window_ = false;
+
+  // The geometry file, or empty if the geometry isn't saved.
+  std::string geometry_path_;
+  // Whether the file held a saved geometry, which the runner has restored.
+  bool geometry_restored_ = false;
+  // The geometry in the file.
+  WindowGeometry saved_geometry_;
+  // The geometry after the last change, while |has_unsaved_geometry_|. It is
+  // read when the change happens, rather than when it is saved, since the
+  // window may have been destroyed by then.
+  WindowGeometry unsaved_geometry_;
+  bool has_unsaved_geometry_ = false;
+  // The timer saving |unsaved_geometry_|, or 0.
+  guint geometry_save_source_ = 0;
+
+  // Whether WindowUpdated callbacks are enabled, and the timer that will
+  // send one or, if the window isn't observed, checks for changes, or 0.
+  bool window_updates_enabled_ = false;
+  guint window_update_source_ = 0;
+  // The state last sent in a WindowUpdated callback, if any.
+  WindowState last_window_state_;
+  bool has_sent_window_state_ = false;
+
+  // The frame to be set by SetPendingFrame, while |pending_frame_source_| is
+  // scheduled.
+  flutter::WindowFrame pending_frame_ = {};
+  guint pending_frame_source_ = 0;
+  // The replies to SetWindowFrame calls whose frames are waiting to be set,
+  // including those replaced by a later call.
+  std::vector<std::unique_ptr<MethodReply>> pending_frame_replies_;
+
+  // The running animation, while |animation_source_| is scheduled. Times are
+  // from g_get_monotonic_time, in microseconds.
+  guint animation_source_ = 0;
+  flutter::WindowFrame animation_start_frame_ = {};
+  flutter::WindowFrame animation_target_frame_ = {};
+  gint64 animation_start_time_ = 0;
+  gint64 animation_duration_ = 0;
+  AnimationCurve animation_curve_ = AnimationCurve::kLinear;
+  std::unique_ptr<MethodReply> animation_reply_;
 };
 
 // static
 void WindowSizePlugin::RegisterWithRegistrar(
     flutter::PluginRegistrarGlfw *registrar) {
-  auto channel = std::make_unique<flutter::MethodChannel<EncodableValue>>(
-      registrar->messenger(), kChannelName,
-      &flutter::StandardMethodCodec::GetInstance());
+  auto channel = std::make_unique<TypedMethodChannel>(registrar->messenger(),
+                                                      kChannelName);
   auto *channel_pointer = channel.get();
 
   // Uses new instead of make_unique due to private constructor.
   std::unique_ptr<WindowSizePlugin> plugin(
-      new WindowSizePlugin(std::move(channel), registrar->window()));
+      new WindowSizePlugin(std::move(channel), registrar->window(),
+                           *GetGeometryFilePath()));
 
-  channel_pointer->SetMethodCallHandler(
-      [plugin_pointer = plugin.get()](const auto &call, auto result) {
-        plugin_pointer->HandleMethodCall(call, std::move(result));
+  channel_pointer->SetMethodCallHandler<Method>(
+      kMethods, [plugin_pointer = plugin.get()](Method method,
+                                                StandardCodecReader *arguments,
+                                                MethodReply reply) {
+        plugin_pointer->HandleMethodCall(method, arguments, std::move(reply));
       });
 
   registrar->AddPlugin(std::move(plugin));
 }
 
-WindowSizePlugin::WindowSizePlugin(
-    std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel,
-    flutter::FlutterWindow *window)
-    : channel_(std::move(channel)), window_(window) {}
+// static
+WindowSizePlugin *WindowSizePlugin::geometry_saver_ = nullptr;
 
-WindowSizePlugin::~WindowSizePlugin() {}
+// static
+void WindowSizePlugin::SaveGeometryOfInstance() {
+  if (!geometry_saver_) {
+    return;
+  }
+  if (geometry_saver_->geometry_save_source_) {
+    g_source_remove(geometry_saver_->geometry_save_source_);
+    geometry_saver_->geometry_save_source_ = 0;
+  }
+  geometry_saver_->SaveGeometry();
+}
 
-void WindowSizePlugin::HandleMethodCall(
-    const flutter::MethodCall<EncodableValue> &method_call,
-    std::unique_ptr<flutter::MethodResult<EncodableValue>> result) {
-  if (method_call.method_name().compare(kGetScreenListMethod) == 0) {
-    EncodableValue screens(EncodableValue::Type::kList);
-    GdkScreen *screen = GetScreen();
-    if (!screen) {
-      result->Error("Unable to get screen");
+WindowSizePlugin::WindowSizePlugin(std::unique_ptr<TypedMethodChannel> channel,
+                                   flutter::FlutterWindow *window,
+                                   std::string geometry_path)
+    : channel_(std::move(channel)),
+      window_(window),
+      monitors_([this] {
+        channel_->InvokeMethod(kScreensChangedMethod, monitors_.screens());
+        // The window's screen index or scale factor may have changed.
+        ScheduleWindowUpdate();
+      }),
+      geometry_path_(std::move(geometry_path)) {
+  if (geometry_path_.empty()) {
+    return;
+  }
+  WindowGeometry restored;
+  if (plugins_common::ReadWindowGeometry(geometry_path_, &restored)) {
+    geometry_restored_ = true;
+    EnsureRestoredFrameIsVisible(restored);
+  }
+  // Compare against the file, so that an unchanged window isn't rewritten.
+  saved_geometry_ = restored;
+  if (!ObserveWindow()) {
+    std::cerr << "Unable to observe the window; its geometry won't be saved."
+              << std::endl;
+    return;
+  }
+  geometry_saver_ = this;
+}
+
+WindowSizePlugin::~WindowSizePlugin() {
+  SetWindowUpdatesEnabled(false);
+  if (geometry_saver_ == this) {
+    SaveGeometryOfInstance();
+    geometry_saver_ = nullptr;
+  }
+  if (pending_frame_source_) {
+    g_source_remove(pending_frame_source_);
+  }
+  if (animation_source_) {
+    g_source_remove(animation_source_);
+  }
+}
+
+void WindowSizePlugin::SetFrameSoon(const flutter::WindowFrame &frame,
+                                    std::unique_ptr<MethodReply> reply) {
+  StopAnimation();
+  pending_frame_ = ConstrainFrame(frame, size_constraints_);
+  if (reply) {
+    pending_frame_replies_.push_back(std::move(reply));
+  }
+  if (!pending_frame_source_) {
+    pending_frame_source_ = g_idle_add(SetPendingFrame, this);
+  }
+}
+
+// static
+gboolean WindowSizePlugin::SetPendingFrame(gpointer user_data) {
+  auto *plugin = static_cast<WindowSizePlugin *>(user_data);
+  plugin->pending_frame_source_ = 0;
+  plugin->window_->SetFrame(plugin->pending_frame_);
+  plugin->CompletePendingFrameReplies();
+  return G_SOURCE_REMOVE;
+}
+
+void WindowSizePlugin::CompletePendingFrameReplies() {
+  std::vector<std::unique_ptr<MethodReply>> replies;
+  replies.swap(pending_frame_replies_);
+  for (auto &reply : replies) {
+    reply->Success();
+  }
+}
+
+void WindowSizePlugin::StartAnimation(const WindowFrameAnimation &animation,
+                                      AnimationCurve curve,
+                                      MethodReply reply) {
+  StopAnimation();
+  // Start from a frame that is still waiting to be set, if any.
+  if (pending_frame_source_) {
+    g_source_remove(pending_frame_source_);
+    pending_frame_source_ = 0;
+    animation_start_frame_ = pending_frame_;
+  } else {
+    animation_start_frame_ = window_->GetFrame();
+  }
+  animation_target_frame_ =
+      ConstrainFrame(GetWindowFrameForRect(animation.target),
+                     size_constraints_);
+  animation_start_time_ = g_get_monotonic_time();
+  animation_duration_ = std::max<int64_t>(animation.duration_ms, 0) * 1000;
+  animation_curve_ = curve;
+  animation_reply_ = std::make_unique<MethodReply>(std::move(reply));
+  // The first step applies the start frame, or the target if the duration is
+  // zero, which completes any SetWindowFrame calls the start frame came from.
+  bool running = StepAnimation(this) == G_SOURCE_CONTINUE;
+  CompletePendingFrameReplies();
+  if (running) {
+    animation_source_ = g_timeout_add(
+        GetRefreshIntervalMs(animation_start_frame_), StepAnimation, this);
+  }
+}
+
+void WindowSizePlugin::StopAnimation() {
+  if (!animation_source_) {
+    return;
+  }
+  g_source_remove(animation_source_);
+  animation_source_ = 0;
+  animation_reply_->Success();
+  animation_reply_.reset();
+}
+
+// static
+gboolean WindowSizePlugin::StepAnimation(gpointer user_data) {
+  auto *plugin = static_cast<WindowSizePlugin *>(user_data);
+  gint64 elapsed = g_get_monotonic_time() - plugin->animation_start_time_;
+  double t = elapsed >= plugin->animation_duration_
+                 ? 1
+                 : static_cast<double>(elapsed) / plugin->animation_duration_;
+  double progress = ApplyAnimationCurve(plugin->animation_curve_, t);
+  const flutter::WindowFrame &start = plugin->animation_start_frame_;
+  const flutter::WindowFrame &target = plugin->animation_target_frame_;
+  flutter::WindowFrame frame = {};
+  frame.left = Interpolate(start.left, target.left, progress);
+  frame.top = Interpolate(start.top, target.top, progress);
+  frame.width = Interpolate(start.width, target.width, progress);
+  frame.height = Interpolate(start.height, target.height, progress);
+  plugin->window_->SetFrame(frame);
+  if (t < 1) {
+    return G_SOURCE_CONTINUE;
+  }
+  plugin->animation_source_ = 0;
+  plugin->animation_reply_->Success();
+  plugin->animation_reply_.reset();
+  return G_SOURCE_REMOVE;
+}
+
+void WindowSizePlugin::EnsureRestoredFrameIsVisible(
+    const WindowGeometry &restored) {
+  if (restored.monitor_width == 0) {
+    return;
+  }
+  GdkRectangle saved_monitor = {};
+  saved_monitor.x = restored.monitor_left;
+  saved_monitor.y = restored.monitor_top;
+  saved_monitor.width = restored.monitor_width;
+  saved_monitor.height = restored.monitor_height;
+  int monitor_count = static_cast<int>(monitors_.screens().size());
+  for (int i = 0; i < monitor_count; ++i) {
+    const GdkRectangle &monitor = monitors_.monitor_frame(i);
+    if (monitor.x == saved_monitor.x && monitor.y == saved_monitor.y &&
+        monitor.width == saved_monitor.width &&
+        monitor.height == saved_monitor.height) {
       return;
     }
-    int monitor_count = gdk_screen_get_n_monitors(screen);
-    for (int i = 0; i < monitor_count; ++i) {
-      screens.ListValue().push_back(
-          GetPlatformChannelRepresentationForMonitor(screen, i));
+  }
+  // Center the window in the usable area of the monitor it now overlaps
+  // most, shrinking it if necessary.
+  int monitor_index = monitors_.MonitorIndexForFrame(GetWindowFrame(window_));
+  if (monitor_index == -1) {
+    return;
+  }
+  const FrameRect &area = monitors_.screens()[monitor_index].visible_frame;
+  flutter::WindowFrame frame = window_->GetFrame();
+  frame.width = std::min(frame.width, static_cast<int>(area.width));
+  frame.height = std::min(frame.height, static_cast<int>(area.height));
+  frame.left = static_cast<int>(area.left + (area.width - frame.width) / 2);
+  frame.top = static_cast<int>(area.top + (area.height - frame.height) / 2);
+  window_->SetFrame(frame);
+}
+
+bool WindowSizePlugin::ObserveWindow() {
+  if (observing_window_) {
+    return true;
+  }
+  if (!x11_window_.Find(window_->GetFrame())) {
+    return false;
+  }
+  x11_window_.SetConfigureHandler([this] { HandleWindowConfigured(); });
+  observing_window_ = true;
+  return true;
+}
+
+void WindowSizePlugin::HandleWindowConfigured() {
+  ScheduleWindowUpdate();
+  if (geometry_saver_ != this) {
+    return;
+  }
+  unsaved_geometry_ = GetWindowGeometry(window_, &monitors_);
+  has_unsaved_geometry_ = true;
+  if (geometry_save_source_) {
+    g_source_remove(geometry_save_source_);
+  }
+  geometry_save_source_ =
+      g_timeout_add(kGeometrySaveDelayMs, SaveGeometryAfterDelay, this);
+}
+
+// static
+gboolean WindowSizePlugin::SaveGeometryAfterDelay(gpointer user_data) {
+  auto *plugin = static_cast<WindowSizePlugin *>(user_data);
+  plugin->geometry_save_source_ = 0;
+  plugin->SaveGeometry();
+  return G_SOURCE_REMOVE;
+}
+
+void WindowSizePlugin::SaveGeometry() {
+  if (!has_unsaved_geometry_) {
+    return;
+  }
+  has_unsaved_geometry_ = false;
+  if (unsaved_geometry_ == saved_geometry_) {
+    return;
+  }
+  if (!plugins_common::WriteWindowGeometry(geometry_path_, unsaved_geometry_)) {
+    std::cerr << "Unable to save window geometry to " << geometry_path_
+              << std::endl;
+  }
+  // Don't retry a failed write until the geometry changes again.
+  saved_geometry_ = unsaved_geometry_;
+}
+
+void WindowSizePlugin::SetWindowUpdatesEnabled(bool enabled) {
+  if (enabled == window_updates_enabled_) {
+    return;
+  }
+  window_updates_enabled_ = enabled;
+  if (window_update_source_) {
+    g_source_remove(window_update_source_);
+    window_update_source_ = 0;
+  }
+  if (!enabled) {
+    return;
+  }
+  // Start with the current state.
+  has_sent_window_state_ = false;
+  SendWindowUpdate();
+  if (!ObserveWindow()) {
+    window_update_source_ =
+        g_timeout_add(GetRefreshIntervalMs(window_->GetFrame()),
+                      CheckForWindowUpdate, this);
+  }
+}
+
+void WindowSizePlugin::ScheduleWindowUpdate() {
+  if (!window_updates_enabled_ || window_update_source_) {
+    return;
+  }
+  window_update_source_ =
+      g_timeout_add(GetRefreshIntervalMs(window_->GetFrame()),
+                    SendScheduledWindowUpdate, this);
+}
+
+// static
+gboolean WindowSizePlugin::SendScheduledWindowUpdate(gpointer user_data) {
+  auto *plugin = static_cast<WindowSizePlugin *>(user_data);
+  plugin->window_update_source_ = 0;
+  plugin->SendWindowUpdate();
+  return G_SOURCE_REMOVE;
+}
+
+// static
+gboolean WindowSizePlugin::CheckForWindowUpdate(gpointer user_data) {
+  static_cast<WindowSizePlugin *>(user_data)->SendWindowUpdate();
+  return G_SOURCE_CONTINUE;
+}
+
+void WindowSizePlugin::SendWindowUpdate() {
+  WindowState state = GetWindowState(window_, &monitors_);
+  if (!has_sent_window_state_ || !(state == last_window_state_)) {
+    channel_->InvokeMethod(kWindowUpdatedMethod, state);
+    last_window_state_ = state;
+    has_sent_window_state_ = true;
+  }
+}
+
+void WindowSizePlugin::SetSizeConstraints(
+    const SizeConstraints &constraints) {
+  size_constraints_ = constraints;
+  if (x11_window_.Find(window_->GetFrame())) {
+    x11_window_.SetSizeHints(size_constraints_);
+  } else {
+    std::cerr << "Unable to pass window size constraints to the window "
+                 "manager; only frames set by Dart will satisfy them."
+              << std::endl;
+  }
+  if (animation_source_) {
+    animation_target_frame_ =
+        ConstrainFrame(animation_target_frame_, size_constraints_);
+    return;
+  }
+  flutter::WindowFrame frame =
+      pending_frame_source_ ? pending_frame_ : window_->GetFrame();
+  flutter::WindowFrame constrained = ConstrainFrame(frame, size_constraints_);
+  if (constrained.width != frame.width || constrained.height != frame.height) {
+    SetFrameSoon(constrained);
+  }
+}
+
+void WindowSizePlugin::HandleMethodCall(Method method,
+                                        StandardCodecReader *arguments,
+                                        MethodReply reply) {
+  switch (method) {
+    case Method::kGetScreenList: {
+      if (!GetScreen()) {
+        reply.Error("Unable to get screen");
+        return;
+      }
+      reply.Success(monitors_.screens());
+      break;
     }
-    result->Success(&screens);
-  } else if (method_call.method_name().compare(kGetWindowInfoMethod) == 0) {
-    EncodableValue window_info =
-        GetPlatformChannelRepresentationForWindow(window_);
-    result->Success(&window_info);
-  } else if (method_call.method_name().compare(kSetWindowFrameMethod) == 0) {
-    if (!method_call.arguments() || !method_call.arguments()->IsList() ||
-        method_call.arguments()->ListValue().size() != 4) {
-      result->Error("Bad arguments", "Expected 4-element list");
-      return;
+    case Method::kGetWindowInfo: {
+      reply.Success(GetWindowInfo(window_, &monitors_));
+      break;
+    }
+    case Method::kSetWindowMinSize:
+    case Method::kSetWindowMaxSize: {
+      WindowSize size;
+      if (!Decode(arguments, &size)) {
+        reply.Error("Bad arguments", "Expected 2-element list");
+        return;
+      }
+      int width;
+      int height;
+      if (!GetSizeLimit(size.width, &width) ||
+          !GetSizeLimit(size.height, &height)) {
+        reply.Error("Bad arguments",
+                    "Size limits must be infinite or from 0 to " +
+                        std::to_string(kMaxWindowSize));
+        return;
+      }
+      SizeConstraints constraints = size_constraints_;
+      if (method == Method::kSetWindowMinSize) {
+        constraints.min_width = width;
+        constraints.min_height = height;
+      } else {
+        constraints.max_width = width;
+        constraints.max_height = height;
+      }
+      if (!MinSizeFitsMaxSize(constraints)) {
+        reply.Error("Bad arguments",
+                    "The minimum size cannot exceed the maximum size");
+        return;
+      }
+      SetSizeConstraints(constraints);
+      reply.Success();
+      break;
+    }
+    case Method::kSetAspectRatio: {
+      double aspect_ratio;
+      if (!Decode(arguments, &aspect_ratio)) {
+        reply.Error("Bad arguments", "Expected double");
+        return;
+      }
+      // Also rejects NaN and infinity.
+      if (aspect_ratio != 0 && !(aspect_ratio >= kMinAspectRatio &&
+                                 aspect_ratio <= kMaxAspectRatio)) {
+        reply.Error("Bad arguments",
+                    "Aspect ratio must be 0 or from 1/" +
+                        std::to_string(kMaxWindowSize) + " to " +
+                        std::to_string(kMaxWindowSize));
+        return;
+      }
+      SizeConstraints constraints = size_constraints_;
+      constraints.aspect_ratio = aspect_ratio;
+      SetSizeConstraints(constraints);
+      reply.Success();
+      break;
+    }
+    case Method::kIsWindowGeometryRestored: {
+      reply.Success(geometry_restored_);
+      break;
+    }
+    case Method::kSetWindowUpdatesEnabled: {
+      bool enabled;
+      if (!Decode(arguments, &enabled)) {
+        reply.Error("Bad arguments", "Expected bool");
+        return;
+      }
+      SetWindowUpdatesEnabled(enabled);
+      reply.Success();
+      break;
+    }
+    case Method::kSetWindowFrame: {
+      FrameRect rect;
+      if (!Decode(arguments, &rect)) {
+        reply.Error("Bad arguments", "Expected 4-element list");
+        return;
+      }
+      SetFrameSoon(GetWindowFrameForRect(rect),
+                   std::make_unique<MethodReply>(std::move(reply)));
+      break;
+    }
+    case Method::kAnimateWindowFrame: {
+      WindowFrameAnimation animation;
+      if (!Decode(arguments, &animation)) {
+        reply.Error("Bad arguments", "Expected WindowFrameAnimation map");
+        return;
+      }
+      AnimationCurve curve = AnimationCurve::kEaseInOut;
+      if (animation.has_curve &&
+          !ParseAnimationCurve(animation.curve, &curve)) {
+        reply.Error("Bad arguments", "Unknown curve");
+        return;
+      }
+      StartAnimation(animation, curve, std::move(reply));
+      break;
     }
-    // Frame validity (e.g., non-zero size) is assumed to be checked on the Dart
-    // side of the call.
-    const auto &frame_list = method_call.arguments()->ListValue();
-    flutter::WindowFrame frame = {};
-    frame.left = static_cast<int>(frame_list[0].DoubleValue());
-    frame.top = static_cast<int>(frame_list[1].DoubleValue());
-    frame.width = static_cast<int>(frame_list[2].DoubleValue());
-    frame.height = static_cast<int>(frame_list[3].DoubleValue());
-    window_->SetFrame(frame);
-    result->Success();
-  } else {
-    result->NotImplemented();
   }
 }
 
@@ -245,3 +1074,11 @@ void WindowSizeRegisterWithRegistrar(
   plugins_window_size::WindowSizePlugin::RegisterWithRegistrar(
       plugin_registrar);
 }
+
+void WindowSizeSetGeometryFile(const char *path) {
+  *plugins_window_size::GetGeometryFilePath() = path ? path : "";
+}
+
+void WindowSizeSaveGeometry() {
+  plugins_window_size::WindowSizePlugin::SaveGeometryOfInstance();
+}
@@ -31,6 +31,18 @@ extern "C" {
 FLUTTER_PLUGIN_EXPORT void WindowSizeRegisterWithRegistrar(
     FlutterDesktopPluginRegistrarRef registrar);
 
+// Enables saving the window's geometry to |path| as it changes, for the
+// runner to restore before creating the window at the next launch; see
+// plugins/common/linux/window_geometry_file.h. The directory containing
+// |path| must exist. Must be called before WindowSizeRegisterWithRegistrar.
+FLUTTER_PLUGIN_EXPORT void WindowSizeSetGeometryFile(const char *path);
+
+// Saves any change to the window's geometry that is still waiting to be
+// saved. Changes are saved shortly after the window stops moving, which may
+// be after the window has been closed, so this should be called once the
+// event loop has ended.
+FLUTTER_PLUGIN_EXPORT void WindowSizeSaveGeometry();
+
 #if defined(__cplusplus)
 }  // extern "C"
 #endif
@@ -0,0 +1,102 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/app_directories.h"
+
+#include <errno.h>
+#include <ftw.h>
+#include <pwd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+namespace runner {
+
+namespace {
+
+// Returns the user's home directory, or an empty string if it can't be found.
+std::string GetHomeDirectory() {
+  const char *home = getenv("HOME");
+  if (home && home[0] != '\0') {
+    return home;
+  }
+  struct passwd *user_info = getpwuid(getuid());
+  if (user_info && user_info->pw_dir) {
+    return user_info->pw_dir;
+  }
+  return "";
+}
+
+// Returns <base>/<application_id>, creating it if necessary, where <base> is
+// the value of the environment variable |variable| or, if that isn't set,
+// |home_default| under the home directory. Returns an empty string on failure.
+std::string GetXdgDirectory(const char *variable, const char *home_default,
+                            const std::string &application_id) {
+  std::string base;
+  const char *xdg_home = getenv(variable);
+  // Per the XDG specification, relative paths are invalid and ignored.
+  if (xdg_home && xdg_home[0] == '/') {
+    base = xdg_home;
+  } else {
+    std::string home = GetHomeDirectory();
+    if (home.empty()) {
+      return "";
+    }
+    base = home + "/" + home_default;
+  }
+  std::string directory = base + "/" + application_id;
+  if (!CreateDirectories(directory)) {
+    std::cerr << "Unable to create directory " << directory << std::endl;
+    return "";
+  }
+  return directory;
+}
+
+// nftw callback that removes each visited file or directory.
+int RemoveEntry(const char *path, const struct stat *info, int type,
+                struct FTW *ftw_info) {
+  return remove(path);
+}
+
+}  // namespace
+
+std::string GetCacheDirectory(const std::string &application_id) {
+  return GetXdgDirectory("XDG_CACHE_HOME", ".cache", application_id);
+}
+
+std::string GetConfigDirectory(const std::string &application_id) {
+  return GetXdgDirectory("XDG_CONFIG_HOME", ".config", application_id);
+}
+
+bool CreateDirectories(const std::string &path) {
+  size_t position = 0;
+  do {
+    position = path.find('/', position + 1);
+    std::string prefix = path.substr(0, position);
+    if (mkdir(prefix.c_str(), 0700) != 0 && errno != EEXIST) {
+      return false;
+    }
+  } while (position != std::string::npos);
+  return true;
+}
+
+bool RemoveRecursively(const std::string &path) {
+  // FTW_DEPTH visits directories after their contents, so they are empty
+  // when removed.
+  return nftw(path.c_str(), RemoveEntry, 16, FTW_DEPTH | FTW_PHYS) == 0;
+}
+
+}  // namespace runner
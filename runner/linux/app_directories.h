@@ -0,0 +1,44 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_APP_DIRECTORIES_H_
+#define RUNNER_LINUX_APP_DIRECTORIES_H_
+
+#include <string>
+
+namespace runner {
+
+// Returns the per-application cache directory, following the XDG Base
+// Directory specification ($XDG_CACHE_HOME/<application_id>, defaulting to
+// ~/.cache/<application_id>), creating it if necessary.
+//
+// Returns an empty string if the directory can't be determined or created.
+std::string GetCacheDirectory(const std::string &application_id);
+
+// Returns the per-application configuration directory, following the XDG
+// Base Directory specification ($XDG_CONFIG_HOME/<application_id>, defaulting
+// to ~/.config/<application_id>), creating it if necessary.
+//
+// Returns an empty string if the directory can't be determined or created.
+std::string GetConfigDirectory(const std::string &application_id);
+
+// Creates |path| and any missing parent directories. Returns false on failure.
+bool CreateDirectories(const std::string &path);
+
+// Removes |path| and, if it is a directory, everything under it. Returns false
+// on failure.
+bool RemoveRecursively(const std::string &path);
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_APP_DIRECTORIES_H_
@@ -0,0 +1,329 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// The open() interposers below can't be defined alongside the fortified
+// inline versions from fcntl.h.
+#undef _FORTIFY_SOURCE
+
+#include "runner/linux/file_prefetcher.h"
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+namespace runner {
+
+namespace {
+
+// Files that the engine is known to read during startup. Fonts are found by
+// scanning the assets directory.
+const char *kDefaultFiles[] = {
+    "data/icudtl.dat",
+    "data/flutter_assets/kernel_blob.bin",
+    "data/flutter_assets/vm_snapshot_data",
+    "data/flutter_assets/isolate_snapshot_data",
+    "data/flutter_assets/AssetManifest.json",
+    "data/flutter_assets/FontManifest.json",
+};
+const char kAssetsDirectory[] = "data/flutter_assets";
+
+// The state for recording which bundle files are opened during a run.
+//
+// This is accessed from the open() interposers, which can be called on any
+// thread, so is guarded by |mutex|, with |enabled| allowing the common case
+// of not recording to skip the lock.
+struct OpenRecorder {
+  std::atomic<bool> enabled{false};
+  std::mutex mutex;
+  // The absolute bundle directory, with a trailing '/'.
+  std::string prefix;
+  // Bundle-relative paths, in the order they were first opened.
+  std::vector<std::string> files;
+  std::set<std::string> seen_files;
+};
+
+OpenRecorder &GetOpenRecorder() {
+  static auto *recorder = new OpenRecorder();
+  return *recorder;
+}
+
+// Set on the prefetch thread, so that its own reads are not recorded.
+thread_local bool t_is_prefetching = false;
+
+// Returns true if |name| has a font file extension.
+bool IsFontFile(const std::string &name) {
+  for (const char *extension : {".ttf", ".otf", ".ttc"}) {
+    size_t length = strlen(extension);
+    if (name.size() > length &&
+        name.compare(name.size() - length, length, extension) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Appends the paths of all font files under |directory|, relative to
+// |base_directory|, to |files|.
+void FindFontFiles(const std::string &base_directory,
+                   const std::string &directory,
+                   std::vector<std::string> *files) {
+  DIR *dir = opendir((base_directory + "/" + directory).c_str());
+  if (!dir) {
+    return;
+  }
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::string path = directory + "/" + name;
+    if (entry->d_type == DT_DIR) {
+      FindFontFiles(base_directory, path, files);
+    } else if (IsFontFile(name)) {
+      files->push_back(path);
+    }
+  }
+  closedir(dir);
+}
+
+// Returns the absolute path of the file opened as |path| relative to
+// |directory_fd|, without touching the file system beyond the directory.
+std::string GetAbsolutePath(int directory_fd, const char *path) {
+  if (path[0] == '/') {
+    return path;
+  }
+  char link_path[64];
+  if (directory_fd == AT_FDCWD) {
+    snprintf(link_path, sizeof(link_path), "/proc/self/cwd");
+  } else {
+    snprintf(link_path, sizeof(link_path), "/proc/self/fd/%d", directory_fd);
+  }
+  char directory[PATH_MAX];
+  ssize_t length = readlink(link_path, directory, sizeof(directory));
+  if (length <= 0 || length >= static_cast<ssize_t>(sizeof(directory))) {
+    return "";
+  }
+  return std::string(directory, length) + "/" + path;
+}
+
+// Records a successful open of |path|, if it is in the bundle.
+void RecordOpen(int directory_fd, const char *path) {
+  OpenRecorder &recorder = GetOpenRecorder();
+  if (!recorder.enabled.load(std::memory_order_relaxed) || !path ||
+      t_is_prefetching) {
+    return;
+  }
+  std::string absolute_path = GetAbsolutePath(directory_fd, path);
+  std::lock_guard<std::mutex> lock(recorder.mutex);
+  if (absolute_path.compare(0, recorder.prefix.size(), recorder.prefix) != 0) {
+    return;
+  }
+  std::string relative_path = absolute_path.substr(recorder.prefix.size());
+  if (recorder.seen_files.insert(relative_path).second) {
+    recorder.files.push_back(relative_path);
+  }
+}
+
+// Declares |mode|, reading it from the variable arguments of an open() call
+// if |flags| require one.
+#define READ_OPEN_MODE(flags, last_argument)                 \
+  mode_t mode = 0;                                           \
+  if (((flags)&O_CREAT) || ((flags)&O_TMPFILE) == O_TMPFILE) { \
+    va_list arguments;                                       \
+    va_start(arguments, last_argument);                      \
+    mode = va_arg(arguments, mode_t);                        \
+    va_end(arguments);                                       \
+  }
+
+}  // namespace
+
+FilePrefetcher::FilePrefetcher(const std::string &bundle_directory,
+                               const std::string &manifest_path)
+    : manifest_path_(manifest_path), prefetch_start_(0), prefetch_end_(0) {
+  char resolved_path[PATH_MAX];
+  bundle_directory_ = realpath(bundle_directory.c_str(), resolved_path)
+                          ? resolved_path
+                          : bundle_directory;
+}
+
+FilePrefetcher::~FilePrefetcher() {
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  GetOpenRecorder().enabled = false;
+}
+
+void FilePrefetcher::Start() {
+  std::vector<std::string> files = GetFilesToPrefetch();
+  if (!manifest_path_.empty()) {
+    OpenRecorder &recorder = GetOpenRecorder();
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    recorder.prefix = bundle_directory_ + "/";
+    recorder.files.clear();
+    recorder.seen_files.clear();
+    recorder.enabled = true;
+  }
+  thread_ = std::thread([this, files] { Prefetch(files); });
+}
+
+void FilePrefetcher::Finish(StartupTracer *tracer) {
+  if (finished_) {
+    return;
+  }
+  finished_ = true;
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  if (tracer) {
+    tracer->AddPhase("Prefetch", prefetch_start_, prefetch_end_);
+  }
+  if (manifest_path_.empty()) {
+    return;
+  }
+  OpenRecorder &recorder = GetOpenRecorder();
+  std::vector<std::string> files;
+  {
+    std::lock_guard<std::mutex> lock(recorder.mutex);
+    recorder.enabled = false;
+    files.swap(recorder.files);
+  }
+  if (files.empty()) {
+    return;
+  }
+  // Write to a temporary file and rename, so that a concurrently starting
+  // instance never sees a partial manifest.
+  std::string temporary_path = manifest_path_ + ".tmp";
+  {
+    std::ofstream manifest(temporary_path, std::ios::trunc);
+    for (const std::string &file : files) {
+      manifest << file << "\n";
+    }
+    if (!manifest) {
+      std::cerr << "Unable to write prefetch manifest " << temporary_path
+                << std::endl;
+      return;
+    }
+  }
+  rename(temporary_path.c_str(), manifest_path_.c_str());
+}
+
+std::vector<std::string> FilePrefetcher::GetFilesToPrefetch() {
+  std::vector<std::string> files;
+  if (!manifest_path_.empty()) {
+    std::ifstream manifest(manifest_path_);
+    std::string file;
+    while (std::getline(manifest, file)) {
+      if (!file.empty()) {
+        files.push_back(file);
+      }
+    }
+  }
+  if (files.empty()) {
+    files.assign(std::begin(kDefaultFiles), std::end(kDefaultFiles));
+    FindFontFiles(bundle_directory_, kAssetsDirectory, &files);
+  }
+  return files;
+}
+
+void FilePrefetcher::Prefetch(const std::vector<std::string> &files) {
+  t_is_prefetching = true;
+  prefetch_start_ = StartupTracer::Now();
+  for (const std::string &file : files) {
+    std::string path = bundle_directory_ + "/" + file;
+    // Files listed in an older manifest may no longer exist; skip them.
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    struct stat file_info = {};
+    if (fstat(fd, &file_info) == 0 && file_info.st_size > 0) {
+      // readahead isn't supported by all file systems; fall back to the
+      // advisory interface, which the kernel may service asynchronously.
+      if (readahead(fd, 0, file_info.st_size) != 0) {
+        posix_fadvise(fd, 0, file_info.st_size, POSIX_FADV_WILLNEED);
+      }
+    }
+    close(fd);
+  }
+  prefetch_end_ = StartupTracer::Now();
+}
+
+}  // namespace runner
+
+// Interposers for the open() family, used to record which bundle files are
+// read. These take precedence over libc's definitions for the Flutter library
+// and plugins because they are exported from the executable.
+extern "C" {
+
+int open(const char *path, int flags, ...) {
+  READ_OPEN_MODE(flags, flags);
+  using OpenFunction = int (*)(const char *, int, ...);
+  static auto real_open =
+      reinterpret_cast<OpenFunction>(dlsym(RTLD_NEXT, "open"));
+  int fd = real_open(path, flags, mode);
+  if (fd >= 0) {
+    runner::RecordOpen(AT_FDCWD, path);
+  }
+  return fd;
+}
+
+int open64(const char *path, int flags, ...) {
+  READ_OPEN_MODE(flags, flags);
+  using OpenFunction = int (*)(const char *, int, ...);
+  static auto real_open64 =
+      reinterpret_cast<OpenFunction>(dlsym(RTLD_NEXT, "open64"));
+  int fd = real_open64(path, flags, mode);
+  if (fd >= 0) {
+    runner::RecordOpen(AT_FDCWD, path);
+  }
+  return fd;
+}
+
+int openat(int directory_fd, const char *path, int flags, ...) {
+  READ_OPEN_MODE(flags, flags);
+  using OpenAtFunction = int (*)(int, const char *, int, ...);
+  static auto real_openat =
+      reinterpret_cast<OpenAtFunction>(dlsym(RTLD_NEXT, "openat"));
+  int fd = real_openat(directory_fd, path, flags, mode);
+  if (fd >= 0) {
+    runner::RecordOpen(directory_fd, path);
+  }
+  return fd;
+}
+
+int openat64(int directory_fd, const char *path, int flags, ...) {
+  READ_OPEN_MODE(flags, flags);
+  using OpenAtFunction = int (*)(int, const char *, int, ...);
+  static auto real_openat64 =
+      reinterpret_cast<OpenAtFunction>(dlsym(RTLD_NEXT, "openat64"));
+  int fd = real_openat64(directory_fd, path, flags, mode);
+  if (fd >= 0) {
+    runner::RecordOpen(directory_fd, path);
+  }
+  return fd;
+}
+
+}  // extern "C"
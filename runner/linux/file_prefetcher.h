@@ -0,0 +1,77 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_FILE_PREFETCHER_H_
+#define RUNNER_LINUX_FILE_PREFETCHER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "runner/linux/startup_tracer.h"
+
+namespace runner {
+
+// Warms the page cache for the bundle files that the engine reads during
+// startup (ICU data, snapshots, fonts), on a background thread, so that the
+// reads in CreateWindow don't wait on the disk.
+//
+// The set of files comes from a manifest of the bundle files that were opened
+// during the previous run, in the order they were first opened. Without a
+// manifest, a default set of files known to be read at startup is used.
+//
+// Recording the files opened during a run relies on the runner interposing
+// open() and openat() (see file_prefetcher.cc), so runners using the
+// prefetcher must link with -rdynamic.
+class FilePrefetcher {
+ public:
+  // Creates a prefetcher for the bundle rooted at |bundle_directory|, using
+  // |manifest_path| to store the list of files used by each run. If
+  // |manifest_path| is empty, the default file set is always used.
+  FilePrefetcher(const std::string &bundle_directory,
+                 const std::string &manifest_path);
+  ~FilePrefetcher();
+
+  // Prevent copying.
+  FilePrefetcher(FilePrefetcher const &) = delete;
+  FilePrefetcher &operator=(FilePrefetcher const &) = delete;
+
+  // Starts reading ahead on a background thread, and starts recording the
+  // bundle files opened by the process.
+  void Start();
+
+  // Stops recording and writes the files opened during this run to the
+  // manifest, for use by the next run. If |tracer| is non-null, the prefetch
+  // is added to it as a phase.
+  void Finish(StartupTracer *tracer);
+
+ private:
+  // Returns the bundle-relative paths of the files to prefetch.
+  std::vector<std::string> GetFilesToPrefetch();
+
+  // Issues readahead for each of |files|. Runs on |thread_|.
+  void Prefetch(const std::vector<std::string> &files);
+
+  std::string bundle_directory_;
+  std::string manifest_path_;
+  std::thread thread_;
+  std::atomic<int64_t> prefetch_start_;
+  std::atomic<int64_t> prefetch_end_;
+  bool finished_ = false;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_FILE_PREFETCHER_H_
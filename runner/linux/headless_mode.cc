@@ -0,0 +1,158 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/headless_mode.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include <flutter/standard_method_codec.h>
+
+namespace runner {
+
+namespace {
+
+const char kEnableArgument[] = "--headless";
+
+// See headless.dart for documentation.
+const char kChannelName[] = "flutter/headless";
+const char kExitMethod[] = "Exit";
+
+const char kDisplayServer[] = "Xvfb";
+// Large enough for the window to be resized to half of a typical screen, as
+// the testbed does.
+const char kDisplayServerScreen[] = "1920x1080x24";
+// How long to wait for the display server to report that it's ready.
+const int kDisplayServerTimeoutMs = 10000;
+
+// Reads the display number that Xvfb writes to |fd| once it is accepting
+// connections. Returns an empty string on failure.
+std::string ReadDisplayNumber(int fd) {
+  std::string display_number;
+  while (true) {
+    struct pollfd poll_fd = {fd, POLLIN, 0};
+    int ready = poll(&poll_fd, 1, kDisplayServerTimeoutMs);
+    if (ready < 0 && errno == EINTR) {
+      continue;
+    }
+    char c;
+    if (ready <= 0 || read(fd, &c, 1) != 1) {
+      return "";
+    }
+    if (c == '\n') {
+      return display_number;
+    }
+    display_number += c;
+  }
+}
+
+}  // namespace
+
+HeadlessMode::HeadlessMode(int argc, char **argv) : exit_code_(EXIT_FAILURE) {
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], kEnableArgument) == 0) {
+      enabled_ = true;
+    }
+  }
+}
+
+HeadlessMode::~HeadlessMode() {
+  if (display_server_pid_ > 0) {
+    kill(display_server_pid_, SIGTERM);
+    waitpid(display_server_pid_, nullptr, 0);
+  }
+}
+
+bool HeadlessMode::StartDisplay() {
+  if (!enabled_ || display_server_pid_ > 0) {
+    return enabled_;
+  }
+  // Xvfb picks a free display number and writes it to the -displayfd pipe
+  // once it is ready, which avoids both racing other servers for a number and
+  // polling for the socket.
+  int display_pipe[2];
+  if (pipe2(display_pipe, O_CLOEXEC) != 0) {
+    std::cerr << "Unable to start " << kDisplayServer << ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  pid_t pid = fork();
+  if (pid == 0) {
+    // Don't leave the server running if the runner crashes.
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    // The write end must survive exec.
+    int display_fd = dup(display_pipe[1]);
+    std::string display_fd_string = std::to_string(display_fd);
+    execlp(kDisplayServer, kDisplayServer, "-displayfd",
+           display_fd_string.c_str(), "-screen", "0", kDisplayServerScreen,
+           "-nolisten", "tcp", static_cast<char *>(nullptr));
+    std::cerr << "Unable to run " << kDisplayServer << ": " << strerror(errno)
+              << std::endl;
+    _exit(EXIT_FAILURE);
+  }
+  close(display_pipe[1]);
+  if (pid < 0) {
+    close(display_pipe[0]);
+    std::cerr << "Unable to start " << kDisplayServer << ": "
+              << strerror(errno) << std::endl;
+    return false;
+  }
+  display_server_pid_ = pid;
+  std::string display_number = ReadDisplayNumber(display_pipe[0]);
+  close(display_pipe[0]);
+  if (display_number.empty()) {
+    std::cerr << kDisplayServer << " did not start" << std::endl;
+    return false;
+  }
+  setenv("DISPLAY", (":" + display_number).c_str(), 1);
+  // Keep toolkits that prefer Wayland on the virtual display too.
+  unsetenv("WAYLAND_DISPLAY");
+  return true;
+}
+
+void HeadlessMode::RegisterChannel(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  if (!enabled_ || registrar_) {
+    return;
+  }
+  registrar_ = std::make_unique<flutter::PluginRegistrar>(registrar);
+  channel_ =
+      std::make_unique<flutter::MethodChannel<flutter::EncodableValue>>(
+          registrar_->messenger(), kChannelName,
+          &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetMethodCallHandler([this](const auto &call, auto result) {
+    if (call.method_name().compare(kExitMethod) != 0) {
+      result->NotImplemented();
+      return;
+    }
+    if (!call.arguments() || !call.arguments()->IsInt()) {
+      result->Error("Bad arguments", "Expected exit code");
+      return;
+    }
+    exit_code_ = call.arguments()->IntValue();
+    exit_requested_ = true;
+    result->Success();
+  });
+}
+
+}  // namespace runner
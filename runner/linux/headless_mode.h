@@ -0,0 +1,77 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_HEADLESS_MODE_H_
+#define RUNNER_LINUX_HEADLESS_MODE_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar.h>
+#include <flutter_plugin_registrar.h>
+#include <sys/types.h>
+
+#include <memory>
+
+namespace runner {
+
+// Runs the application without a visible window, for scripted benchmarks and
+// tests on machines with no display, and exits with a result code chosen by
+// the Dart code.
+//
+// The mode is enabled by passing --headless to the runner. The GLFW embedding
+// and the plugins that use the window need an X server, so rather than the
+// engine's windowless entry point (which can't host plugins), the runner
+// starts a private Xvfb server and creates its window there. Dart ends the run
+// with exitHeadlessRun (see headless.dart), after which the runner returns the
+// given code.
+class HeadlessMode {
+ public:
+  // Configures headless mode from |argv|.
+  HeadlessMode(int argc, char **argv);
+  // Stops the virtual X server, if started.
+  ~HeadlessMode();
+
+  // Prevent copying.
+  HeadlessMode(HeadlessMode const &) = delete;
+  HeadlessMode &operator=(HeadlessMode const &) = delete;
+
+  bool enabled() const { return enabled_; }
+
+  // Starts a virtual X server and points DISPLAY at it, so that the window is
+  // created there. Returns false if the server could not be started (e.g.,
+  // because Xvfb isn't installed).
+  bool StartDisplay();
+
+  // Registers the channel on which Dart reports the run's result.
+  void RegisterChannel(FlutterDesktopPluginRegistrarRef registrar);
+
+  // Returns true once Dart has ended the run.
+  bool exit_requested() const { return exit_requested_; }
+
+  // The code to exit with: the one reported by Dart, or EXIT_FAILURE if the
+  // run ended without one (e.g., because the window was closed).
+  int exit_code() const { return exit_code_; }
+
+ private:
+  bool enabled_ = false;
+  pid_t display_server_pid_ = -1;
+
+  bool exit_requested_ = false;
+  int exit_code_;
+  std::unique_ptr<flutter::PluginRegistrar> registrar_;
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_HEADLESS_MODE_H_
@@ -0,0 +1,118 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/lazy_plugin_loader.h"
+
+#include <dlfcn.h>
+
+#include <iostream>
+
+#include "runner/linux/messenger_interposer.h"
+
+namespace runner {
+
+// The state for a lazy plugin that may not have been loaded yet.
+struct LazyPluginLoader::PendingPlugin {
+  LazyPluginLoader *loader;
+  LazyPlugin plugin;
+  FlutterDesktopPluginRegistrarRef registrar;
+  // Whether the plugin has been registered.
+  bool loaded;
+};
+
+LazyPluginLoader::LazyPluginLoader(const std::string &library_directory,
+                                   StartupTracer *tracer)
+    : library_directory_(library_directory), tracer_(tracer) {}
+
+// Loaded plugin libraries are intentionally never closed, since the plugins
+// remain registered for the life of the application.
+LazyPluginLoader::~LazyPluginLoader() {}
+
+void LazyPluginLoader::AddPlugin(const LazyPlugin &plugin,
+                                 FlutterDesktopPluginRegistrarRef registrar) {
+  plugins_.push_back(std::make_unique<PendingPlugin>(
+      PendingPlugin{this, plugin, registrar, false}));
+  PendingPlugin *pending = plugins_.back().get();
+  if (plugin.blocks_input) {
+    FlutterDesktopRegistrarEnableInputBlocking(registrar,
+                                               plugin.channel.c_str());
+  }
+  FlutterDesktopMessengerSetCallback(
+      FlutterDesktopRegistrarGetMessenger(registrar), plugin.channel.c_str(),
+      OnFirstMessage, pending);
+}
+
+// static
+void LazyPluginLoader::OnFirstMessage(FlutterDesktopMessengerRef messenger,
+                                      const FlutterDesktopMessage *message,
+                                      void *user_data) {
+  auto *pending = static_cast<PendingPlugin *>(user_data);
+  FlutterDesktopMessageCallback plugin_callback = nullptr;
+  void *plugin_user_data = nullptr;
+  if (!pending->loader->Load(pending) ||
+      !GetInstalledMessageCallback(pending->plugin.channel, &plugin_callback,
+                                   &plugin_user_data) ||
+      plugin_callback == OnFirstMessage) {
+    std::cerr << "Plugin " << pending->plugin.name
+              << " did not register a handler for " << pending->plugin.channel
+              << std::endl;
+    // An empty response is treated as an unimplemented method.
+    FlutterDesktopMessengerSendResponse(messenger, message->response_handle,
+                                        nullptr, 0);
+    return;
+  }
+  // Replay the message to the plugin's own handler. The response handle has
+  // not been used, so the plugin can respond as usual.
+  plugin_callback(messenger, message, plugin_user_data);
+}
+
+bool LazyPluginLoader::Load(PendingPlugin *pending) {
+  if (pending->loaded) {
+    return true;
+  }
+  int64_t start = StartupTracer::Now();
+  if (pending->plugin.linked_register_function) {
+    pending->loaded = true;
+    pending->plugin.linked_register_function(pending->registrar);
+    if (tracer_) {
+      tracer_->AddPhase("RegisterPlugin " + pending->plugin.name, start,
+                        StartupTracer::Now());
+    }
+    return true;
+  }
+  std::string path = library_directory_ + "/" + pending->plugin.library;
+  void *handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (!handle) {
+    std::cerr << "Unable to load plugin library " << path << ": " << dlerror()
+              << std::endl;
+    return false;
+  }
+  using RegisterFunction = void (*)(FlutterDesktopPluginRegistrarRef);
+  auto register_function = reinterpret_cast<RegisterFunction>(
+      dlsym(handle, pending->plugin.register_function.c_str()));
+  if (!register_function) {
+    std::cerr << "Unable to find " << pending->plugin.register_function
+              << " in " << path << std::endl;
+    dlclose(handle);
+    return false;
+  }
+  pending->loaded = true;
+  register_function(pending->registrar);
+  if (tracer_) {
+    tracer_->AddPhase("LoadPlugin " + pending->plugin.name, start,
+                      StartupTracer::Now());
+  }
+  return true;
+}
+
+}  // namespace runner
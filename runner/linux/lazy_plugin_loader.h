@@ -0,0 +1,94 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_LAZY_PLUGIN_LOADER_H_
+#define RUNNER_LINUX_LAZY_PLUGIN_LOADER_H_
+
+#include <flutter_plugin_registrar.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "runner/linux/startup_tracer.h"
+
+namespace runner {
+
+// Describes a plugin that is registered on first use rather than at startup.
+struct LazyPlugin {
+  // The name to use when requesting the plugin's registrar.
+  std::string name;
+  // The channel the plugin handles. The plugin is loaded when the first
+  // message arrives on this channel.
+  std::string channel;
+  // The file name of the plugin's shared library.
+  std::string library;
+  // The name of the plugin's C registration function, e.g.,
+  // "ColorPanelRegisterWithRegistrar".
+  std::string register_function;
+  // Whether the plugin enables input blocking for its channel. Since the
+  // first message is delivered before the plugin has registered, this is
+  // applied up front by the loader.
+  bool blocks_input;
+  // The plugin's registration function, if the plugin is linked into the
+  // executable. If set, it is called directly instead of loading |library|.
+  void (*linked_register_function)(FlutterDesktopPluginRegistrarRef) = nullptr;
+};
+
+// Defers loading and registering plugins until their channel is first used.
+//
+// Each lazy plugin's channel gets a placeholder handler. When a message
+// arrives on it, the plugin library is opened with dlopen (unless the plugin
+// is linked into the executable), the plugin is registered, and the pending
+// message is replayed to the handler the plugin installed, so the first call
+// behaves exactly as if the plugin had been registered at startup.
+//
+// The replay relies on the runner's definition of
+// FlutterDesktopMessengerSetCallback (see messenger_interposer.cc), which
+// requires the runner to be linked with -rdynamic.
+class LazyPluginLoader {
+ public:
+  // Creates a loader that loads plugin libraries from |library_directory|.
+  // If |tracer| is non-null, plugin loads are recorded as trace phases.
+  LazyPluginLoader(const std::string &library_directory,
+                   StartupTracer *tracer);
+  ~LazyPluginLoader();
+
+  // Prevent copying.
+  LazyPluginLoader(LazyPluginLoader const &) = delete;
+  LazyPluginLoader &operator=(LazyPluginLoader const &) = delete;
+
+  // Arranges for |plugin| to be loaded and registered with |registrar| when
+  // the first message arrives on its channel.
+  void AddPlugin(const LazyPlugin &plugin,
+                 FlutterDesktopPluginRegistrarRef registrar);
+
+ private:
+  struct PendingPlugin;
+
+  // The placeholder message handler installed for each lazy plugin.
+  static void OnFirstMessage(FlutterDesktopMessengerRef messenger,
+                             const FlutterDesktopMessage *message,
+                             void *user_data);
+
+  // Loads and registers |plugin|. Returns false on failure.
+  bool Load(PendingPlugin *plugin);
+
+  std::string library_directory_;
+  StartupTracer *tracer_;
+  std::vector<std::unique_ptr<PendingPlugin>> plugins_;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_LAZY_PLUGIN_LOADER_H_
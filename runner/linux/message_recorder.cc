@@ -0,0 +1,96 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/message_recorder.h"
+
+#include <errno.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "runner/linux/startup_tracer.h"
+
+namespace runner {
+
+namespace {
+
+const char kPathEnvironmentVariable[] = "FLUTTER_MESSAGE_RECORD";
+const char kPathArgumentPrefix[] = "--record-messages=";
+
+}  // namespace
+
+MessageRecorder::MessageRecorder(int argc, char **argv) {
+  std::string path;
+  const char *path_variable = getenv(kPathEnvironmentVariable);
+  if (path_variable) {
+    path = path_variable;
+  }
+  size_t prefix_length = strlen(kPathArgumentPrefix);
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], kPathArgumentPrefix, prefix_length) == 0) {
+      path = argv[i] + prefix_length;
+    }
+  }
+  if (path.empty()) {
+    return;
+  }
+  if (!writer_.Open(path)) {
+    std::cerr << "Unable to record messages to " << path << ": "
+              << strerror(errno) << std::endl;
+    return;
+  }
+  enabled_ = true;
+  start_time_ = StartupTracer::Now();
+  AddMessageObserver(this);
+}
+
+MessageRecorder::~MessageRecorder() {
+  if (enabled_) {
+    RemoveMessageObserver(this);
+  }
+}
+
+void MessageRecorder::WillHandleMessage(const FlutterDesktopMessage &message) {
+  uint64_t index = writer_.WriteMessageFromDart(
+      Now(), message.channel, message.message, message.message_size);
+  if (message.response_handle) {
+    pending_responses_[message.response_handle] = index;
+  }
+}
+
+void MessageRecorder::DidHandleMessage(const FlutterDesktopMessage &message) {}
+
+void MessageRecorder::DidSendResponse(
+    const FlutterDesktopMessageResponseHandle *handle, const uint8_t *response,
+    size_t response_size) {
+  auto it = pending_responses_.find(handle);
+  if (it == pending_responses_.end()) {
+    return;
+  }
+  writer_.WriteResponse(Now(), it->second, response, response_size);
+  pending_responses_.erase(it);
+}
+
+void MessageRecorder::DidSendMessage(const char *channel,
+                                     const uint8_t *message,
+                                     size_t message_size) {
+  writer_.WriteMessageToDart(Now(), channel, message, message_size);
+}
+
+int64_t MessageRecorder::Now() const {
+  return StartupTracer::Now() - start_time_;
+}
+
+}  // namespace runner
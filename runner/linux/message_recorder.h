@@ -0,0 +1,71 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_MESSAGE_RECORDER_H_
+#define RUNNER_LINUX_MESSAGE_RECORDER_H_
+
+#include <cstdint>
+#include <unordered_map>
+
+#include "plugins/common/linux/message_log.h"
+#include "runner/linux/messenger_interposer.h"
+
+namespace runner {
+
+// Records the platform channel traffic of the plugins to a log file, for
+// replaying against the plugins without an engine with message_replay (see
+// plugins/common/linux/message_log.h).
+//
+// Recording is enabled by passing --record-messages=<path> to the runner, or
+// by setting FLUTTER_MESSAGE_RECORD to a path. Like PluginCallTracer, the
+// recorder must be created before plugins are registered. Every message
+// from Dart to a handler installed after that, every response, and every
+// message sent to Dart is logged with its time; the log is complete once the
+// recorder is destroyed.
+class MessageRecorder : public MessageObserver {
+ public:
+  // Configures the recorder from the environment and |argv|, and starts
+  // recording if enabled.
+  MessageRecorder(int argc, char **argv);
+  virtual ~MessageRecorder();
+
+  // Prevent copying.
+  MessageRecorder(MessageRecorder const &) = delete;
+  MessageRecorder &operator=(MessageRecorder const &) = delete;
+
+  bool enabled() const { return enabled_; }
+
+  // MessageObserver:
+  void WillHandleMessage(const FlutterDesktopMessage &message) override;
+  void DidHandleMessage(const FlutterDesktopMessage &message) override;
+  void DidSendResponse(const FlutterDesktopMessageResponseHandle *handle,
+                       const uint8_t *response, size_t response_size) override;
+  void DidSendMessage(const char *channel, const uint8_t *message,
+                      size_t message_size) override;
+
+ private:
+  // Returns the time since recording started.
+  int64_t Now() const;
+
+  bool enabled_ = false;
+  int64_t start_time_ = 0;
+  plugins_common::MessageLogWriter writer_;
+  // The logged index of each message awaiting a response, by response
+  // handle.
+  std::unordered_map<const FlutterDesktopMessageResponseHandle *, uint64_t>
+      pending_responses_;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_MESSAGE_RECORDER_H_
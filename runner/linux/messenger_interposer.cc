@@ -0,0 +1,178 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/messenger_interposer.h"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace runner {
+
+namespace {
+
+using InstalledCallback = std::pair<FlutterDesktopMessageCallback, void *>;
+
+// The callbacks installed for each channel. Only accessed from the platform
+// thread.
+std::map<std::string, InstalledCallback> &InstalledCallbacks() {
+  static auto *callbacks = new std::map<std::string, InstalledCallback>();
+  return *callbacks;
+}
+
+// Only accessed from the platform thread.
+std::vector<MessageObserver *> &Observers() {
+  static auto *observers = new std::vector<MessageObserver *>();
+  return *observers;
+}
+
+// The handler installed with the Flutter library in place of a plugin's
+// handler while there are observers, which calls the observers around the
+// plugin's handler.
+struct ObservedHandler {
+  FlutterDesktopMessageCallback callback;
+  void *user_data;
+};
+
+// The ObservedHandler for each channel. Entries are updated rather than
+// replaced, since a handler may install another for its own channel while
+// running. Only accessed from the platform thread.
+std::map<std::string, std::unique_ptr<ObservedHandler>> &ObservedHandlers() {
+  static auto *handlers =
+      new std::map<std::string, std::unique_ptr<ObservedHandler>>();
+  return *handlers;
+}
+
+void HandleObservedMessage(FlutterDesktopMessengerRef messenger,
+                           const FlutterDesktopMessage *message,
+                           void *user_data) {
+  auto *handler = static_cast<ObservedHandler *>(user_data);
+  for (MessageObserver *observer : Observers()) {
+    observer->WillHandleMessage(*message);
+  }
+  handler->callback(messenger, message, handler->user_data);
+  for (MessageObserver *observer : Observers()) {
+    observer->DidHandleMessage(*message);
+  }
+}
+
+// Returns the Flutter library's implementation of |name|, or nullptr after
+// logging an error.
+template <typename Function>
+Function LookUpRealFunction(const char *name) {
+  auto function = reinterpret_cast<Function>(dlsym(RTLD_NEXT, name));
+  if (!function) {
+    std::cerr << "Unable to find " << name << ": " << dlerror() << std::endl;
+  }
+  return function;
+}
+
+}  // namespace
+
+bool GetInstalledMessageCallback(const std::string &channel,
+                                 FlutterDesktopMessageCallback *callback,
+                                 void **user_data) {
+  auto it = InstalledCallbacks().find(channel);
+  if (it == InstalledCallbacks().end()) {
+    return false;
+  }
+  *callback = it->second.first;
+  *user_data = it->second.second;
+  return true;
+}
+
+void AddMessageObserver(MessageObserver *observer) {
+  Observers().push_back(observer);
+}
+
+void RemoveMessageObserver(MessageObserver *observer) {
+  auto &observers = Observers();
+  observers.erase(std::remove(observers.begin(), observers.end(), observer),
+                  observers.end());
+}
+
+}  // namespace runner
+
+void FlutterDesktopMessengerSetCallback(FlutterDesktopMessengerRef messenger,
+                                        const char *channel,
+                                        FlutterDesktopMessageCallback callback,
+                                        void *user_data) {
+  using SetCallbackFunction =
+      void (*)(FlutterDesktopMessengerRef, const char *,
+               FlutterDesktopMessageCallback, void *);
+  static auto real_set_callback =
+      runner::LookUpRealFunction<SetCallbackFunction>(
+          "FlutterDesktopMessengerSetCallback");
+  if (!real_set_callback) {
+    return;
+  }
+  if (callback) {
+    runner::InstalledCallbacks()[channel] = {callback, user_data};
+  } else {
+    runner::InstalledCallbacks().erase(channel);
+  }
+  if (callback && !runner::Observers().empty()) {
+    auto &handler = runner::ObservedHandlers()[channel];
+    if (!handler) {
+      handler = std::make_unique<runner::ObservedHandler>();
+    }
+    handler->callback = callback;
+    handler->user_data = user_data;
+    real_set_callback(messenger, channel, runner::HandleObservedMessage,
+                      handler.get());
+    return;
+  }
+  real_set_callback(messenger, channel, callback, user_data);
+}
+
+bool FlutterDesktopMessengerSend(FlutterDesktopMessengerRef messenger,
+                                 const char *channel, const uint8_t *message,
+                                 const size_t message_size) {
+  using SendFunction = bool (*)(FlutterDesktopMessengerRef, const char *,
+                                const uint8_t *, const size_t);
+  static auto real_send = runner::LookUpRealFunction<SendFunction>(
+      "FlutterDesktopMessengerSend");
+  if (!real_send) {
+    return false;
+  }
+  for (runner::MessageObserver *observer : runner::Observers()) {
+    observer->DidSendMessage(channel, message, message_size);
+  }
+  return real_send(messenger, channel, message, message_size);
+}
+
+void FlutterDesktopMessengerSendResponse(
+    FlutterDesktopMessengerRef messenger,
+    const FlutterDesktopMessageResponseHandle *handle, const uint8_t *data,
+    size_t data_length) {
+  using SendResponseFunction =
+      void (*)(FlutterDesktopMessengerRef,
+               const FlutterDesktopMessageResponseHandle *, const uint8_t *,
+               size_t);
+  static auto real_send_response =
+      runner::LookUpRealFunction<SendResponseFunction>(
+          "FlutterDesktopMessengerSendResponse");
+  if (!real_send_response) {
+    return;
+  }
+  // Reported before sending, since the handle is released by sending.
+  for (runner::MessageObserver *observer : runner::Observers()) {
+    observer->DidSendResponse(handle, data, data_length);
+  }
+  real_send_response(messenger, handle, data, data_length);
+}
@@ -0,0 +1,68 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_MESSENGER_INTERPOSER_H_
+#define RUNNER_LINUX_MESSENGER_INTERPOSER_H_
+
+#include <flutter_messenger.h>
+
+#include <string>
+
+// The runner defines FlutterDesktopMessengerSetCallback,
+// FlutterDesktopMessengerSend, and FlutterDesktopMessengerSendResponse
+// itself, forwarding to the Flutter library's implementations, so that it can
+// observe the message handlers installed by plugins and the messages passing
+// through them. Since the executable's symbols take precedence over those of
+// shared libraries, this also applies to plugin libraries, as long as the
+// runner is linked with -rdynamic.
+
+namespace runner {
+
+// Receives the platform messages passing through the interposed functions.
+// All methods are called on the platform thread.
+class MessageObserver {
+ public:
+  virtual ~MessageObserver() = default;
+
+  // Called before |message| is passed to its channel's handler.
+  virtual void WillHandleMessage(const FlutterDesktopMessage &message) = 0;
+
+  // Called when the handler for |message| returns. It may respond later.
+  virtual void DidHandleMessage(const FlutterDesktopMessage &message) = 0;
+
+  // Called when |response| is sent for the message with |handle|.
+  virtual void DidSendResponse(
+      const FlutterDesktopMessageResponseHandle *handle,
+      const uint8_t *response, size_t response_size) = 0;
+
+  // Called when |message| is sent to Dart on |channel|.
+  virtual void DidSendMessage(const char *channel, const uint8_t *message,
+                              size_t message_size) = 0;
+};
+
+// Adds an observer for messages, which must remain valid until removed.
+// Handlers installed while there are no observers are not observed, so this
+// should be called before plugins are registered.
+void AddMessageObserver(MessageObserver *observer);
+
+void RemoveMessageObserver(MessageObserver *observer);
+
+// Looks up the message callback most recently installed for |channel| by any
+// code in the process. Returns false if there is none.
+bool GetInstalledMessageCallback(const std::string &channel,
+                                 FlutterDesktopMessageCallback *callback,
+                                 void **user_data);
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_MESSENGER_INTERPOSER_H_
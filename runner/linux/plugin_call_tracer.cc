@@ -0,0 +1,406 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/plugin_call_tracer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <tuple>
+
+#include <flutter/standard_method_codec.h>
+
+#include "runner/linux/startup_tracer.h"
+
+namespace runner {
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+const char kEnableEnvironmentVariable[] = "FLUTTER_PLUGIN_CALL_TRACE";
+const char kEnableArgument[] = "--trace-plugin-calls";
+
+// See call_diagnostics.dart for documentation.
+const char kChannelName[] = "flutter/diagnostics";
+const char kGetCallRecordsMethod[] = "GetCallRecords";
+const char kGetCallStatsMethod[] = "GetCallStats";
+const char kSetStatsIntervalMethod[] = "SetStatsInterval";
+const char kCallStatsMethod[] = "CallStats";
+
+// The type tag and size limits of strings in the standard codec.
+const uint8_t kStandardCodecStringType = 7;
+const uint8_t kStandardCodecUint16Size = 254;
+const uint8_t kStandardCodecUint32Size = 255;
+
+// The method name key, as encoded by the JSON method codec.
+const char kJsonMethodKey[] = "\"method\":\"";
+
+// Copies |size| bytes of |source| into |destination|, truncating to fit and
+// null-terminating.
+template <size_t N>
+void CopyTruncated(char (&destination)[N], const char *source, size_t size) {
+  size = std::min(size, N - 1);
+  memcpy(destination, source, size);
+  destination[size] = '\0';
+}
+
+// Copies the method name of |message| into |method|, or sets it to an empty
+// string if |message| isn't a method call in the standard or JSON method
+// codec. Only the start of the message is examined.
+template <size_t N>
+void ReadMethodName(const uint8_t *message, size_t size, char (&method)[N]) {
+  method[0] = '\0';
+  if (size == 0) {
+    return;
+  }
+  const char *data = reinterpret_cast<const char *>(message);
+  if (message[0] == kStandardCodecStringType && size > 1) {
+    size_t length = message[1];
+    size_t offset = 2;
+    if (length == kStandardCodecUint16Size && size >= 4) {
+      length = message[2] | message[3] << 8;
+      offset = 4;
+    } else if (length == kStandardCodecUint32Size && size >= 6) {
+      length = message[2] | message[3] << 8 | message[4] << 16 |
+               static_cast<size_t>(message[5]) << 24;
+      offset = 6;
+    } else if (length >= kStandardCodecUint16Size) {
+      return;
+    }
+    if (offset + length <= size) {
+      CopyTruncated(method, data + offset, length);
+    }
+    return;
+  }
+  if (message[0] == '{') {
+    // Method names are short, so the key is near the start if present.
+    size_t search_size = std::min<size_t>(size, 256);
+    const char *end = data + search_size;
+    const char *key = std::search(data, end, kJsonMethodKey,
+                                  kJsonMethodKey + strlen(kJsonMethodKey));
+    if (key == end) {
+      return;
+    }
+    const char *name = key + strlen(kJsonMethodKey);
+    const char *name_end = std::find(name, end, '"');
+    if (name_end != end) {
+      CopyTruncated(method, name, name_end - name);
+    }
+  }
+}
+
+// Returns the |percent|th percentile of |values|, which must not be empty.
+// Reorders |values|.
+int64_t Percentile(std::vector<int64_t> *values, int percent) {
+  auto nth = values->begin() + (values->size() - 1) * percent / 100;
+  std::nth_element(values->begin(), nth, values->end());
+  return *nth;
+}
+
+// Returns a duration as an EncodableValue, with -1 as null.
+EncodableValue DurationValue(int64_t duration) {
+  return duration < 0 ? EncodableValue() : EncodableValue(duration);
+}
+
+const char *DirectionName(PluginCallTracer::Direction direction) {
+  return direction == PluginCallTracer::Direction::kIncoming ? "in" : "out";
+}
+
+// Returns |record| as a map, in the format documented in
+// call_diagnostics.dart.
+EncodableValue RecordValue(const PluginCallTracer::CallRecord &record) {
+  return EncodableValue(EncodableMap{
+      {EncodableValue("id"), EncodableValue(static_cast<int64_t>(record.id))},
+      {EncodableValue("direction"),
+       EncodableValue(DirectionName(record.direction))},
+      {EncodableValue("channel"), EncodableValue(record.channel)},
+      {EncodableValue("method"), EncodableValue(record.method)},
+      {EncodableValue("payloadSize"),
+       EncodableValue(static_cast<int64_t>(record.payload_size))},
+      {EncodableValue("start"), EncodableValue(record.start)},
+      {EncodableValue("handlerDuration"),
+       DurationValue(record.handler_duration)},
+      {EncodableValue("queueDuration"), DurationValue(record.queue_duration)},
+      {EncodableValue("responseSize"),
+       EncodableValue(static_cast<int64_t>(record.response_size))},
+  });
+}
+
+}  // namespace
+
+constexpr size_t PluginCallTracer::kCapacity;
+
+PluginCallTracer::PluginCallTracer(int argc, char **argv) {
+  const char *enable = getenv(kEnableEnvironmentVariable);
+  enabled_ = enable && enable[0] != '\0';
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], kEnableArgument) == 0) {
+      enabled_ = true;
+    }
+  }
+  if (!enabled_) {
+    return;
+  }
+  slots_ = std::make_unique<std::array<Slot, kCapacity>>();
+  AddMessageObserver(this);
+}
+
+PluginCallTracer::~PluginCallTracer() {
+  if (enabled_) {
+    RemoveMessageObserver(this);
+  }
+}
+
+void PluginCallTracer::RegisterChannel(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  if (!enabled_ || registrar_) {
+    return;
+  }
+  registrar_ = std::make_unique<flutter::PluginRegistrar>(registrar);
+  channel_ = std::make_unique<flutter::MethodChannel<EncodableValue>>(
+      registrar_->messenger(), kChannelName,
+      &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetMethodCallHandler([this](const auto &call, auto result) {
+    const std::string &method = call.method_name();
+    if (method.compare(kGetCallRecordsMethod) == 0) {
+      EncodableList records;
+      for (const CallRecord &record : ReadRecords()) {
+        records.push_back(RecordValue(record));
+      }
+      EncodableValue value(records);
+      result->Success(&value);
+    } else if (method.compare(kGetCallStatsMethod) == 0) {
+      EncodableValue stats = GetCallStats();
+      result->Success(&stats);
+    } else if (method.compare(kSetStatsIntervalMethod) == 0) {
+      if (!call.arguments() || !call.arguments()->IsInt() ||
+          call.arguments()->IntValue() < 0) {
+        result->Error("Bad arguments", "Expected interval in milliseconds");
+        return;
+      }
+      stats_interval_ = int64_t{call.arguments()->IntValue()} * 1000;
+      next_stats_time_ = StartupTracer::Now() + stats_interval_;
+      result->Success();
+    } else {
+      result->NotImplemented();
+    }
+  });
+}
+
+void PluginCallTracer::Poll() {
+  if (stats_interval_ == 0 || !channel_) {
+    return;
+  }
+  int64_t now = StartupTracer::Now();
+  if (now < next_stats_time_) {
+    return;
+  }
+  next_stats_time_ = now + stats_interval_;
+  channel_->InvokeMethod(kCallStatsMethod,
+                         std::make_unique<EncodableValue>(GetCallStats()));
+}
+
+std::vector<PluginCallTracer::CallRecord> PluginCallTracer::ReadRecords()
+    const {
+  std::vector<CallRecord> records;
+  if (!enabled_) {
+    return records;
+  }
+  uint64_t end = next_id_.load(std::memory_order_acquire);
+  uint64_t begin = end > kCapacity ? end - kCapacity : 0;
+  records.reserve(end - begin);
+  for (uint64_t id = begin; id < end; ++id) {
+    const Slot &slot = (*slots_)[id % kCapacity];
+    CallRecord record;
+    uint32_t sequence;
+    // A standard seqlock read: retry if the writer changed the slot while it
+    // was being copied.
+    do {
+      sequence = slot.sequence.load(std::memory_order_acquire);
+      record = slot.record;
+      std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((sequence & 1) != 0 ||
+             slot.sequence.load(std::memory_order_relaxed) != sequence);
+    // The slot may already hold a newer record if the buffer wrapped during
+    // the read.
+    if (record.id == id) {
+      records.push_back(record);
+    }
+  }
+  return records;
+}
+
+void PluginCallTracer::WillHandleMessage(const FlutterDesktopMessage &message) {
+  // Don't record reads of the records.
+  if (strcmp(message.channel, kChannelName) == 0) {
+    running_calls_.push_back(UINT64_MAX);
+    return;
+  }
+  uint64_t id = AddRecord(Direction::kIncoming, message.channel,
+                          message.message, message.message_size,
+                          StartupTracer::Now());
+  running_calls_.push_back(id);
+  if (message.response_handle) {
+    pending_responses_[message.response_handle] = id;
+  }
+}
+
+void PluginCallTracer::DidHandleMessage(const FlutterDesktopMessage &message) {
+  if (running_calls_.empty()) {
+    return;
+  }
+  uint64_t id = running_calls_.back();
+  running_calls_.pop_back();
+  if (id == UINT64_MAX) {
+    return;
+  }
+  int64_t now = StartupTracer::Now();
+  UpdateRecord(id, [now](CallRecord *record) {
+    record->handler_duration = now - record->start;
+    // A response sent by the handler itself wasn't queued.
+    if (record->queue_duration >= 0) {
+      record->queue_duration = 0;
+    }
+  });
+}
+
+void PluginCallTracer::DidSendResponse(
+    const FlutterDesktopMessageResponseHandle *handle, const uint8_t *response,
+    size_t response_size) {
+  auto it = pending_responses_.find(handle);
+  if (it == pending_responses_.end()) {
+    return;
+  }
+  uint64_t id = it->second;
+  pending_responses_.erase(it);
+  int64_t now = StartupTracer::Now();
+  UpdateRecord(id, [now, response_size](CallRecord *record) {
+    record->response_size = static_cast<uint32_t>(response_size);
+    // While the handler is running, this is fixed up when it returns.
+    record->queue_duration =
+        record->handler_duration < 0
+            ? now - record->start
+            : now - record->start - record->handler_duration;
+  });
+}
+
+void PluginCallTracer::DidSendMessage(const char *channel,
+                                      const uint8_t *message,
+                                      size_t message_size) {
+  if (strcmp(channel, kChannelName) == 0) {
+    return;
+  }
+  uint64_t id = AddRecord(Direction::kOutgoing, channel, message,
+                          message_size, StartupTracer::Now());
+  UpdateRecord(id, [](CallRecord *record) { record->handler_duration = 0; });
+}
+
+uint64_t PluginCallTracer::AddRecord(Direction direction, const char *channel,
+                                     const uint8_t *message,
+                                     size_t message_size, int64_t start) {
+  uint64_t id = next_id_.load(std::memory_order_relaxed);
+  Slot &slot = (*slots_)[id % kCapacity];
+  uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  CallRecord &record = slot.record;
+  record.id = id;
+  record.direction = direction;
+  CopyTruncated(record.channel, channel, strlen(channel));
+  ReadMethodName(message, message_size, record.method);
+  record.payload_size = static_cast<uint32_t>(message_size);
+  record.start = start;
+  record.handler_duration = -1;
+  record.queue_duration = -1;
+  record.response_size = 0;
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+  next_id_.store(id + 1, std::memory_order_release);
+
+  // Calls that are never responded to would otherwise accumulate.
+  if (pending_responses_.size() > kCapacity) {
+    uint64_t oldest = id + 1 - kCapacity;
+    for (auto it = pending_responses_.begin();
+         it != pending_responses_.end();) {
+      it = it->second < oldest ? pending_responses_.erase(it) : ++it;
+    }
+  }
+  return id;
+}
+
+template <typename Update>
+void PluginCallTracer::UpdateRecord(uint64_t id, Update update) {
+  Slot &slot = (*slots_)[id % kCapacity];
+  // Only this thread writes, so the record can be read without the sequence.
+  if (slot.record.id != id) {
+    return;
+  }
+  uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  update(&slot.record);
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+EncodableValue PluginCallTracer::GetCallStats() const {
+  struct Durations {
+    std::vector<int64_t> handler;
+    std::vector<int64_t> response;
+  };
+  std::map<std::tuple<Direction, std::string, std::string>, Durations>
+      durations_by_method;
+  for (const CallRecord &record : ReadRecords()) {
+    Durations &durations = durations_by_method[std::make_tuple(
+        record.direction, std::string(record.channel),
+        std::string(record.method))];
+    if (record.handler_duration >= 0) {
+      durations.handler.push_back(record.handler_duration);
+    }
+    if (record.handler_duration >= 0 && record.queue_duration >= 0) {
+      durations.response.push_back(record.handler_duration +
+                                   record.queue_duration);
+    }
+  }
+  EncodableList stats;
+  for (auto &entry : durations_by_method) {
+    Durations &durations = entry.second;
+    EncodableMap method_stats{
+        {EncodableValue("direction"),
+         EncodableValue(DirectionName(std::get<0>(entry.first)))},
+        {EncodableValue("channel"), EncodableValue(std::get<1>(entry.first))},
+        {EncodableValue("method"), EncodableValue(std::get<2>(entry.first))},
+        {EncodableValue("count"),
+         EncodableValue(static_cast<int64_t>(durations.handler.size()))},
+    };
+    if (!durations.handler.empty()) {
+      method_stats[EncodableValue("handlerP50")] =
+          EncodableValue(Percentile(&durations.handler, 50));
+      method_stats[EncodableValue("handlerP99")] =
+          EncodableValue(Percentile(&durations.handler, 99));
+    }
+    if (!durations.response.empty()) {
+      method_stats[EncodableValue("responseP50")] =
+          EncodableValue(Percentile(&durations.response, 50));
+      method_stats[EncodableValue("responseP99")] =
+          EncodableValue(Percentile(&durations.response, 99));
+    }
+    stats.push_back(EncodableValue(method_stats));
+  }
+  return EncodableValue(stats);
+}
+
+}  // namespace runner
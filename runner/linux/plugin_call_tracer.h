@@ -0,0 +1,154 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_PLUGIN_CALL_TRACER_H_
+#define RUNNER_LINUX_PLUGIN_CALL_TRACER_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar.h>
+#include <flutter_plugin_registrar.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "runner/linux/messenger_interposer.h"
+
+namespace runner {
+
+// Records the platform messages handled by plugins and sent by them, for
+// inspecting plugin latency from the running application.
+//
+// Tracing is enabled by passing --trace-plugin-calls to the runner, or by
+// setting FLUTTER_PLUGIN_CALL_TRACE. It must be enabled before plugins are
+// registered, since it observes messages through the handlers they install
+// (see messenger_interposer.h).
+//
+// The most recent kCapacity calls are kept in a ring buffer, which Dart can
+// read, or summarize per method, over the flutter/diagnostics channel; see
+// call_diagnostics.dart. Each record is written by the platform thread under
+// a per-slot sequence counter, so ReadRecords can be called from any thread
+// without blocking the writer.
+class PluginCallTracer : public MessageObserver {
+ public:
+  // The number of calls retained.
+  static constexpr size_t kCapacity = 4096;
+
+  enum class Direction : uint8_t {
+    // A message from Dart, handled by a plugin.
+    kIncoming,
+    // A message from a plugin to Dart.
+    kOutgoing,
+  };
+
+  // A recorded call. Times are in microseconds on StartupTracer's clock.
+  struct CallRecord {
+    // Increases by one for each call, starting from zero.
+    uint64_t id;
+    Direction direction;
+    // Truncated, and always null-terminated.
+    char channel[64];
+    // The method name, for messages using the standard or JSON method codec;
+    // otherwise empty.
+    char method[64];
+    uint32_t payload_size;
+    int64_t start;
+    // How long the handler ran, or -1 while it is running. Always 0 for
+    // outgoing messages.
+    int64_t handler_duration;
+    // How long after the handler returned the response was sent (for example,
+    // while the work was queued on a worker thread), or -1 if there has been
+    // no response.
+    int64_t queue_duration;
+    uint32_t response_size;
+  };
+
+  // Configures the tracer from the environment and |argv|, and starts
+  // observing messages if enabled.
+  PluginCallTracer(int argc, char **argv);
+  virtual ~PluginCallTracer();
+
+  // Prevent copying.
+  PluginCallTracer(PluginCallTracer const &) = delete;
+  PluginCallTracer &operator=(PluginCallTracer const &) = delete;
+
+  bool enabled() const { return enabled_; }
+
+  // Registers the flutter/diagnostics channel.
+  void RegisterChannel(FlutterDesktopPluginRegistrarRef registrar);
+
+  // Sends Dart the periodic statistics, if they are due. Must be called on
+  // the platform thread; the runner's event loop calls it after each
+  // iteration.
+  void Poll();
+
+  // Returns the retained records, oldest first. Can be called on any thread.
+  std::vector<CallRecord> ReadRecords() const;
+
+  // MessageObserver:
+  void WillHandleMessage(const FlutterDesktopMessage &message) override;
+  void DidHandleMessage(const FlutterDesktopMessage &message) override;
+  void DidSendResponse(const FlutterDesktopMessageResponseHandle *handle,
+                       const uint8_t *response, size_t response_size) override;
+  void DidSendMessage(const char *channel, const uint8_t *message,
+                      size_t message_size) override;
+
+ private:
+  struct Slot {
+    // Odd while the record is being written.
+    std::atomic<uint32_t> sequence{0};
+    CallRecord record;
+  };
+
+  // Starts a record for a message on |channel|, returning its id.
+  uint64_t AddRecord(Direction direction, const char *channel,
+                     const uint8_t *message, size_t message_size,
+                     int64_t start);
+
+  // Rewrites the record |id| with |update| applied, unless it has already
+  // been overwritten by a newer one.
+  template <typename Update>
+  void UpdateRecord(uint64_t id, Update update);
+
+  // Returns per-method statistics for the retained records.
+  flutter::EncodableValue GetCallStats() const;
+
+  bool enabled_ = false;
+
+  // The ring buffer, and the id of the next record.
+  std::unique_ptr<std::array<Slot, kCapacity>> slots_;
+  std::atomic<uint64_t> next_id_{0};
+
+  // The remaining state is only accessed on the platform thread.
+
+  // The ids of the calls whose handlers are running, innermost last. Handlers
+  // can nest, such as when one runs a modal dialog.
+  std::vector<uint64_t> running_calls_;
+  // The ids of the calls waiting for a response, by response handle.
+  std::unordered_map<const FlutterDesktopMessageResponseHandle *, uint64_t>
+      pending_responses_;
+
+  int64_t stats_interval_ = 0;
+  int64_t next_stats_time_ = 0;
+
+  std::unique_ptr<flutter::PluginRegistrar> registrar_;
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_PLUGIN_CALL_TRACER_H_
@@ -0,0 +1,131 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/shader_cache.h"
+
+#include <dirent.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <flutter_glfw.h>
+
+#include "runner/linux/app_directories.h"
+
+namespace runner {
+
+namespace {
+
+const char kShaderCacheDirectoryName[] = "shader_cache";
+// The file in the cache directory identifying the engine that populated it.
+const char kEngineStampFileName[] = "engine_stamp";
+const char kPurgeArgument[] = "--purge-shader-cache";
+
+// Returns a string identifying the loaded Flutter engine library, which
+// changes whenever the library is rebuilt or replaced, or an empty string if
+// it can't be determined.
+std::string GetEngineIdentity() {
+  Dl_info info = {};
+  if (dladdr(reinterpret_cast<void *>(&FlutterDesktopInit), &info) == 0 ||
+      !info.dli_fname) {
+    return "";
+  }
+  struct stat library_info = {};
+  if (stat(info.dli_fname, &library_info) != 0) {
+    return "";
+  }
+  std::ostringstream identity;
+  identity << info.dli_fname << " " << library_info.st_size << " "
+           << library_info.st_mtim.tv_sec << "."
+           << library_info.st_mtim.tv_nsec;
+  return identity.str();
+}
+
+// Returns true if |directory| contains anything other than the engine stamp.
+bool HasCachedShaders(const std::string &directory) {
+  DIR *dir = opendir(directory.c_str());
+  if (!dir) {
+    return false;
+  }
+  bool found = false;
+  while (struct dirent *entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name != "." && name != ".." && name != kEngineStampFileName) {
+      found = true;
+      break;
+    }
+  }
+  closedir(dir);
+  return found;
+}
+
+}  // namespace
+
+const char *ShaderCacheStateName(ShaderCacheState state) {
+  switch (state) {
+    case ShaderCacheState::kDisabled:
+      return "disabled";
+    case ShaderCacheState::kCold:
+      return "cold";
+    case ShaderCacheState::kWarm:
+      return "warm";
+  }
+  return "";
+}
+
+ShaderCacheState ConfigureShaderCache(
+    const std::string &application_cache_directory, int argc, char **argv,
+    std::vector<std::string> *engine_arguments) {
+  if (application_cache_directory.empty()) {
+    return ShaderCacheState::kDisabled;
+  }
+  bool purge = false;
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], kPurgeArgument) == 0) {
+      purge = true;
+    }
+  }
+  std::string directory =
+      application_cache_directory + "/" + kShaderCacheDirectoryName;
+  std::string stamp_path = directory + "/" + kEngineStampFileName;
+
+  std::string engine_identity = GetEngineIdentity();
+  std::string stamp;
+  std::getline(std::ifstream(stamp_path), stamp);
+  bool cleared = purge || engine_identity.empty() || stamp != engine_identity;
+  if (cleared) {
+    RemoveRecursively(directory);
+  }
+  if (!CreateDirectories(directory)) {
+    std::cerr << "Unable to create shader cache " << directory << std::endl;
+    return ShaderCacheState::kDisabled;
+  }
+  ShaderCacheState state = HasCachedShaders(directory)
+                               ? ShaderCacheState::kWarm
+                               : ShaderCacheState::kCold;
+  if (cleared && !engine_identity.empty()) {
+    std::ofstream(stamp_path, std::ios::trunc) << engine_identity << "\n";
+  }
+
+  engine_arguments->push_back("--cache-dir-path=" + directory);
+  // Store shaders as SkSL, which is portable across GPU drivers and is the
+  // format used for bundled warm-up shaders.
+  engine_arguments->push_back("--cache-sksl");
+  return state;
+}
+
+}  // namespace runner
@@ -0,0 +1,54 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_SHADER_CACHE_H_
+#define RUNNER_LINUX_SHADER_CACHE_H_
+
+#include <string>
+#include <vector>
+
+namespace runner {
+
+// The state of the shader cache at startup.
+enum class ShaderCacheState {
+  // No cache could be configured; shaders are compiled on every run.
+  kDisabled,
+  // The cache is empty, because this is the first run, the engine changed,
+  // or the cache was purged.
+  kCold,
+  // The cache contains shaders from an earlier run of the same engine.
+  kWarm,
+};
+
+// Returns a short name for |state|, for logging and trace metadata.
+const char *ShaderCacheStateName(ShaderCacheState state);
+
+// Configures a persistent cache of the engine's compiled shaders (as SkSL) in
+// the shader_cache subdirectory of |application_cache_directory|, adding the
+// engine switches to use it to |engine_arguments|. Shaders compiled while
+// animating in one run are then reused by later runs rather than compiled
+// again mid-animation.
+//
+// Compiled shaders are only valid for the engine that produced them, so the
+// cache is cleared whenever the Flutter engine library changes. Passing
+// --purge-shader-cache in |argv| also clears it, to measure a first run.
+//
+// Shaders can also be warmed up before the first run by bundling an SkSL
+// file in the assets; see SKSL_WARMUP in the runner Makefiles.
+ShaderCacheState ConfigureShaderCache(
+    const std::string &application_cache_directory, int argc, char **argv,
+    std::vector<std::string> *engine_arguments);
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_SHADER_CACHE_H_
@@ -0,0 +1,206 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/single_instance.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include <flutter/standard_method_codec.h>
+
+#include "runner/linux/unix_socket.h"
+
+namespace runner {
+
+namespace {
+
+using flutter::EncodableList;
+using flutter::EncodableMap;
+using flutter::EncodableValue;
+
+const char kEnableEnvironmentVariable[] = "FLUTTER_SINGLE_INSTANCE";
+const char kEnableArgument[] = "--single-instance";
+
+// See single_instance.dart for documentation.
+const char kChannelName[] = "flutter/singleinstance";
+const char kListenMethod[] = "Listen";
+const char kLaunchedMethod[] = "Launched";
+const char kWorkingDirectoryKey[] = "workingDirectory";
+const char kArgumentsKey[] = "arguments";
+
+// How long to wait for a connected process to send its launch, or for the
+// running instance to acknowledge it.
+const int kIoTimeoutSeconds = 2;
+// The byte sent by the running instance to acknowledge a launch.
+const char kAcknowledgement = 1;
+
+}  // namespace
+
+constexpr std::chrono::milliseconds SingleInstance::kDeliveryInterval;
+
+SingleInstance::SingleInstance(const std::string &application_id, int argc,
+                               char **argv) {
+  const char *enable = getenv(kEnableEnvironmentVariable);
+  enabled_ = enable && enable[0] != '\0';
+  for (int i = 1; i < argc; ++i) {
+    if (strcmp(argv[i], kEnableArgument) == 0) {
+      enabled_ = true;
+    } else {
+      arguments_.push_back(argv[i]);
+    }
+  }
+  // Abstract sockets are shared by all users in the network namespace, so
+  // the name includes the user, and connections are checked in Serve().
+  socket_name_ = "flutter-single-instance/" + application_id + "/" +
+                 std::to_string(getuid());
+}
+
+SingleInstance::~SingleInstance() {
+  if (server_socket_ < 0) {
+    return;
+  }
+  stopping_ = true;
+  // Unblocks the accept() in Serve().
+  shutdown(server_socket_, SHUT_RDWR);
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+  close(server_socket_);
+}
+
+bool SingleInstance::ForwardToRunningInstance() {
+  if (!enabled_) {
+    return false;
+  }
+  if (SendToServer()) {
+    return true;
+  }
+
+  int server_socket = ListenOnAbstractSocket(socket_name_);
+  if (server_socket < 0) {
+    int listen_error = errno;
+    // Another instance started at the same time and won the race to bind;
+    // hand this launch to it instead.
+    if (listen_error == EADDRINUSE && SendToServer()) {
+      return true;
+    }
+    std::cerr << "Unable to listen for other instances: "
+              << strerror(listen_error) << std::endl;
+    return false;
+  }
+  server_socket_ = server_socket;
+  thread_ = std::thread([this] { Serve(); });
+  return false;
+}
+
+void SingleInstance::RegisterChannel(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  if (!listening() || registrar_) {
+    return;
+  }
+  registrar_ = std::make_unique<flutter::PluginRegistrar>(registrar);
+  channel_ = std::make_unique<flutter::MethodChannel<EncodableValue>>(
+      registrar_->messenger(), kChannelName,
+      &flutter::StandardMethodCodec::GetInstance());
+  channel_->SetMethodCallHandler([this](const auto &call, auto result) {
+    if (call.method_name().compare(kListenMethod) != 0) {
+      result->NotImplemented();
+      return;
+    }
+    dart_listening_ = true;
+    result->Success();
+    DeliverForwardedLaunches();
+  });
+}
+
+void SingleInstance::DeliverForwardedLaunches() {
+  if (!dart_listening_) {
+    return;
+  }
+  std::vector<Launch> launches;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    launches.swap(pending_launches_);
+  }
+  for (const Launch &launch : launches) {
+    EncodableList arguments;
+    for (const std::string &argument : launch.arguments) {
+      arguments.push_back(EncodableValue(argument));
+    }
+    channel_->InvokeMethod(
+        kLaunchedMethod,
+        std::make_unique<EncodableValue>(EncodableMap{
+            {EncodableValue(kWorkingDirectoryKey),
+             EncodableValue(launch.working_directory)},
+            {EncodableValue(kArgumentsKey), EncodableValue(arguments)},
+        }));
+  }
+}
+
+bool SingleInstance::SendToServer() {
+  int fd = ConnectToAbstractSocket(socket_name_);
+  if (fd < 0) {
+    return false;
+  }
+  SetSocketTimeout(fd, kIoTimeoutSeconds);
+  char working_directory[PATH_MAX];
+  std::vector<std::string> strings;
+  strings.push_back(getcwd(working_directory, sizeof(working_directory))
+                        ? working_directory
+                        : "");
+  strings.insert(strings.end(), arguments_.begin(), arguments_.end());
+  char acknowledgement = 0;
+  bool sent = WriteStrings(fd, strings) &&
+              ReadFully(fd, &acknowledgement, sizeof(acknowledgement)) &&
+              acknowledgement == kAcknowledgement;
+  close(fd);
+  return sent;
+}
+
+void SingleInstance::Serve() {
+  while (!stopping_) {
+    int fd = accept4(server_socket_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      break;
+    }
+    // Only accept launches from the same user.
+    if (!IsPeerSameUser(fd)) {
+      close(fd);
+      continue;
+    }
+    SetSocketTimeout(fd, kIoTimeoutSeconds);
+    std::vector<std::string> strings;
+    if (ReadStrings(fd, &strings) && !strings.empty()) {
+      Launch launch;
+      launch.working_directory = strings[0];
+      launch.arguments.assign(strings.begin() + 1, strings.end());
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_launches_.push_back(std::move(launch));
+      }
+      WriteFully(fd, &kAcknowledgement, sizeof(kAcknowledgement));
+    }
+    close(fd);
+  }
+}
+
+}  // namespace runner
@@ -0,0 +1,104 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_SINGLE_INSTANCE_H_
+#define RUNNER_LINUX_SINGLE_INSTANCE_H_
+
+#include <flutter/encodable_value.h>
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar.h>
+#include <flutter_plugin_registrar.h>
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace runner {
+
+// Lets later launches of an application hand their arguments to the instance
+// that is already running, rather than each starting its own engine.
+//
+// The mode is opt-in: it is enabled by passing --single-instance to the
+// runner, or by setting FLUTTER_SINGLE_INSTANCE. The first instance listens
+// on an abstract Unix socket named for the application and user; later
+// instances connect to it, send their working directory and arguments, and
+// exit. The running instance delivers each forwarded launch to Dart on the
+// flutter/singleinstance channel (see single_instance.dart).
+class SingleInstance {
+ public:
+  // How often the runner's event loop should call DeliverForwardedLaunches
+  // while listening.
+  static constexpr std::chrono::milliseconds kDeliveryInterval{100};
+
+  // Configures single-instance mode for |application_id| from the
+  // environment and |argv|.
+  SingleInstance(const std::string &application_id, int argc, char **argv);
+  ~SingleInstance();
+
+  // Prevent copying.
+  SingleInstance(SingleInstance const &) = delete;
+  SingleInstance &operator=(SingleInstance const &) = delete;
+
+  // If single-instance mode is enabled and another instance is running,
+  // forwards this launch's arguments to it and returns true, in which case
+  // this process should exit. Otherwise, starts listening for later launches
+  // if the mode is enabled, and returns false.
+  bool ForwardToRunningInstance();
+
+  // Returns true if this instance is listening for later launches.
+  bool listening() const { return server_socket_ >= 0; }
+
+  // Registers the channel used to deliver forwarded launches to Dart.
+  void RegisterChannel(FlutterDesktopPluginRegistrarRef registrar);
+
+  // Sends any launches received since the last call to Dart, once Dart is
+  // listening. Must be called on the platform thread.
+  void DeliverForwardedLaunches();
+
+ private:
+  struct Launch {
+    std::string working_directory;
+    std::vector<std::string> arguments;
+  };
+
+  // Attempts to send this launch to a running instance. Returns false if
+  // none is listening.
+  bool SendToServer();
+
+  // Accepts and reads launches from later instances. Runs on |thread_|.
+  void Serve();
+
+  bool enabled_ = false;
+  std::string socket_name_;
+  std::vector<std::string> arguments_;
+  int server_socket_ = -1;
+  std::thread thread_;
+  std::atomic<bool> stopping_{false};
+
+  // Launches received by |thread_| but not yet delivered.
+  std::mutex mutex_;
+  std::vector<Launch> pending_launches_;
+
+  // Set once Dart has asked to receive launches.
+  bool dart_listening_ = false;
+  std::unique_ptr<flutter::PluginRegistrar> registrar_;
+  std::unique_ptr<flutter::MethodChannel<flutter::EncodableValue>> channel_;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_SINGLE_INSTANCE_H_
@@ -0,0 +1,271 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/stall_watchdog.h"
+
+#include <errno.h>
+#include <execinfo.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "runner/linux/startup_tracer.h"
+
+namespace runner {
+
+namespace {
+
+const char kEnableEnvironmentVariable[] = "FLUTTER_STALL_WATCHDOG";
+const char kLogEnvironmentVariable[] = "FLUTTER_STALL_LOG";
+const char kEnableArgument[] = "--stall-watchdog";
+
+const int64_t kDefaultThresholdMs = 250;
+// How long to wait for the platform thread to record its backtrace.
+const int64_t kCaptureTimeoutUs = 100000;
+const int kMaxFrames = 64;
+
+// The backtrace captured by the signal handler. There is only ever one
+// watchdog, and one capture at a time.
+struct BacktraceCapture {
+  void *frames[kMaxFrames];
+  int frame_count;
+  std::atomic<bool> done;
+};
+BacktraceCapture capture;
+
+// The signal used to interrupt the platform thread. Real-time signals aren't
+// used by the engine, the Dart VM (which uses SIGPROF), or GTK.
+int CaptureSignal() { return SIGRTMIN; }
+
+void CaptureBacktrace(int signal_number) {
+  int saved_errno = errno;
+  capture.frame_count = backtrace(capture.frames, kMaxFrames);
+  capture.done.store(true);
+  errno = saved_errno;
+}
+
+// Parses a threshold in milliseconds, falling back to the default for
+// anything other than a positive number.
+int64_t ParseThresholdMs(const char *value) {
+  char *end = nullptr;
+  long long threshold = strtoll(value, &end, 10);
+  return end != value && *end == '\0' && threshold > 0 ? threshold
+                                                        : kDefaultThresholdMs;
+}
+
+// Returns the lower bound, in milliseconds, of histogram bucket |bucket|.
+int64_t BucketStartMs(size_t bucket) {
+  return bucket == 0 ? 0 : int64_t{1} << (bucket - 1);
+}
+
+}  // namespace
+
+constexpr size_t StallWatchdog::kBucketCount;
+
+StallWatchdog::StallWatchdog(int argc, char **argv,
+                             std::chrono::milliseconds heartbeat_interval) {
+  int64_t threshold_ms = kDefaultThresholdMs;
+  const char *enable = getenv(kEnableEnvironmentVariable);
+  if (enable && enable[0] != '\0') {
+    enabled_ = true;
+    threshold_ms = ParseThresholdMs(enable);
+  }
+  size_t argument_length = strlen(kEnableArgument);
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], kEnableArgument, argument_length) != 0) {
+      continue;
+    }
+    if (argv[i][argument_length] == '\0') {
+      enabled_ = true;
+    } else if (argv[i][argument_length] == '=') {
+      enabled_ = true;
+      threshold_ms = ParseThresholdMs(argv[i] + argument_length + 1);
+    }
+  }
+  if (!enabled_) {
+    return;
+  }
+  // Every idle iteration takes up to the heartbeat interval, so a lower
+  // threshold would report idleness as stalls.
+  threshold_ms =
+      std::max<int64_t>(threshold_ms, 2 * heartbeat_interval.count());
+  threshold_us_ = threshold_ms * 1000;
+
+  const char *log_path = getenv(kLogEnvironmentVariable);
+  if (log_path && log_path[0] != '\0') {
+    log_fd_ = open(log_path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (log_fd_ < 0) {
+      std::cerr << "Unable to open stall log " << log_path << ": "
+                << strerror(errno) << std::endl;
+    }
+  }
+  if (log_fd_ < 0) {
+    log_fd_ = dup(STDERR_FILENO);
+  }
+  AddMessageObserver(this);
+}
+
+StallWatchdog::~StallWatchdog() {
+  if (!enabled_) {
+    return;
+  }
+  RemoveMessageObserver(this);
+  if (thread_.joinable()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    stop_condition_.notify_one();
+    thread_.join();
+    WriteSummary();
+  }
+  close(log_fd_);
+}
+
+void StallWatchdog::Start() {
+  if (!enabled_ || thread_.joinable()) {
+    return;
+  }
+  // backtrace() loads libgcc on first use, which isn't safe in a signal
+  // handler, so make sure that has already happened.
+  void *frame;
+  backtrace(&frame, 1);
+  struct sigaction action = {};
+  action.sa_handler = CaptureBacktrace;
+  action.sa_flags = SA_RESTART;
+  sigemptyset(&action.sa_mask);
+  sigaction(CaptureSignal(), &action, nullptr);
+
+  platform_thread_ = pthread_self();
+  last_heartbeat_ = StartupTracer::Now();
+  thread_ = std::thread([this] { Watch(); });
+}
+
+void StallWatchdog::Heartbeat() {
+  if (!thread_.joinable()) {
+    return;
+  }
+  int64_t now = StartupTracer::Now();
+  last_heartbeat_ = now;
+  if (busy_since_ == 0) {
+    ++idle_iteration_count_;
+    return;
+  }
+  int64_t duration = now - busy_since_;
+  busy_since_ = 0;
+  size_t bucket = 0;
+  while (bucket + 1 < kBucketCount &&
+         duration >= BucketStartMs(bucket + 1) * 1000) {
+    ++bucket;
+  }
+  ++histogram_[bucket];
+  if (duration >= threshold_us_) {
+    ++stall_count_;
+    longest_stall_us_ = std::max(longest_stall_us_, duration);
+    dprintf(log_fd_, "Platform thread stall ended after %lld ms\n",
+            static_cast<long long>(duration / 1000));
+  }
+}
+
+void StallWatchdog::WillHandleMessage(const FlutterDesktopMessage &message) {
+  MarkBusy();
+}
+
+void StallWatchdog::DidSendMessage(const char *channel, const uint8_t *message,
+                                   size_t message_size) {
+  MarkBusy();
+}
+
+void StallWatchdog::MarkBusy() {
+  if (thread_.joinable() && busy_since_ == 0) {
+    busy_since_ = StartupTracer::Now();
+  }
+}
+
+void StallWatchdog::Watch() {
+  // Check often enough that a stall is caught soon after the threshold.
+  auto check_interval = std::chrono::microseconds(threshold_us_ / 4);
+  int64_t reported_heartbeat = 0;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!stop_condition_.wait_for(lock, check_interval,
+                                   [this] { return stopping_; })) {
+    int64_t heartbeat = last_heartbeat_;
+    int64_t stalled_for = StartupTracer::Now() - heartbeat;
+    // Report each stall once, while it is happening.
+    if (stalled_for >= threshold_us_ && heartbeat != reported_heartbeat) {
+      reported_heartbeat = heartbeat;
+      ReportStall(stalled_for);
+    }
+  }
+}
+
+void StallWatchdog::ReportStall(int64_t stalled_for_us) {
+  dprintf(log_fd_,
+          "Platform thread stalled: no event loop heartbeat for %lld ms. "
+          "Backtrace:\n",
+          static_cast<long long>(stalled_for_us / 1000));
+  capture.done = false;
+  if (pthread_kill(platform_thread_, CaptureSignal()) != 0) {
+    return;
+  }
+  int64_t deadline = StartupTracer::Now() + kCaptureTimeoutUs;
+  while (!capture.done && StartupTracer::Now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  if (!capture.done) {
+    // The thread is blocked with the signal masked, or in the kernel
+    // without interruption.
+    dprintf(log_fd_, "  (platform thread did not respond)\n");
+    return;
+  }
+  backtrace_symbols_fd(capture.frames, capture.frame_count, log_fd_);
+}
+
+void StallWatchdog::WriteSummary() {
+  uint64_t iterations = 0;
+  for (uint64_t count : histogram_) {
+    iterations += count;
+  }
+  dprintf(log_fd_,
+          "Event loop busy durations (%llu busy iterations; %llu idle "
+          "iterations without messages):\n",
+          static_cast<unsigned long long>(iterations),
+          static_cast<unsigned long long>(idle_iteration_count_));
+  for (size_t bucket = 0; bucket < kBucketCount; ++bucket) {
+    if (histogram_[bucket] == 0) {
+      continue;
+    }
+    if (bucket + 1 < kBucketCount) {
+      dprintf(log_fd_, "  %5lld - %5lld ms: %llu\n",
+              static_cast<long long>(BucketStartMs(bucket)),
+              static_cast<long long>(BucketStartMs(bucket + 1)),
+              static_cast<unsigned long long>(histogram_[bucket]));
+    } else {
+      dprintf(log_fd_, "  %5lld+         ms: %llu\n",
+              static_cast<long long>(BucketStartMs(bucket)),
+              static_cast<unsigned long long>(histogram_[bucket]));
+    }
+  }
+  dprintf(log_fd_, "Stalls over %lld ms: %llu (longest %lld ms)\n",
+          static_cast<long long>(threshold_us_ / 1000),
+          static_cast<unsigned long long>(stall_count_),
+          static_cast<long long>(longest_stall_us_ / 1000));
+}
+
+}  // namespace runner
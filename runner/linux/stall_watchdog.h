@@ -0,0 +1,125 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_STALL_WATCHDOG_H_
+#define RUNNER_LINUX_STALL_WATCHDOG_H_
+
+#include <pthread.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include "runner/linux/messenger_interposer.h"
+
+namespace runner {
+
+// Detects stalls of the platform thread, such as a plugin running a modal
+// GTK dialog or other synchronous work inside a message handler, and logs
+// the thread's native backtrace while it is stalled.
+//
+// The watchdog is enabled by passing --stall-watchdog[=<threshold ms>] to the
+// runner, or by setting FLUTTER_STALL_WATCHDOG (to a threshold, or to any
+// other value for the default). Reports are written to the file named by
+// FLUTTER_STALL_LOG, or to stderr.
+//
+// The runner's event loop calls Heartbeat() after each iteration. When the
+// heartbeat hasn't advanced for the threshold, a watchdog thread interrupts
+// the platform thread with a signal to capture its backtrace. When the
+// watchdog is destroyed, it logs a histogram of how long the platform thread
+// was busy in each iteration: from the first channel message handled or sent
+// in it, which is when the event loop's wait ended, to the heartbeat.
+// Iterations with no messages only waited, usually until the wake
+// interval ended, and are counted separately, so that idle waits don't look
+// like stalls. Messages are observed through the messenger interposer, and
+// backtraces are only symbolized for exported symbols, so the runner should
+// be linked with -rdynamic.
+class StallWatchdog : public MessageObserver {
+ public:
+  // Configures the watchdog from the environment and |argv|. The event loop
+  // must wake at least every |heartbeat_interval| while the watchdog is
+  // enabled; the threshold is raised to at least twice that. Must be
+  // constructed before any channel handlers are installed, so that their
+  // messages are observed.
+  StallWatchdog(int argc, char **argv,
+                std::chrono::milliseconds heartbeat_interval);
+  ~StallWatchdog() override;
+
+  // Prevent copying.
+  StallWatchdog(StallWatchdog const &) = delete;
+  StallWatchdog &operator=(StallWatchdog const &) = delete;
+
+  bool enabled() const { return enabled_; }
+
+  // Starts watching the calling thread, which must be the platform thread.
+  void Start();
+
+  // Records that the event loop completed an iteration. Must be called on
+  // the platform thread.
+  void Heartbeat();
+
+  // MessageObserver:
+  void WillHandleMessage(const FlutterDesktopMessage &message) override;
+  void DidHandleMessage(const FlutterDesktopMessage &message) override {}
+  void DidSendResponse(const FlutterDesktopMessageResponseHandle *handle,
+                       const uint8_t *response,
+                       size_t response_size) override {}
+  void DidSendMessage(const char *channel, const uint8_t *message,
+                      size_t message_size) override;
+
+ private:
+  // Records that the platform thread is busy, if this is the first sign of
+  // work in the current iteration.
+  void MarkBusy();
+
+  // Busy durations are counted in power-of-two millisecond buckets:
+  // [0, 1), [1, 2), [2, 4), ..., with the last bucket open-ended.
+  static constexpr size_t kBucketCount = 13;
+
+  // Checks the heartbeat until stopped. Runs on |thread_|.
+  void Watch();
+
+  // Logs the platform thread's backtrace, for a stall of |stalled_for_us|
+  // so far.
+  void ReportStall(int64_t stalled_for_us);
+
+  // Logs the busy duration histogram.
+  void WriteSummary();
+
+  bool enabled_ = false;
+  int64_t threshold_us_ = 0;
+  int log_fd_ = -1;
+
+  pthread_t platform_thread_;
+  std::atomic<int64_t> last_heartbeat_{0};
+  std::thread thread_;
+  std::mutex mutex_;
+  std::condition_variable stop_condition_;
+  bool stopping_ = false;
+
+  // Only accessed on the platform thread. |busy_since_| is when the current
+  // iteration's first message was seen, or 0 if there hasn't been one.
+  int64_t busy_since_ = 0;
+  std::array<uint64_t, kBucketCount> histogram_ = {};
+  uint64_t idle_iteration_count_ = 0;
+  uint64_t stall_count_ = 0;
+  int64_t longest_stall_us_ = 0;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_STALL_WATCHDOG_H_
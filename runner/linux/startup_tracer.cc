@@ -0,0 +1,328 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/startup_tracer.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+#include <flutter/method_channel.h>
+#include <flutter/plugin_registrar.h>
+#include <flutter/standard_method_codec.h>
+
+#include "runner/linux/zygote.h"
+
+namespace runner {
+
+namespace {
+
+using flutter::EncodableValue;
+
+const char kTraceEnvironmentVariable[] = "FLUTTER_STARTUP_TRACE";
+const char kTraceArgumentPrefix[] = "--startup-trace=";
+
+// See startup_trace.dart for documentation.
+const char kChannelName[] = "flutter/startuptrace";
+const char kFirstFrameMethod[] = "FirstFrameRasterized";
+const char kFrameTimingSummaryMethod[] = "FrameTimingSummary";
+const size_t kFrameTimingSummarySize = 5;
+// The metadata keys for the values of a frame timing summary, in order.
+const char *kFrameTimingSummaryKeys[kFrameTimingSummarySize] = {
+    "steady_state_frame_count", "build_median_us",  "build_p90_us",
+    "raster_median_us",         "raster_p90_us",
+};
+
+// Returns the time, in microseconds on the monotonic clock, at which this
+// process was started, or 0 if it can't be determined.
+//
+// /proc/self/stat reports the start time in clock ticks since boot, which
+// includes time spent suspended, so it is converted using the current offset
+// between CLOCK_BOOTTIME and CLOCK_MONOTONIC.
+int64_t GetProcessStartTime() {
+  std::ifstream stat_file("/proc/self/stat");
+  std::string stat;
+  std::getline(stat_file, stat);
+  // The executable name (field 2) may contain spaces, so start parsing after
+  // its closing parenthesis. The start time is field 22.
+  size_t name_end = stat.rfind(')');
+  if (name_end == std::string::npos) {
+    return 0;
+  }
+  std::istringstream fields(stat.substr(name_end + 2));
+  std::string field;
+  for (int i = 3; i < 22; ++i) {
+    fields >> field;
+  }
+  unsigned long long start_ticks = 0;
+  if (!(fields >> start_ticks)) {
+    return 0;
+  }
+  long ticks_per_second = sysconf(_SC_CLK_TCK);
+  struct timespec boot_time = {};
+  clock_gettime(CLOCK_BOOTTIME, &boot_time);
+  int64_t boot_offset =
+      (static_cast<int64_t>(boot_time.tv_sec) * 1000000 +
+       boot_time.tv_nsec / 1000) -
+      StartupTracer::Now();
+  return static_cast<int64_t>(start_ticks) * 1000000 / ticks_per_second -
+         boot_offset;
+}
+
+// Writes |value| as a JSON string literal.
+void WriteJsonString(std::ostream &out, const std::string &value) {
+  out << '"';
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << ' ';
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+}  // namespace
+
+// Receives frame timing reports from Dart. Owned by the tracer's registrar.
+class FrameTimingListener : public flutter::Plugin {
+ public:
+  using Callback = std::function<void(const std::vector<int64_t> &)>;
+
+  FrameTimingListener(flutter::PluginRegistrar *registrar,
+                      Callback first_frame_callback,
+                      Callback summary_callback)
+      : channel_(std::make_unique<flutter::MethodChannel<EncodableValue>>(
+            registrar->messenger(), kChannelName,
+            &flutter::StandardMethodCodec::GetInstance())),
+        first_frame_callback_(std::move(first_frame_callback)),
+        summary_callback_(std::move(summary_callback)) {
+    channel_->SetMethodCallHandler([this](const auto &call, auto result) {
+      HandleMethodCall(call, std::move(result));
+    });
+  }
+
+  virtual ~FrameTimingListener() {}
+
+ private:
+  // Called when a method is called on |channel_|;
+  void HandleMethodCall(
+      const flutter::MethodCall<EncodableValue> &method_call,
+      std::unique_ptr<flutter::MethodResult<EncodableValue>> result) {
+    const Callback *callback;
+    size_t expected_size;
+    if (method_call.method_name().compare(kFirstFrameMethod) == 0) {
+      callback = &first_frame_callback_;
+      expected_size = 4;
+    } else if (method_call.method_name().compare(kFrameTimingSummaryMethod) ==
+               0) {
+      callback = &summary_callback_;
+      expected_size = kFrameTimingSummarySize;
+    } else {
+      result->NotImplemented();
+      return;
+    }
+    if (!method_call.arguments() || !method_call.arguments()->IsList() ||
+        method_call.arguments()->ListValue().size() != expected_size) {
+      result->Error("Bad arguments", "Expected " +
+                                         std::to_string(expected_size) +
+                                         "-element list");
+      return;
+    }
+    std::vector<int64_t> values;
+    for (const auto &value : method_call.arguments()->ListValue()) {
+      values.push_back(value.LongValue());
+    }
+    result->Success();
+    (*callback)(values);
+  }
+
+  // The MethodChannel used for communication with the Flutter engine.
+  std::unique_ptr<flutter::MethodChannel<EncodableValue>> channel_;
+
+  Callback first_frame_callback_;
+  Callback summary_callback_;
+};
+
+StartupTracer::StartupTracer(int argc, char **argv) {
+  const char *path = getenv(kTraceEnvironmentVariable);
+  if (path && path[0] != '\0') {
+    output_path_ = path;
+  }
+  size_t prefix_length = strlen(kTraceArgumentPrefix);
+  for (int i = 1; i < argc; ++i) {
+    if (strncmp(argv[i], kTraceArgumentPrefix, prefix_length) == 0) {
+      output_path_ = argv[i] + prefix_length;
+    }
+  }
+  enabled_ = !output_path_.empty();
+  if (!enabled_) {
+    return;
+  }
+  int64_t now = Now();
+  int64_t process_start = GetProcessStartTime();
+  // A process forked by a zygote started when its launcher did.
+  const char *launch_start = getenv(kLaunchStartEnvironmentVariable);
+  if (launch_start) {
+    process_start = strtoll(launch_start, nullptr, 10);
+    SetMetadata("launch", "zygote");
+  }
+  if (process_start > 0 && process_start < now) {
+    // Covers exec, dynamic loading and relocation of the Flutter library and
+    // any plugins, and static initializers; or, for a zygote launch, the
+    // handoff to the zygote and the fork.
+    AddPhase("ProcessStartToMain", process_start, now);
+  }
+}
+
+StartupTracer::~StartupTracer() {
+  if (enabled_) {
+    WriteTraceFile();
+  }
+}
+
+// static
+int64_t StartupTracer::Now() {
+  struct timespec now = {};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+void StartupTracer::AddPhase(const std::string &name, int64_t start,
+                             int64_t end) {
+  if (!enabled_) {
+    return;
+  }
+  AddEvent(name, 'X', Track::kRunner, start, end - start);
+}
+
+void StartupTracer::AddInstantEvent(const std::string &name,
+                                    int64_t timestamp) {
+  if (!enabled_) {
+    return;
+  }
+  AddEvent(name, 'i', Track::kRunner, timestamp, 0);
+}
+
+void StartupTracer::SetMetadata(const std::string &key,
+                                const std::string &value) {
+  if (!enabled_) {
+    return;
+  }
+  metadata_[key] = value;
+}
+
+void StartupTracer::ListenForFrameTimings(
+    FlutterDesktopPluginRegistrarRef registrar) {
+  if (!enabled_ || registrar_) {
+    return;
+  }
+  registrar_ = std::make_unique<flutter::PluginRegistrar>(registrar);
+  registrar_->AddPlugin(std::make_unique<FrameTimingListener>(
+      registrar_.get(),
+      [this](const std::vector<int64_t> &timestamps) {
+        OnFirstFrame(timestamps[0], timestamps[1], timestamps[2],
+                     timestamps[3]);
+      },
+      [this](const std::vector<int64_t> &values) {
+        OnFrameTimingSummary(values);
+      }));
+}
+
+void StartupTracer::WriteTraceFile() {
+  if (!enabled_) {
+    return;
+  }
+  std::ofstream out(output_path_, std::ios::trunc);
+  if (!out) {
+    std::cerr << "Unable to write startup trace to " << output_path_
+              << std::endl;
+    return;
+  }
+  long pid = getpid();
+  const struct {
+    Track track;
+    const char *name;
+  } track_names[] = {
+      {Track::kRunner, "Runner"},
+      {Track::kUI, "UI (first frame)"},
+      {Track::kRaster, "Raster (first frame)"},
+  };
+  out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  for (const auto &track : track_names) {
+    out << (first ? "" : ",") << "{\"ph\":\"M\",\"name\":\"thread_name\""
+        << ",\"pid\":" << pid << ",\"tid\":" << static_cast<int>(track.track)
+        << ",\"args\":{\"name\":\"" << track.name << "\"}}";
+    first = false;
+  }
+  for (const TraceEvent &event : events_) {
+    out << ",{\"cat\":\"startup\",\"name\":";
+    WriteJsonString(out, event.name);
+    out << ",\"ph\":\"" << event.phase << "\",\"pid\":" << pid
+        << ",\"tid\":" << static_cast<int>(event.track)
+        << ",\"ts\":" << event.timestamp;
+    if (event.phase == 'X') {
+      out << ",\"dur\":" << event.duration;
+    } else {
+      out << ",\"s\":\"p\"";
+    }
+    out << "}";
+  }
+  out << "],\"metadata\":{";
+  first = true;
+  for (const auto &entry : metadata_) {
+    out << (first ? "" : ",");
+    WriteJsonString(out, entry.first);
+    out << ":";
+    WriteJsonString(out, entry.second);
+    first = false;
+  }
+  out << "}}" << std::endl;
+}
+
+void StartupTracer::AddEvent(const std::string &name, char phase, Track track,
+                             int64_t timestamp, int64_t duration) {
+  events_.push_back({name, phase, track, timestamp, duration});
+}
+
+void StartupTracer::OnFirstFrame(int64_t build_start, int64_t build_finish,
+                                 int64_t raster_start, int64_t raster_finish) {
+  if (first_frame_recorded_) {
+    return;
+  }
+  first_frame_recorded_ = true;
+  AddEvent("FirstFrame.Build", 'X', Track::kUI, build_start,
+           build_finish - build_start);
+  AddEvent("FirstFrame.Raster", 'X', Track::kRaster, raster_start,
+           raster_finish - raster_start);
+  AddInstantEvent("FirstFrameRasterized", raster_finish);
+  WriteTraceFile();
+}
+
+void StartupTracer::OnFrameTimingSummary(const std::vector<int64_t> &values) {
+  for (size_t i = 0; i < kFrameTimingSummarySize; ++i) {
+    metadata_[kFrameTimingSummaryKeys[i]] = std::to_string(values[i]);
+  }
+  WriteTraceFile();
+}
+
+}  // namespace runner
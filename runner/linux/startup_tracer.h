@@ -0,0 +1,131 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_STARTUP_TRACER_H_
+#define RUNNER_LINUX_STARTUP_TRACER_H_
+
+#include <flutter_plugin_registrar.h>
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace flutter {
+class PluginRegistrar;
+}
+
+namespace runner {
+
+// Records the phases of application startup and writes them as a Chrome
+// trace_event JSON file, which can be loaded in about:tracing or Perfetto.
+//
+// Tracing is enabled by setting FLUTTER_STARTUP_TRACE to an output path, or
+// by passing --startup-trace=<path> to the runner. When disabled, every
+// recording method returns immediately without allocating.
+class StartupTracer {
+ public:
+  // Configures the tracer from the environment and |argv|.
+  StartupTracer(int argc, char **argv);
+  ~StartupTracer();
+
+  // Prevent copying.
+  StartupTracer(StartupTracer const &) = delete;
+  StartupTracer &operator=(StartupTracer const &) = delete;
+
+  // Returns the current time in microseconds on the monotonic clock used for
+  // all trace timestamps. This is the same clock used by the engine for
+  // FrameTiming, so timestamps reported from Dart can be recorded directly.
+  static int64_t Now();
+
+  bool enabled() const { return enabled_; }
+
+  // Records a phase that started at |start| and ended at |end|.
+  void AddPhase(const std::string &name, int64_t start, int64_t end);
+
+  // Records a single point in time.
+  void AddInstantEvent(const std::string &name, int64_t timestamp);
+
+  // Records a key/value pair describing the run (for example, whether the
+  // application was AOT-compiled), written to the trace's metadata.
+  void SetMetadata(const std::string &key, const std::string &value);
+
+  // Listens on the startup trace channel for frame timings reported by the
+  // Dart side of the application: the first rasterized frame, which is added
+  // to the trace, and a summary of the steady-state frames that follow it,
+  // which is added to the metadata. The trace file is written after each.
+  void ListenForFrameTimings(FlutterDesktopPluginRegistrarRef registrar);
+
+  // Writes all recorded events to the output file. Called automatically on
+  // destruction, so that a trace is produced even if no first frame is ever
+  // reported.
+  void WriteTraceFile();
+
+  // Records the time from construction to destruction as a phase.
+  class ScopedPhase {
+   public:
+    ScopedPhase(StartupTracer *tracer, const char *name)
+        : tracer_(tracer),
+          name_(name),
+          start_(tracer->enabled() ? Now() : 0) {}
+    ~ScopedPhase() {
+      if (tracer_->enabled()) {
+        tracer_->AddPhase(name_, start_, Now());
+      }
+    }
+
+   private:
+    StartupTracer *tracer_;
+    const char *name_;
+    int64_t start_;
+  };
+
+ private:
+  // The thread a trace event is shown on.
+  enum class Track { kRunner, kUI, kRaster };
+
+  struct TraceEvent {
+    std::string name;
+    // 'X' for phases with a duration, 'i' for instant events.
+    char phase;
+    Track track;
+    int64_t timestamp;
+    int64_t duration;
+  };
+
+  // Adds a phase on the given track.
+  void AddEvent(const std::string &name, char phase, Track track,
+                int64_t timestamp, int64_t duration);
+
+  // Handles the report of the first frame's FrameTiming values.
+  void OnFirstFrame(int64_t build_start, int64_t build_finish,
+                    int64_t raster_start, int64_t raster_finish);
+
+  // Handles the report of the steady-state frame timing summary; see
+  // startup_trace.dart for the values.
+  void OnFrameTimingSummary(const std::vector<int64_t> &values);
+
+  bool enabled_ = false;
+  std::string output_path_;
+  std::vector<TraceEvent> events_;
+  std::map<std::string, std::string> metadata_;
+  bool first_frame_recorded_ = false;
+
+  // The registrar owning the frame timing channel, if listening.
+  std::unique_ptr<flutter::PluginRegistrar> registrar_;
+};
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_STARTUP_TRACER_H_
@@ -0,0 +1,226 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/unix_socket.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace runner {
+
+namespace {
+
+// Limits on what a connecting process may send, so that a misbehaving client
+// can't exhaust memory.
+const uint32_t kMaxStrings = 4096;
+const uint32_t kMaxStringLength = 64 * 1024;
+// The most file descriptors that can be passed in one message.
+const size_t kMaxFileDescriptors = 8;
+
+// Fills |address| with the abstract socket address for |name|, returning the
+// address length to use.
+socklen_t MakeAddress(const std::string &name, struct sockaddr_un *address) {
+  memset(address, 0, sizeof(*address));
+  address->sun_family = AF_UNIX;
+  // Abstract socket names start with a NUL byte, and aren't NUL-terminated.
+  size_t length = std::min(name.size(), sizeof(address->sun_path) - 1);
+  memcpy(address->sun_path + 1, name.data(), length);
+  return offsetof(struct sockaddr_un, sun_path) + 1 + length;
+}
+
+}  // namespace
+
+int ListenOnAbstractSocket(const std::string &name) {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  struct sockaddr_un address;
+  socklen_t address_length = MakeAddress(name, &address);
+  if (bind(fd, reinterpret_cast<struct sockaddr *>(&address),
+           address_length) != 0 ||
+      listen(fd, SOMAXCONN) != 0) {
+    int error = errno;
+    close(fd);
+    errno = error;
+    return -1;
+  }
+  return fd;
+}
+
+int ConnectToAbstractSocket(const std::string &name) {
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) {
+    return -1;
+  }
+  struct sockaddr_un address;
+  socklen_t address_length = MakeAddress(name, &address);
+  if (connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+              address_length) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+void SetSocketTimeout(int fd, int seconds) {
+  struct timeval timeout = {seconds, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+  setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+bool IsPeerSameUser(int fd) {
+  struct ucred credentials = {};
+  socklen_t credentials_length = sizeof(credentials);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials,
+                    &credentials_length) == 0 &&
+         credentials.uid == getuid();
+}
+
+bool ReadFully(int fd, void *buffer, size_t size) {
+  auto *bytes = static_cast<char *>(buffer);
+  while (size > 0) {
+    ssize_t count = read(fd, bytes, size);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    bytes += count;
+    size -= count;
+  }
+  return true;
+}
+
+bool WriteFully(int fd, const void *buffer, size_t size) {
+  auto *bytes = static_cast<const char *>(buffer);
+  while (size > 0) {
+    ssize_t count = send(fd, bytes, size, MSG_NOSIGNAL);
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      return false;
+    }
+    bytes += count;
+    size -= count;
+  }
+  return true;
+}
+
+bool WriteStrings(int fd, const std::vector<std::string> &strings) {
+  uint32_t count = strings.size();
+  if (!WriteFully(fd, &count, sizeof(count))) {
+    return false;
+  }
+  for (const std::string &string : strings) {
+    uint32_t length = string.size();
+    if (!WriteFully(fd, &length, sizeof(length)) ||
+        !WriteFully(fd, string.data(), length)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ReadStrings(int fd, std::vector<std::string> *strings) {
+  uint32_t count = 0;
+  if (!ReadFully(fd, &count, sizeof(count)) || count > kMaxStrings) {
+    return false;
+  }
+  for (uint32_t i = 0; i < count; ++i) {
+    uint32_t length = 0;
+    if (!ReadFully(fd, &length, sizeof(length)) || length > kMaxStringLength) {
+      return false;
+    }
+    std::string string(length, '\0');
+    if (length > 0 && !ReadFully(fd, &string[0], length)) {
+      return false;
+    }
+    strings->push_back(std::move(string));
+  }
+  return true;
+}
+
+bool SendFileDescriptors(int fd, const std::vector<int> &fds) {
+  if (fds.empty() || fds.size() > kMaxFileDescriptors) {
+    return false;
+  }
+  // At least one byte of data must accompany the descriptors.
+  char byte = 0;
+  struct iovec data = {&byte, sizeof(byte)};
+  char control[CMSG_SPACE(sizeof(int) * kMaxFileDescriptors)] = {};
+  struct msghdr message = {};
+  message.msg_iov = &data;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = CMSG_SPACE(sizeof(int) * fds.size());
+  struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+  header->cmsg_level = SOL_SOCKET;
+  header->cmsg_type = SCM_RIGHTS;
+  header->cmsg_len = CMSG_LEN(sizeof(int) * fds.size());
+  memcpy(CMSG_DATA(header), fds.data(), sizeof(int) * fds.size());
+  ssize_t sent;
+  do {
+    sent = sendmsg(fd, &message, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  return sent == 1;
+}
+
+bool ReceiveFileDescriptors(int fd, size_t count, std::vector<int> *fds) {
+  if (count == 0 || count > kMaxFileDescriptors) {
+    return false;
+  }
+  char byte = 0;
+  struct iovec data = {&byte, sizeof(byte)};
+  char control[CMSG_SPACE(sizeof(int) * kMaxFileDescriptors)] = {};
+  struct msghdr message = {};
+  message.msg_iov = &data;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  ssize_t received;
+  do {
+    received = recvmsg(fd, &message, MSG_CMSG_CLOEXEC);
+  } while (received < 0 && errno == EINTR);
+  if (received != 1) {
+    return false;
+  }
+  struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+  if (!header || header->cmsg_level != SOL_SOCKET ||
+      header->cmsg_type != SCM_RIGHTS) {
+    return false;
+  }
+  size_t received_count = (header->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+  std::vector<int> received_fds(received_count);
+  memcpy(received_fds.data(), CMSG_DATA(header), sizeof(int) * received_count);
+  if (received_count != count) {
+    for (int received_fd : received_fds) {
+      close(received_fd);
+    }
+    return false;
+  }
+  fds->insert(fds->end(), received_fds.begin(), received_fds.end());
+  return true;
+}
+
+}  // namespace runner
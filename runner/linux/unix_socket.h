@@ -0,0 +1,69 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_UNIX_SOCKET_H_
+#define RUNNER_LINUX_UNIX_SOCKET_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Helpers for the local sockets used by the runners to talk to other
+// processes of the same application (see single_instance.h and zygote.h).
+//
+// Sockets are stream sockets in the Linux abstract namespace, so they need no
+// file system cleanup. Since that namespace is shared by all users, names
+// should include the user ID, and servers should check IsPeerSameUser.
+//
+// This file has no Flutter dependencies, so that it can be used by the zygote
+// launcher.
+
+namespace runner {
+
+// Returns a socket listening on the abstract address |name|, or -1 on failure
+// with errno set (EADDRINUSE if another process is listening).
+int ListenOnAbstractSocket(const std::string &name);
+
+// Returns a socket connected to the abstract address |name|, or -1 if nothing
+// is listening.
+int ConnectToAbstractSocket(const std::string &name);
+
+// Sets the send and receive timeouts of |fd|.
+void SetSocketTimeout(int fd, int seconds);
+
+// Returns true if the process on the other end of |fd| belongs to this user.
+bool IsPeerSameUser(int fd);
+
+// Reads exactly |size| bytes from |fd|. Returns false on error or EOF.
+bool ReadFully(int fd, void *buffer, size_t size);
+
+// Writes exactly |size| bytes to |fd|. Returns false on error.
+bool WriteFully(int fd, const void *buffer, size_t size);
+
+// Writes |strings| as a count followed by length-prefixed strings, in host
+// byte order since both ends are on the same machine.
+bool WriteStrings(int fd, const std::vector<std::string> &strings);
+
+// Reads strings written by WriteStrings, appending them to |strings|. Fails
+// if the count or any length exceeds sane limits.
+bool ReadStrings(int fd, std::vector<std::string> *strings);
+
+// Sends |fds| to the other end of the socket |fd|.
+bool SendFileDescriptors(int fd, const std::vector<int> &fds);
+
+// Receives exactly |count| file descriptors sent by SendFileDescriptors.
+bool ReceiveFileDescriptors(int fd, size_t count, std::vector<int> *fds);
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_UNIX_SOCKET_H_
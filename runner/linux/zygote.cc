@@ -0,0 +1,270 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#include "runner/linux/zygote.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include "runner/linux/unix_socket.h"
+
+namespace runner {
+
+const char kLaunchStartEnvironmentVariable[] = "FLUTTER_LAUNCH_START_US";
+
+namespace {
+
+const char kZygoteArgument[] = "--zygote";
+
+// The standard input, output, and error of the launcher.
+const size_t kLaunchFileDescriptorCount = 3;
+// How long to wait for a connected launcher to send its launch request.
+const int kIoTimeoutSeconds = 2;
+
+// A launch request received from the launcher.
+struct LaunchRequest {
+  std::vector<int> fds;
+  std::string working_directory;
+  std::vector<std::string> arguments;
+  std::vector<std::string> environment;
+};
+
+// Reads a launch request from |connection|. On failure, any received file
+// descriptors are closed.
+bool ReadLaunchRequest(int connection, LaunchRequest *request) {
+  if (!ReceiveFileDescriptors(connection, kLaunchFileDescriptorCount,
+                              &request->fds)) {
+    return false;
+  }
+  std::vector<std::string> working_directory;
+  if (ReadStrings(connection, &working_directory) &&
+      working_directory.size() == 1 &&
+      ReadStrings(connection, &request->arguments) &&
+      !request->arguments.empty() &&
+      ReadStrings(connection, &request->environment)) {
+    request->working_directory = working_directory[0];
+    return true;
+  }
+  for (int fd : request->fds) {
+    close(fd);
+  }
+  return false;
+}
+
+// Makes this process look as though it had been started by the launcher that
+// sent |request|, replacing |argc| and |argv|. Called in the forked child.
+void BecomeLaunchedProcess(const LaunchRequest &request, int *argc,
+                           char ***argv) {
+  for (size_t i = 0; i < request.fds.size(); ++i) {
+    // dup2 clears close-on-exec on the new descriptor.
+    dup2(request.fds[i], static_cast<int>(i));
+    close(request.fds[i]);
+  }
+  if (chdir(request.working_directory.c_str()) != 0) {
+    std::cerr << "Unable to change to " << request.working_directory << ": "
+              << strerror(errno) << std::endl;
+  }
+  clearenv();
+  for (const std::string &variable : request.environment) {
+    size_t separator = variable.find('=');
+    if (separator != std::string::npos && separator > 0) {
+      setenv(variable.substr(0, separator).c_str(),
+             variable.c_str() + separator + 1, 1);
+    }
+  }
+
+  // The arguments must outlive main(), so they are intentionally leaked.
+  auto *arguments = new std::vector<std::string>(request.arguments);
+  auto *pointers = new std::vector<char *>();
+  for (std::string &argument : *arguments) {
+    pointers->push_back(&argument[0]);
+  }
+  pointers->push_back(nullptr);
+  *argc = static_cast<int>(arguments->size());
+  *argv = pointers->data();
+}
+
+}  // namespace
+
+std::string GetZygoteSocketName(const std::string &application_id) {
+  // Abstract sockets are shared by all users in the network namespace, so
+  // the name includes the user, and connections are checked on accept.
+  return "flutter-zygote/" + application_id + "/" + std::to_string(getuid());
+}
+
+bool RunZygoteIfRequested(const std::string &application_id,
+                          const std::function<void()> &preload, int *argc,
+                          char ***argv) {
+  bool requested = false;
+  for (int i = 1; i < *argc; ++i) {
+    if (strcmp((*argv)[i], kZygoteArgument) == 0) {
+      requested = true;
+    }
+  }
+  if (!requested) {
+    return true;
+  }
+
+  int listen_socket =
+      ListenOnAbstractSocket(GetZygoteSocketName(application_id));
+  if (listen_socket < 0) {
+    std::cerr << "Unable to start zygote: " << strerror(errno) << std::endl;
+    return false;
+  }
+
+  preload();
+
+  // Signals are handled synchronously in the poll loop. The original mask is
+  // restored in each launched process.
+  sigset_t handled_signals, original_signals;
+  sigemptyset(&handled_signals);
+  sigaddset(&handled_signals, SIGCHLD);
+  sigaddset(&handled_signals, SIGTERM);
+  sigaddset(&handled_signals, SIGINT);
+  sigprocmask(SIG_BLOCK, &handled_signals, &original_signals);
+  int signal_fd = signalfd(-1, &handled_signals, SFD_CLOEXEC);
+  if (signal_fd < 0) {
+    std::cerr << "Unable to start zygote: " << strerror(errno) << std::endl;
+    close(listen_socket);
+    return false;
+  }
+  std::cerr << "Zygote ready for " << application_id << std::endl;
+
+  // The connection to the launcher of each running launched process.
+  std::map<pid_t, int> connections;
+  while (true) {
+    std::vector<struct pollfd> poll_fds = {{listen_socket, POLLIN, 0},
+                                           {signal_fd, POLLIN, 0}};
+    std::vector<pid_t> poll_pids;
+    for (const auto &entry : connections) {
+      poll_fds.push_back({entry.second, POLLIN, 0});
+      poll_pids.push_back(entry.first);
+    }
+    if (poll(poll_fds.data(), poll_fds.size(), -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "Zygote failed: " << strerror(errno) << std::endl;
+      break;
+    }
+
+    if (poll_fds[1].revents & POLLIN) {
+      struct signalfd_siginfo info;
+      if (!ReadFully(signal_fd, &info, sizeof(info))) {
+        continue;
+      }
+      if (info.ssi_signo != SIGCHLD) {
+        break;
+      }
+      // SIGCHLD may stand for several exits, so reap them all.
+      int status;
+      pid_t pid;
+      while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        auto connection = connections.find(pid);
+        if (connection == connections.end()) {
+          continue;
+        }
+        int32_t reported_status = status;
+        WriteFully(connection->second, &reported_status,
+                   sizeof(reported_status));
+        close(connection->second);
+        connections.erase(connection);
+      }
+      // The set of connections may have changed.
+      continue;
+    }
+
+    for (size_t i = 0; i < poll_pids.size(); ++i) {
+      if (!poll_fds[i + 2].revents) {
+        continue;
+      }
+      pid_t pid = poll_pids[i];
+      int32_t signal_number = 0;
+      if (ReadFully(connections[pid], &signal_number, sizeof(signal_number))) {
+        if (signal_number > 0 && signal_number < NSIG) {
+          kill(pid, signal_number);
+        }
+      } else {
+        // The launcher is gone, so there's no one to report the exit to.
+        kill(pid, SIGHUP);
+        close(connections[pid]);
+        connections.erase(pid);
+      }
+    }
+
+    if (!(poll_fds[0].revents & POLLIN)) {
+      continue;
+    }
+    int connection = accept4(listen_socket, nullptr, nullptr, SOCK_CLOEXEC);
+    if (connection < 0) {
+      continue;
+    }
+    // Only accept launches from the same user.
+    if (!IsPeerSameUser(connection)) {
+      close(connection);
+      continue;
+    }
+    SetSocketTimeout(connection, kIoTimeoutSeconds);
+    LaunchRequest request;
+    if (!ReadLaunchRequest(connection, &request)) {
+      close(connection);
+      continue;
+    }
+    // Once launched, the process may run for any length of time.
+    SetSocketTimeout(connection, 0);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+      close(listen_socket);
+      close(signal_fd);
+      close(connection);
+      for (const auto &entry : connections) {
+        close(entry.second);
+      }
+      sigprocmask(SIG_SETMASK, &original_signals, nullptr);
+      BecomeLaunchedProcess(request, argc, argv);
+      return true;
+    }
+    for (int fd : request.fds) {
+      close(fd);
+    }
+    int32_t reported_pid = pid;
+    if (!WriteFully(connection, &reported_pid, sizeof(reported_pid)) ||
+        pid < 0) {
+      close(connection);
+      continue;
+    }
+    connections[pid] = connection;
+  }
+
+  for (const auto &entry : connections) {
+    close(entry.second);
+  }
+  close(signal_fd);
+  close(listen_socket);
+  exit(EXIT_SUCCESS);
+}
+
+}  // namespace runner
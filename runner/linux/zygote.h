@@ -0,0 +1,76 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+#ifndef RUNNER_LINUX_ZYGOTE_H_
+#define RUNNER_LINUX_ZYGOTE_H_
+
+#include <functional>
+#include <string>
+
+// A zygote is a runner process started ahead of time (with --zygote) that
+// does the fork-safe part of startup once: process creation, loading and
+// relocating the Flutter library and plugin libraries, and reading the
+// bundle's startup files into the page cache. It then waits for launch
+// requests from the zygote launcher (zygote_launcher.cc), and forks a copy of
+// itself for each one, which continues through the rest of main() as if it
+// had been started by the launcher: with the launcher's arguments, working
+// directory, environment (and so display session), and standard streams.
+//
+// Creating the window and engine starts threads and connects to the display
+// server, neither of which survives fork, so each launch still creates its
+// own engine; the zygote removes everything before that from the launch.
+//
+// This file has no Flutter dependencies, so that it can be built into the
+// launcher.
+
+namespace runner {
+
+// The environment variable through which the launcher reports when the launch
+// started, in microseconds on the monotonic clock. The startup tracer uses it
+// in place of the process start time, which for a forked launch is the time
+// of the fork.
+extern const char kLaunchStartEnvironmentVariable[];
+
+// The launch protocol, over a connection to the zygote's socket (see
+// unix_socket.h for the encodings):
+//   1. The launcher sends its standard input, output, and error with
+//      SendFileDescriptors, then three lists with WriteStrings: its working
+//      directory, its arguments (including argv[0]), and its environment.
+//   2. The zygote replies with the launched process's pid as an int32_t, or
+//      -1 if the launch failed.
+//   3. The launcher may then send signal numbers as int32_t, which are
+//      forwarded to the launched process. If the launcher disconnects, the
+//      launched process is sent SIGHUP, as if its terminal had closed.
+//   4. When the launched process exits, the zygote sends its wait status as an
+//      int32_t and closes the connection.
+
+// Returns the abstract socket name the zygote for |application_id| listens
+// on.
+std::string GetZygoteSocketName(const std::string &application_id);
+
+// If |argv| contains --zygote, calls |preload|, then serves launch requests
+// until terminated. This function returns only in the forked child for each
+// launch, with |argc| and |argv| replaced by the launcher's.
+//
+// |preload| is called before any fork, so it must not leave threads running
+// or open connections to the display server.
+//
+// Returns true immediately if --zygote is not present, and false if the
+// zygote could not be started (e.g., because one is already running).
+bool RunZygoteIfRequested(const std::string &application_id,
+                          const std::function<void()> &preload, int *argc,
+                          char ***argv);
+
+}  // namespace runner
+
+#endif  // RUNNER_LINUX_ZYGOTE_H_
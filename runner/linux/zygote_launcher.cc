@@ -0,0 +1,134 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A small launcher for a runner that supports zygote mode (see zygote.h).
+//
+// If a zygote for the application is running, the launch is handed to it, and
+// the launcher stays in the foreground until the launched process exits,
+// forwarding signals to it and exiting with its status. Otherwise, the
+// launcher execs the runner binary next to it, so it can always be used in
+// place of the runner.
+//
+// Must be built with RUNNER_APPLICATION_ID, matching the runner's application
+// ID, and RUNNER_BINARY_NAME defined as string literals.
+
+#include <errno.h>
+#include <linux/limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "runner/linux/unix_socket.h"
+#include "runner/linux/zygote.h"
+
+extern char **environ;
+
+namespace {
+
+// The connection to the zygote, used by the signal handler.
+int zygote_connection = -1;
+
+// Forwards signals meant for the application to the zygote.
+void ForwardSignal(int signal_number) {
+  int32_t value = signal_number;
+  // Async-signal-safe; a short write here is not recoverable anyway.
+  send(zygote_connection, &value, sizeof(value), MSG_NOSIGNAL);
+}
+
+// Returns the current time in microseconds on the monotonic clock, matching
+// StartupTracer::Now.
+int64_t Now() {
+  struct timespec now = {};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<int64_t>(now.tv_sec) * 1000000 + now.tv_nsec / 1000;
+}
+
+// Replaces this process with the runner, for when no zygote is running.
+int ExecRunner(char **argv) {
+  char buffer[PATH_MAX + 1];
+  ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer));
+  if (length <= 0 || length > PATH_MAX) {
+    std::cerr << "Couldn't locate executable" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string path(buffer, length);
+  path = path.substr(0, path.find_last_of('/') + 1) + RUNNER_BINARY_NAME;
+  execv(path.c_str(), argv);
+  std::cerr << "Unable to run " << path << ": " << strerror(errno)
+            << std::endl;
+  return EXIT_FAILURE;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  int64_t launch_start = Now();
+
+  zygote_connection = runner::ConnectToAbstractSocket(
+      runner::GetZygoteSocketName(RUNNER_APPLICATION_ID));
+  if (zygote_connection < 0) {
+    return ExecRunner(argv);
+  }
+
+  char working_directory[PATH_MAX];
+  std::vector<std::string> arguments(argv, argv + argc);
+  std::vector<std::string> environment;
+  for (char **variable = environ; *variable; ++variable) {
+    environment.push_back(*variable);
+  }
+  environment.push_back(std::string(runner::kLaunchStartEnvironmentVariable) +
+                        "=" + std::to_string(launch_start));
+  int32_t pid = -1;
+  if (!runner::SendFileDescriptors(zygote_connection,
+                                   {STDIN_FILENO, STDOUT_FILENO,
+                                    STDERR_FILENO}) ||
+      !runner::WriteStrings(zygote_connection,
+                            {getcwd(working_directory,
+                                    sizeof(working_directory))
+                                 ? working_directory
+                                 : "/"}) ||
+      !runner::WriteStrings(zygote_connection, arguments) ||
+      !runner::WriteStrings(zygote_connection, environment) ||
+      !runner::ReadFully(zygote_connection, &pid, sizeof(pid)) || pid < 0) {
+    std::cerr << "Zygote launch failed; starting normally" << std::endl;
+    close(zygote_connection);
+    return ExecRunner(argv);
+  }
+
+  struct sigaction action = {};
+  action.sa_handler = ForwardSignal;
+  sigemptyset(&action.sa_mask);
+  for (int signal_number : {SIGINT, SIGTERM, SIGHUP, SIGQUIT}) {
+    sigaction(signal_number, &action, nullptr);
+  }
+
+  int32_t status = 0;
+  if (!runner::ReadFully(zygote_connection, &status, sizeof(status))) {
+    // The zygote exited; the launched process continues without it.
+    return EXIT_FAILURE;
+  }
+  if (WIFSIGNALED(status)) {
+    return 128 + WTERMSIG(status);
+  }
+  return WEXITSTATUS(status);
+}
@@ -0,0 +1,151 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'dart:async';
+
+import 'package:flutter/services.dart';
+
+/// The name of the channel used by the runner's plugin call tracer, which is
+/// enabled with `--trace-plugin-calls` or `FLUTTER_PLUGIN_CALL_TRACE`.
+const String _diagnosticsChannelName = 'flutter/diagnostics';
+
+/// The method name to fetch the recorded calls.
+///
+/// Returns a list of maps, oldest first, with durations in microseconds:
+///   id: int, increasing by one per call
+///   direction: 'in' for calls from Dart, 'out' for messages from plugins
+///   channel: String
+///   method: String, empty if the message isn't a method call
+///   payloadSize: int, in bytes
+///   start: int, a monotonic timestamp
+///   handlerDuration: int, or null while the handler is running
+///   queueDuration: int, the time from the handler returning to the response
+///       being sent, or null if there has been no response
+///   responseSize: int, in bytes
+const String _getCallRecordsMethod = 'GetCallRecords';
+
+/// The method name to fetch per-method statistics for the recorded calls.
+///
+/// Returns a list of maps, with durations in microseconds:
+///   direction, channel, method: as for [_getCallRecordsMethod]
+///   count: int
+///   handlerP50, handlerP99: int, or absent if no handler has returned
+///   responseP50, responseP99: int, the time from delivery to response, or
+///       absent if there have been no responses
+const String _getCallStatsMethod = 'GetCallStats';
+
+/// The method name to start or stop periodic statistics.
+///
+/// Takes the interval in milliseconds as an int, or 0 to stop.
+const String _setStatsIntervalMethod = 'SetStatsInterval';
+
+/// The method name the runner calls with periodic statistics, in the format
+/// returned by [_getCallStatsMethod].
+const String _callStatsMethod = 'CallStats';
+
+const MethodChannel _channel = MethodChannel(_diagnosticsChannelName);
+
+/// Latency statistics for one method of a plugin channel, over the calls the
+/// runner currently retains.
+class PluginCallStats {
+  PluginCallStats._fromMap(Map<dynamic, dynamic> map)
+      : incoming = map['direction'] == 'in',
+        channel = map['channel'],
+        method = map['method'],
+        count = map['count'],
+        handlerP50 = _microseconds(map['handlerP50']),
+        handlerP99 = _microseconds(map['handlerP99']),
+        responseP50 = _microseconds(map['responseP50']),
+        responseP99 = _microseconds(map['responseP99']);
+
+  /// Whether these are calls from Dart, rather than messages from the plugin.
+  final bool incoming;
+  final String channel;
+
+  /// The method name, or an empty string for messages that aren't method
+  /// calls.
+  final String method;
+  final int count;
+
+  /// Percentiles of the time spent in the plugin's handler, or null if
+  /// unknown.
+  final Duration handlerP50;
+  final Duration handlerP99;
+
+  /// Percentiles of the time from delivery to the response, including any
+  /// time the work was queued after the handler returned, or null if
+  /// unknown.
+  final Duration responseP50;
+  final Duration responseP99;
+
+  @override
+  String toString() => '$channel $method: $count calls, '
+      'handler p50 ${handlerP50?.inMicroseconds} us '
+      'p99 ${handlerP99?.inMicroseconds} us, '
+      'response p50 ${responseP50?.inMicroseconds} us '
+      'p99 ${responseP99?.inMicroseconds} us';
+}
+
+Duration _microseconds(int value) =>
+    value == null ? null : Duration(microseconds: value);
+
+List<PluginCallStats> _decodeStats(List<dynamic> stats) =>
+    stats.map((s) => PluginCallStats._fromMap(s)).toList();
+
+/// Returns the calls recorded by the runner, in the format documented for
+/// [_getCallRecordsMethod], or null if tracing isn't enabled.
+Future<List<Map<dynamic, dynamic>>> getPluginCallRecords() async {
+  try {
+    final records = await _channel.invokeMethod<List<dynamic>>(
+        _getCallRecordsMethod);
+    return records.cast<Map<dynamic, dynamic>>();
+  } on MissingPluginException {
+    return null;
+  }
+}
+
+/// Returns per-method statistics for the calls recorded by the runner, or
+/// null if tracing isn't enabled.
+Future<List<PluginCallStats>> getPluginCallStats() async {
+  try {
+    return _decodeStats(
+        await _channel.invokeMethod<List<dynamic>>(_getCallStatsMethod));
+  } on MissingPluginException {
+    return null;
+  }
+}
+
+/// Returns a stream of per-method statistics, sent by the runner every
+/// [interval] while the stream is listened to. Nothing is sent if tracing
+/// isn't enabled.
+Stream<List<PluginCallStats>> pluginCallStatsStream(Duration interval) {
+  StreamController<List<PluginCallStats>> controller;
+  controller = StreamController<List<PluginCallStats>>(onListen: () {
+    _channel.setMethodCallHandler((call) async {
+      if (call.method == _callStatsMethod) {
+        controller.add(_decodeStats(call.arguments));
+      }
+    });
+    _setStatsInterval(interval.inMilliseconds);
+  }, onCancel: () {
+    _channel.setMethodCallHandler(null);
+    _setStatsInterval(0);
+  });
+  return controller.stream;
+}
+
+void _setStatsInterval(int milliseconds) {
+  _channel
+      .invokeMethod<void>(_setStatsIntervalMethod, milliseconds)
+      .catchError((_) {}, test: (e) => e is MissingPluginException);
+}
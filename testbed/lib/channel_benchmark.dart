@@ -0,0 +1,62 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'package:flutter/services.dart';
+import 'package:flutter/widgets.dart';
+
+import 'package:example_flutter/headless.dart';
+import 'package:example_plugin/example_plugin.dart' as example_plugin;
+
+/// The environment variable that runs [runChannelBenchmark] instead of the
+/// testbed, usually together with the runner's `--headless` flag:
+///
+///     FLUTTER_CHANNEL_BENCHMARK=1 testbed --headless
+const String channelBenchmarkEnvironmentVariable = 'FLUTTER_CHANNEL_BENCHMARK';
+
+/// Round trips to time after warming up.
+const int _iterations = 1000;
+const int _warmUpIterations = 100;
+
+/// Measures the round-trip time of a platform channel call to a native
+/// plugin, prints the results, and ends the run with exit code 0, or 1 if any
+/// call fails.
+Future<void> runChannelBenchmark() async {
+  // Platform channels need the binding.
+  WidgetsFlutterBinding.ensureInitialized();
+  var exitCode = 0;
+  try {
+    for (var i = 0; i < _warmUpIterations; ++i) {
+      await example_plugin.ExamplePlugin.platformVersion;
+    }
+    final stopwatch = Stopwatch();
+    final times = <int>[];
+    for (var i = 0; i < _iterations; ++i) {
+      stopwatch
+        ..reset()
+        ..start();
+      await example_plugin.ExamplePlugin.platformVersion;
+      times.add(stopwatch.elapsedMicroseconds);
+    }
+    times.sort();
+    print('Channel round trip over $_iterations calls: '
+        'median ${times[times.length ~/ 2]} us, '
+        'p90 ${times[times.length * 9 ~/ 10]} us, '
+        'max ${times.last} us');
+  } on PlatformException catch (e) {
+    print('Channel benchmark failed: $e');
+    exitCode = 1;
+  }
+  if (!await exitHeadlessRun(exitCode)) {
+    print('Not running headless; close the window to exit.');
+  }
+}
@@ -0,0 +1,37 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'package:flutter/services.dart';
+
+/// The name of the channel used by the runner's headless mode.
+const String _headlessChannelName = 'flutter/headless';
+
+/// The method name to end a headless run.
+///
+/// Takes the exit code for the runner as an int.
+const String _exitMethod = 'Exit';
+
+/// Ends a headless run (started with `--headless`), making the runner exit
+/// with [exitCode].
+///
+/// Returns false if the runner isn't running headless, in which case the
+/// application keeps running.
+Future<bool> exitHeadlessRun(int exitCode) async {
+  try {
+    await const MethodChannel(_headlessChannelName)
+        .invokeMethod<void>(_exitMethod, exitCode);
+    return true;
+  } on MissingPluginException {
+    return false;
+  }
+}
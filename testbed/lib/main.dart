@@ -20,7 +20,12 @@ import 'package:flutter/material.dart';
 import 'package:flutter/services.dart';
 
 import 'package:color_panel/color_panel.dart';
+import 'package:example_flutter/channel_benchmark.dart';
 import 'package:example_flutter/keyboard_test_page.dart';
+import 'package:example_flutter/shader_benchmark.dart';
+import 'package:example_flutter/single_instance.dart';
+import 'package:example_flutter/startup_trace.dart';
+import 'package:example_flutter/training_scenario.dart';
 import 'package:file_chooser/file_chooser.dart' as file_chooser;
 import 'package:menubar/menubar.dart';
 import 'package:window_size/window_size.dart' as window_size;
@@ -31,20 +36,42 @@ void main() {
   // Flutter; force a specific target to prevent exceptions.
   debugDefaultTargetPlatformOverride = TargetPlatform.fuchsia;
 
+  if (Platform.environment.containsKey(channelBenchmarkEnvironmentVariable)) {
+    runChannelBenchmark();
+    return;
+  }
+  if (Platform.environment.containsKey(trainingScenarioEnvironmentVariable)) {
+    runTrainingScenario();
+    return;
+  }
+  if (Platform.environment.containsKey(shaderBenchmarkEnvironmentVariable)) {
+    runApp(ShaderBenchmarkApp());
+    reportFrameTimingsToRunner();
+    return;
+  }
+
   // Try to resize and reposition the window to be half the width and height
-  // of its screen, centered horizontally and shifted up from center.
+  // of its screen, centered horizontally and shifted up from center, unless
+  // the runner has created it with the geometry it had when last closed,
+  // which moving it here would undo.
   if (Platform.isMacOS || Platform.isLinux) {
-    window_size.getWindowInfo().then((window) {
-      if (window.screen != null) {
-        final screenFrame = window.screen.visibleFrame;
-        final width = math.max((screenFrame.width / 2).roundToDouble(), 800.0);
-        final height =
-            math.max((screenFrame.height / 2).roundToDouble(), 600.0);
-        final left = ((screenFrame.width - width) / 2).roundToDouble();
-        final top = ((screenFrame.height - height) / 3).roundToDouble();
-        final frame = Rect.fromLTWH(left, top, width, height);
-        window_size.setWindowFrame(frame);
+    window_size.isWindowGeometryRestored().then((restored) {
+      if (restored) {
+        return;
       }
+      window_size.getWindowInfo().then((window) {
+        if (window.screen != null) {
+          final screenFrame = window.screen.visibleFrame;
+          final width =
+              math.max((screenFrame.width / 2).roundToDouble(), 800.0);
+          final height =
+              math.max((screenFrame.height / 2).roundToDouble(), 600.0);
+          final left = ((screenFrame.width - width) / 2).roundToDouble();
+          final top = ((screenFrame.height - height) / 3).roundToDouble();
+          final frame = Rect.fromLTWH(left, top, width, height);
+          window_size.setWindowFrame(frame);
+        }
+      });
     });
   }
 
@@ -53,6 +80,10 @@ void main() {
   });
 
   runApp(new MyApp());
+  reportFrameTimingsToRunner();
+  listenForForwardedLaunches((workingDirectory, arguments) {
+    print('Launched again from $workingDirectory with arguments $arguments');
+  });
 }
 
 /// Top level widget for the example application.
@@ -0,0 +1,178 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'dart:math' as math;
+import 'dart:ui' show ImageFilter;
+
+import 'package:flutter/material.dart';
+
+/// The environment variable that runs [ShaderBenchmarkApp] instead of the
+/// testbed, to compare frame times with a cold and a warm shader cache.
+const String shaderBenchmarkEnvironmentVariable = 'FLUTTER_SHADER_BENCHMARK';
+
+/// Continuously animates a grid of tiles that each need a different shader
+/// (gradients, shadows, blurs, clips, and masks), so that the first frames
+/// are dominated by shader compilation when the shader cache is cold.
+class ShaderBenchmarkApp extends StatefulWidget {
+  @override
+  _ShaderBenchmarkAppState createState() => _ShaderBenchmarkAppState();
+}
+
+class _ShaderBenchmarkAppState extends State<ShaderBenchmarkApp>
+    with SingleTickerProviderStateMixin {
+  AnimationController _controller;
+
+  @override
+  void initState() {
+    super.initState();
+    _controller =
+        AnimationController(vsync: this, duration: const Duration(seconds: 2))
+          ..repeat();
+  }
+
+  @override
+  void dispose() {
+    _controller.dispose();
+    super.dispose();
+  }
+
+  @override
+  Widget build(BuildContext context) {
+    return MaterialApp(
+      home: AnimatedBuilder(
+        animation: _controller,
+        builder: (context, child) => GridView.count(
+          crossAxisCount: 4,
+          children: List<Widget>.generate(
+              _tileBuilders.length,
+              (index) =>
+                  _tileBuilders[index](_controller.value * 2 * math.pi)),
+        ),
+      ),
+    );
+  }
+}
+
+typedef _TileBuilder = Widget Function(double angle);
+
+/// Builders for each tile, given the current animation angle in radians.
+final List<_TileBuilder> _tileBuilders = <_TileBuilder>[
+  (angle) => _Tile(
+      decoration: BoxDecoration(
+          gradient: LinearGradient(
+              begin: _alignmentAt(angle),
+              end: _alignmentAt(angle + math.pi),
+              colors: const [Colors.red, Colors.blue]))),
+  (angle) => _Tile(
+      decoration: BoxDecoration(
+          gradient: RadialGradient(
+              radius: 0.5 + 0.5 * math.sin(angle).abs(),
+              colors: const [Colors.yellow, Colors.green, Colors.purple]))),
+  (angle) => _Tile(
+      decoration: BoxDecoration(
+          gradient: SweepGradient(
+              center: _alignmentAt(angle) * 0.5,
+              colors: const [Colors.cyan, Colors.pink, Colors.cyan]))),
+  (angle) => _Tile(
+      decoration: BoxDecoration(
+          color: Colors.white,
+          borderRadius: BorderRadius.circular(24),
+          boxShadow: [
+            BoxShadow(
+                blurRadius: 8 + 8 * math.sin(angle).abs(),
+                color: Colors.black54)
+          ])),
+  (angle) => ClipOval(
+      child: _Tile(decoration: const BoxDecoration(color: Colors.orange))),
+  (angle) => ClipPath(
+      clipper: _StarClipper(angle),
+      child: _Tile(decoration: const BoxDecoration(color: Colors.teal))),
+  (angle) => Opacity(
+      opacity: 0.25 + 0.75 * math.sin(angle).abs(),
+      child: _Tile(decoration: const BoxDecoration(color: Colors.indigo))),
+  (angle) => Transform.rotate(
+      angle: angle,
+      child: _Tile(decoration: const BoxDecoration(color: Colors.lime))),
+  (angle) => ShaderMask(
+      shaderCallback: (bounds) => LinearGradient(
+              begin: _alignmentAt(angle),
+              end: _alignmentAt(angle + math.pi),
+              colors: const [Colors.white, Colors.transparent])
+          .createShader(bounds),
+      child: _Tile(decoration: const BoxDecoration(color: Colors.brown))),
+  (angle) => ClipRect(
+      child: Stack(fit: StackFit.expand, children: [
+        _Tile(decoration: const BoxDecoration(color: Colors.amber)),
+        BackdropFilter(
+            filter: ImageFilter.blur(
+                sigmaX: 4 + 4 * math.sin(angle).abs(),
+                sigmaY: 4 + 4 * math.sin(angle).abs()),
+            child: Container(color: Colors.transparent)),
+      ])),
+  (angle) => ColorFiltered(
+      colorFilter: ColorFilter.mode(
+          HSVColor.fromAHSV(1, angle * 180 / math.pi, 1, 1).toColor(),
+          BlendMode.modulate),
+      child: _Tile(decoration: const BoxDecoration(color: Colors.white))),
+  (angle) => Center(
+      child: Text('Shaders',
+          style: TextStyle(
+              fontSize: 24 + 8 * math.sin(angle),
+              foreground: Paint()
+                ..style = PaintingStyle.stroke
+                ..strokeWidth = 2))),
+];
+
+/// Returns the point on the edge of the unit circle at [angle].
+Alignment _alignmentAt(double angle) =>
+    Alignment(math.cos(angle), math.sin(angle));
+
+/// A decorated tile in the benchmark grid.
+class _Tile extends StatelessWidget {
+  const _Tile({this.decoration});
+
+  final Decoration decoration;
+
+  @override
+  Widget build(BuildContext context) => Container(
+      margin: const EdgeInsets.all(8), decoration: decoration);
+}
+
+/// Clips to a five-pointed star rotated by [angle].
+class _StarClipper extends CustomClipper<Path> {
+  _StarClipper(this.angle);
+
+  final double angle;
+
+  @override
+  Path getClip(Size size) {
+    final center = size.center(Offset.zero);
+    final outerRadius = size.shortestSide / 2;
+    final path = Path();
+    for (var i = 0; i < 10; ++i) {
+      final radius = i.isEven ? outerRadius : outerRadius / 2;
+      final pointAngle = angle + i * math.pi / 5;
+      final point = center +
+          Offset(radius * math.cos(pointAngle), radius * math.sin(pointAngle));
+      if (i == 0) {
+        path.moveTo(point.dx, point.dy);
+      } else {
+        path.lineTo(point.dx, point.dy);
+      }
+    }
+    return path..close();
+  }
+
+  @override
+  bool shouldReclip(_StarClipper oldClipper) => oldClipper.angle != angle;
+}
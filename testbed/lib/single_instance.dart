@@ -0,0 +1,55 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'package:flutter/services.dart';
+
+/// The name of the channel used by the runner's single-instance mode.
+const String _singleInstanceChannelName = 'flutter/singleinstance';
+
+/// The method name to start receiving launches. Takes no arguments.
+///
+/// Launches that arrive before this is called are queued by the runner.
+const String _listenMethod = 'Listen';
+
+/// The method name the runner calls for each launch that was forwarded to
+/// this instance.
+///
+/// Takes a map with:
+///   'workingDirectory': the working directory of the launching process, for
+///       resolving relative paths.
+///   'arguments': the launching process's command line arguments, excluding
+///       the executable.
+const String _launchedMethod = 'Launched';
+
+/// Signature for callbacks receiving a forwarded launch.
+typedef LaunchCallback = void Function(
+    String workingDirectory, List<String> arguments);
+
+/// Calls [onLaunch] for each later launch of the application that the runner
+/// forwarded to this instance, when running in single-instance mode.
+///
+/// If the runner isn't in single-instance mode, nothing listens on the
+/// channel and [onLaunch] is never called.
+void listenForForwardedLaunches(LaunchCallback onLaunch) {
+  const channel = MethodChannel(_singleInstanceChannelName);
+  channel.setMethodCallHandler((call) async {
+    if (call.method == _launchedMethod) {
+      final arguments = call.arguments as Map<dynamic, dynamic>;
+      onLaunch(arguments['workingDirectory'] as String,
+          (arguments['arguments'] as List<dynamic>).cast<String>());
+    }
+  });
+  channel
+      .invokeMethod<void>(_listenMethod)
+      .catchError((_) {}, test: (e) => e is MissingPluginException);
+}
@@ -0,0 +1,93 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'dart:ui' show FramePhase, FrameTiming;
+
+import 'package:flutter/scheduler.dart';
+import 'package:flutter/services.dart';
+
+/// The name of the channel used to report startup milestones to the runner's
+/// startup tracer.
+const String _startupTraceChannelName = 'flutter/startuptrace';
+
+/// The method name to report the first rasterized frame.
+///
+/// Takes a list of four timestamps from the first frame's [FrameTiming], in
+/// microseconds on the engine's monotonic clock:
+///   [buildStart, buildFinish, rasterStart, rasterFinish]
+const String _firstFrameRasterizedMethod = 'FirstFrameRasterized';
+
+/// The method name to report a summary of the frames after the first.
+///
+/// Takes a list of five values, with durations in microseconds:
+///   [frameCount, buildMedian, buildP90, rasterMedian, rasterP90]
+const String _frameTimingSummaryMethod = 'FrameTimingSummary';
+
+/// The number of frames after the first that are summarized.
+const int _steadyStateFrameCount = 120;
+
+/// Reports the timing of the first rasterized frame to the runner, followed
+/// by a summary of the next [_steadyStateFrameCount] frames once they have
+/// been rasterized.
+///
+/// Must be called after [runApp]. If startup tracing isn't enabled in the
+/// runner, nothing listens on the channel and the reports are dropped.
+void reportFrameTimingsToRunner() {
+  const channel = MethodChannel(_startupTraceChannelName);
+  final steadyStateTimings = <FrameTiming>[];
+  var firstFrameReported = false;
+  TimingsCallback callback;
+  callback = (List<FrameTiming> timings) {
+    if (!firstFrameReported) {
+      firstFrameReported = true;
+      final timing = timings.first;
+      _invokeIgnoringMissingPlugin(channel, _firstFrameRasterizedMethod, <int>[
+        timing.timestampInMicroseconds(FramePhase.buildStart),
+        timing.timestampInMicroseconds(FramePhase.buildFinish),
+        timing.timestampInMicroseconds(FramePhase.rasterStart),
+        timing.timestampInMicroseconds(FramePhase.rasterFinish),
+      ]);
+      timings = timings.sublist(1);
+    }
+    steadyStateTimings.addAll(timings);
+    if (steadyStateTimings.length < _steadyStateFrameCount) {
+      return;
+    }
+    SchedulerBinding.instance.removeTimingsCallback(callback);
+    final frames = steadyStateTimings.sublist(0, _steadyStateFrameCount);
+    final buildTimes = frames.map((t) => t.buildDuration.inMicroseconds);
+    final rasterTimes = frames.map((t) => t.rasterDuration.inMicroseconds);
+    _invokeIgnoringMissingPlugin(channel, _frameTimingSummaryMethod, <int>[
+      frames.length,
+      _percentile(buildTimes, 50),
+      _percentile(buildTimes, 90),
+      _percentile(rasterTimes, 50),
+      _percentile(rasterTimes, 90),
+    ]);
+  };
+  SchedulerBinding.instance.addTimingsCallback(callback);
+}
+
+/// Calls [method] on [channel], ignoring the error if nothing is listening.
+void _invokeIgnoringMissingPlugin(
+    MethodChannel channel, String method, List<int> arguments) {
+  channel
+      .invokeMethod<void>(method, arguments)
+      .catchError((_) {}, test: (e) => e is MissingPluginException);
+}
+
+/// Returns the [percent]th percentile of [values], which must not be empty.
+int _percentile(Iterable<int> values, int percent) {
+  final sorted = values.toList()..sort();
+  return sorted[((sorted.length - 1) * percent / 100).round()];
+}
@@ -0,0 +1,157 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+import 'dart:async';
+import 'dart:io';
+
+import 'package:color_panel/color_panel.dart';
+import 'package:file_chooser/file_chooser.dart' as file_chooser;
+import 'package:flutter/services.dart';
+import 'package:flutter/widgets.dart';
+import 'package:menubar/menubar.dart';
+import 'package:window_size/window_size.dart' as window_size;
+
+import 'package:example_flutter/headless.dart';
+import 'package:example_plugin/example_plugin.dart' as example_plugin;
+
+/// The environment variable that runs [runTrainingScenario] instead of the
+/// testbed, together with the runner's `--headless` flag:
+///
+///     FLUTTER_TRAINING_SCENARIO=1 testbed --headless
+///
+/// tools/build_optimized.dart uses it both to record the profile for a
+/// profile-guided build and to compare the CPU time of differently optimized
+/// builds. File chooser dialogs are modal, so it also loads a GTK module that
+/// dismisses them (see testbed/linux/training_dialog_dismisser.cc); without
+/// that, each file chooser round trip waits for the dialog to be closed.
+const String trainingScenarioEnvironmentVariable = 'FLUTTER_TRAINING_SCENARIO';
+
+/// A step of the training scenario, repeated [iterations] times.
+class _Scenario {
+  const _Scenario(this.name, this.iterations, this.run);
+
+  final String name;
+  final int iterations;
+
+  /// Runs iteration [i], completing once the plugin has handled it.
+  final Future<void> Function(int i) run;
+}
+
+final List<_Scenario> _scenarios = [
+  _Scenario('menu rebuild', 200, _rebuildMenus),
+  _Scenario('window resize', 500, _resizeWindow),
+  _Scenario('color panel', 100, _showAndHideColorPanel),
+  _Scenario('file chooser', 50, _showFileChooser),
+];
+
+/// Runs each step of the training scenario through the native plugins,
+/// printing the CPU and wall time each takes, then ends the headless run with
+/// exit code 0, or 1 if any call fails.
+///
+/// Each result is printed as a line of the form
+///
+///     Training scenario <name>: <n> iterations, <cpu> us CPU, <wall> us wall
+///
+/// CPU time is that of the whole process, including the engine's threads, so
+/// it is only meaningful relative to other builds running the same scenario.
+Future<void> runTrainingScenario() async {
+  // Platform channels need the binding.
+  WidgetsFlutterBinding.ensureInitialized();
+  var exitCode = 0;
+  try {
+    for (final scenario in _scenarios) {
+      final stopwatch = Stopwatch()..start();
+      final startCpuTime = _processCpuMicroseconds();
+      for (var i = 0; i < scenario.iterations; ++i) {
+        await scenario.run(i);
+      }
+      final cpuTime = _processCpuMicroseconds() - startCpuTime;
+      print('Training scenario ${scenario.name}: '
+          '${scenario.iterations} iterations, $cpuTime us CPU, '
+          '${stopwatch.elapsedMicroseconds} us wall');
+    }
+  } on PlatformException catch (e) {
+    print('Training scenario failed: $e');
+    exitCode = 1;
+  }
+  if (!await exitHeadlessRun(exitCode)) {
+    print('Not running headless; close the window to exit.');
+  }
+}
+
+/// Waits for the messages already sent to plugins to be handled. The runner
+/// handles messages in the order they are sent, so a round trip to any plugin
+/// follows those sent by calls that don't report completion.
+Future<void> _waitForPlatformThread() =>
+    example_plugin.ExamplePlugin.platformVersion;
+
+Future<void> _rebuildMenus(int i) {
+  // Vary the menu so that each rebuild has changes to apply.
+  final itemCount = 5 + i % 10;
+  final menus = <Submenu>[];
+  for (var menu = 0; menu < 4; ++menu) {
+    final children = <AbstractMenuItem>[];
+    for (var item = 0; item < itemCount; ++item) {
+      children.add(MenuItem(label: 'Item $item', onClicked: () {}));
+    }
+    children
+      ..add(const MenuDivider())
+      ..add(Submenu(label: 'More', children: [
+        MenuItem(label: 'Iteration $i', enabled: false),
+      ]));
+    menus.add(Submenu(label: 'Menu $menu', children: children));
+  }
+  return setApplicationMenu(menus);
+}
+
+Future<void> _resizeWindow(int i) {
+  window_size.setWindowFrame(
+      Rect.fromLTWH(100, 100, 640.0 + i % 200, 480.0 + i % 150));
+  return _waitForPlatformThread();
+}
+
+Future<void> _showAndHideColorPanel(int i) {
+  ColorPanel.instance
+    ..show((color) {}, showAlpha: i.isEven)
+    ..hide();
+  return _waitForPlatformThread();
+}
+
+Future<void> _showFileChooser(int i) {
+  final completer = Completer<void>();
+  void callback(file_chooser.FileChooserResult result, List<String> paths) {
+    completer.complete();
+  }
+
+  if (i.isEven) {
+    file_chooser.showOpenPanel(callback, allowedFileTypes: ['txt', 'json']);
+  } else {
+    file_chooser.showSavePanel(callback, suggestedFileName: 'training.txt');
+  }
+  return completer.future;
+}
+
+/// Returns the CPU time used so far by the threads of this process, from
+/// their scheduler statistics, which are in nanoseconds.
+int _processCpuMicroseconds() {
+  var nanoseconds = 0;
+  for (final task in Directory('/proc/self/task').listSync()) {
+    try {
+      final schedstat = File('${task.path}/schedstat').readAsStringSync();
+      nanoseconds += int.parse(schedstat.split(' ').first);
+    } on FileSystemException {
+      // The thread has exited.
+    }
+  }
+  return nanoseconds ~/ 1000;
+}
@@ -11,11 +11,14 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <dlfcn.h>
 #include <linux/limits.h>
 #include <unistd.h>
+#include <chrono>
 #include <cstdlib>
 #include <iostream>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include <color_panel_plugin.h>
@@ -25,8 +28,55 @@
 #include <menubar_plugin.h>
 #include <window_size_plugin.h>
 
+#include "plugins/common/linux/probes.h"
+#include "plugins/common/linux/window_geometry_file.h"
+#include "runner/linux/app_directories.h"
+#include "runner/linux/file_prefetcher.h"
+#include "runner/linux/headless_mode.h"
+#include "runner/linux/lazy_plugin_loader.h"
+#include "runner/linux/message_recorder.h"
+#include "runner/linux/plugin_call_tracer.h"
+#include "runner/linux/shader_cache.h"
+#include "runner/linux/single_instance.h"
+#include "runner/linux/stall_watchdog.h"
+#include "runner/linux/startup_tracer.h"
+#include "runner/linux/zygote.h"
+
 namespace {
 
+// The identifier used for per-application directories, such as the cache.
+const char kApplicationId[] = "flutter_desktop_testbed";
+
+// How often the event loop wakes while something needs periodic work:
+// delivering launches forwarded by other instances, the stall watchdog's
+// heartbeat, and the like.
+constexpr std::chrono::milliseconds kEventLoopWakeInterval{100};
+static_assert(kEventLoopWakeInterval <=
+                  runner::SingleInstance::kDeliveryInterval,
+              "Forwarded launches must be delivered often enough");
+
+// With STATIC_PLUGINS=true in the Makefile, all plugins are linked into the
+// executable, so lazy plugins are registered by calling their registration
+// functions rather than by loading their libraries.
+#ifdef TESTBED_STATIC_PLUGINS
+#define LINKED_REGISTER_FUNCTION(function) function
+#else
+#define LINKED_REGISTER_FUNCTION(function) nullptr
+#endif
+
+// Plugins that most sessions never use, which are registered the first time
+// their channel receives a message rather than at startup. Unless plugins are
+// linked statically, their libraries must not be linked into the executable;
+// see LAZY_PLUGIN_NAMES in the Makefile.
+const runner::LazyPlugin kLazyPlugins[] = {
+    {"ColorPanel", "flutter/colorpanel", "libcolor_panel_plugin.so",
+     "ColorPanelRegisterWithRegistrar", false,
+     LINKED_REGISTER_FUNCTION(ColorPanelRegisterWithRegistrar)},
+    {"FileChooser", "flutter/filechooser", "libfile_chooser_plugin.so",
+     "FileChooserRegisterWithRegistrar", true,
+     LINKED_REGISTER_FUNCTION(FileChooserRegisterWithRegistrar)},
+};
+
 // Returns the path of the directory containing this executable, or an empty
 // string if the directory cannot be found.
 std::string GetExecutableDirectory() {
@@ -46,9 +96,61 @@ std::string GetExecutableDirectory() {
   return executable_path.substr(0, last_separator_position);
 }
 
+// Does the fork-safe part of startup ahead of time when running as a zygote:
+// warms the page cache with the bundle's startup files, and loads the lazily
+// loaded plugins so that launched processes find them already relocated.
+void PreloadForZygote() {
+  std::string base_directory = GetExecutableDirectory();
+  if (base_directory.empty()) {
+    base_directory = ".";
+  }
+  // Finish joins the prefetch thread, so none survives to fork.
+  std::string cache_directory = runner::GetCacheDirectory(kApplicationId);
+  runner::FilePrefetcher prefetcher(
+      base_directory,
+      cache_directory.empty() ? "" : cache_directory + "/prefetch_manifest");
+  prefetcher.Start();
+  prefetcher.Finish(nullptr);
+  for (const auto &plugin : kLazyPlugins) {
+    if (plugin.linked_register_function) {
+      continue;
+    }
+    std::string path = base_directory + "/lib/" + plugin.library;
+    dlopen(path.c_str(), RTLD_NOW | RTLD_NODELETE);
+  }
+}
+
 }  // namespace
 
 int main(int argc, char **argv) {
+  // When started with --zygote, this preloads and then waits for launch
+  // requests from testbed_launch, returning only in each launched process.
+  if (!runner::RunZygoteIfRequested(kApplicationId, PreloadForZygote, &argc,
+                                    &argv)) {
+    return EXIT_FAILURE;
+  }
+
+  // Startup phases are recorded if FLUTTER_STARTUP_TRACE is set.
+  runner::StartupTracer tracer(argc, argv);
+  int64_t main_start = runner::StartupTracer::Now();
+  // Each startup phase is also bracketed by runner_phase_start and
+  // runner_phase_done probes, named as in the startup trace.
+  FLUTTER_DESKTOP_PROBE1(runner_phase_start, "LocateResources");
+
+  // In headless mode, the window is created on a private virtual display.
+  runner::HeadlessMode headless(argc, argv);
+  if (headless.enabled() && !headless.StartDisplay()) {
+    return EXIT_FAILURE;
+  }
+
+  // In single-instance mode, a launch while another instance is running hands
+  // its arguments to that instance rather than starting another engine. A
+  // headless run is always independent of any instance on the real display.
+  runner::SingleInstance single_instance(kApplicationId, argc, argv);
+  if (!headless.enabled() && single_instance.ForwardToRunningInstance()) {
+    return EXIT_SUCCESS;
+  }
+
   // Resources are located relative to the executable.
   std::string base_directory = GetExecutableDirectory();
   if (base_directory.empty()) {
@@ -58,33 +160,142 @@ int main(int argc, char **argv) {
   std::string assets_path = data_directory + "/flutter_assets";
   std::string icu_data_path = data_directory + "/icudtl.dat";
 
+  // Start warming the page cache with the files the engine reads at startup,
+  // while the rest of startup proceeds.
+  std::string cache_directory = runner::GetCacheDirectory(kApplicationId);
+  runner::FilePrefetcher prefetcher(
+      base_directory,
+      cache_directory.empty() ? "" : cache_directory + "/prefetch_manifest");
+  prefetcher.Start();
+
   // Arguments for the Flutter Engine.
   std::vector<std::string> arguments;
 #ifdef NDEBUG
   arguments.push_back("--disable-dart-asserts");
 #endif
 
+  // Release bundles contain the application AOT-compiled into lib/libapp.so.
+  // Otherwise, the engine runs the kernel snapshot in the assets directory.
+  std::string aot_library_path = base_directory + "/lib/libapp.so";
+  bool use_aot_library = access(aot_library_path.c_str(), R_OK) == 0;
+  if (use_aot_library) {
+    arguments.push_back("--aot-shared-library-name=" + aot_library_path);
+  }
+  tracer.SetMetadata("snapshot", use_aot_library ? "aot" : "kernel");
+
+  // Reuse the shaders compiled by earlier runs.
+  runner::ShaderCacheState shader_cache_state =
+      runner::ConfigureShaderCache(cache_directory, argc, argv, &arguments);
+  tracer.SetMetadata("shader_cache",
+                     runner::ShaderCacheStateName(shader_cache_state));
+
+  // Create the window with the size and position it had when last closed,
+  // rather than letting Dart move it after the first frame. A headless run's
+  // virtual display is unrelated to the real one, so it neither restores nor
+  // saves geometry.
+  std::string geometry_path;
+  if (!headless.enabled()) {
+    std::string config_directory = runner::GetConfigDirectory(kApplicationId);
+    if (!config_directory.empty()) {
+      geometry_path = config_directory + "/window_geometry";
+    }
+  }
+  plugins_common::WindowGeometry window_geometry;
+  window_geometry.width = 800;
+  window_geometry.height = 600;
+  bool restore_geometry =
+      !geometry_path.empty() &&
+      plugins_common::ReadWindowGeometry(geometry_path, &window_geometry);
+  tracer.SetMetadata("window_geometry",
+                     restore_geometry ? "restored" : "default");
+
+  tracer.AddPhase("LocateResources", main_start,
+                  runner::StartupTracer::Now());
+  FLUTTER_DESKTOP_PROBE1(runner_phase_done, "LocateResources");
+
   flutter::FlutterWindowController flutter_controller(icu_data_path);
 
   // Start the engine.
-  if (!flutter_controller.CreateWindow(800, 600, "Testbed", assets_path,
-                                       arguments)) {
+  int64_t phase_start = runner::StartupTracer::Now();
+  FLUTTER_DESKTOP_PROBE1(runner_phase_start, "CreateWindow");
+  if (!flutter_controller.CreateWindow(window_geometry.width,
+                                       window_geometry.height, "Testbed",
+                                       assets_path, arguments)) {
     return EXIT_FAILURE;
   }
+  if (restore_geometry) {
+    flutter::WindowFrame frame = flutter_controller.window()->GetFrame();
+    frame.left = window_geometry.left;
+    frame.top = window_geometry.top;
+    flutter_controller.window()->SetFrame(frame);
+  }
+  tracer.AddPhase("CreateWindow", phase_start, runner::StartupTracer::Now());
+  FLUTTER_DESKTOP_PROBE1(runner_phase_done, "CreateWindow");
+
+  // Log stalls of the platform thread, if enabled. This observes channel
+  // messages, so it must be created before any handlers are installed.
+  runner::StallWatchdog stall_watchdog(argc, argv, kEventLoopWakeInterval);
+
+  tracer.ListenForFrameTimings(
+      flutter_controller.GetRegistrarForPlugin("StartupTracer"));
+  single_instance.RegisterChannel(
+      flutter_controller.GetRegistrarForPlugin("SingleInstance"));
+  headless.RegisterChannel(
+      flutter_controller.GetRegistrarForPlugin("HeadlessMode"));
+
+  // Record plugin calls for flutter/diagnostics, and log plugin channel
+  // traffic for replay, if enabled. This must happen before the plugins
+  // install their handlers.
+  runner::PluginCallTracer plugin_call_tracer(argc, argv);
+  runner::MessageRecorder message_recorder(argc, argv);
+  plugin_call_tracer.RegisterChannel(
+      flutter_controller.GetRegistrarForPlugin("PluginCallTracer"));
 
   // Register any native plugins.
-  ColorPanelRegisterWithRegistrar(
-      flutter_controller.GetRegistrarForPlugin("ColorPanel"));
+  phase_start = runner::StartupTracer::Now();
+  FLUTTER_DESKTOP_PROBE1(runner_phase_start, "RegisterPlugins");
+  runner::LazyPluginLoader lazy_plugin_loader(base_directory + "/lib",
+                                              &tracer);
+  for (const auto &plugin : kLazyPlugins) {
+    lazy_plugin_loader.AddPlugin(
+        plugin, flutter_controller.GetRegistrarForPlugin(plugin.name));
+  }
   ExamplePluginRegisterWithRegistrar(
       flutter_controller.GetRegistrarForPlugin("ExamplePlugin"));
-  FileChooserRegisterWithRegistrar(
-      flutter_controller.GetRegistrarForPlugin("FileChooser"));
   MenubarRegisterWithRegistrar(
       flutter_controller.GetRegistrarForPlugin("Menubar"));
+  // The window_size plugin keeps the geometry file up to date, and moves a
+  // restored window back on screen if its monitor has been disconnected.
+  if (!geometry_path.empty()) {
+    WindowSizeSetGeometryFile(geometry_path.c_str());
+  }
   WindowSizeRegisterWithRegistrar(
       flutter_controller.GetRegistrarForPlugin("WindowSize"));
+  tracer.AddPhase("RegisterPlugins", phase_start,
+                  runner::StartupTracer::Now());
+  FLUTTER_DESKTOP_PROBE1(runner_phase_done, "RegisterPlugins");
 
-  // Run until the window is closed.
-  flutter_controller.RunEventLoop();
-  return EXIT_SUCCESS;
+  // Run until the window is closed, or a headless run is ended by Dart.
+  tracer.AddInstantEvent("RunEventLoop", runner::StartupTracer::Now());
+  FLUTTER_DESKTOP_PROBE1(runner_phase_start, "RunEventLoop");
+  if (single_instance.listening() || headless.enabled() ||
+      stall_watchdog.enabled() || plugin_call_tracer.enabled()) {
+    // Wake periodically to deliver launches forwarded by other instances, for
+    // the watchdog's heartbeat, and to send plugin call statistics.
+    stall_watchdog.Start();
+    while (flutter_controller.RunEventLoopWithTimeout(
+               kEventLoopWakeInterval) &&
+           !headless.exit_requested()) {
+      stall_watchdog.Heartbeat();
+      single_instance.DeliverForwardedLaunches();
+      plugin_call_tracer.Poll();
+    }
+  } else {
+    flutter_controller.RunEventLoop();
+  }
+  FLUTTER_DESKTOP_PROBE1(runner_phase_done, "RunEventLoop");
+  // Keep a move or resize made just before the window was closed.
+  WindowSizeSaveGeometry();
+  prefetcher.Finish(&tracer);
+  return headless.enabled() ? headless.exit_code() : EXIT_SUCCESS;
 }
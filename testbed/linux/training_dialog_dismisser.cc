@@ -0,0 +1,55 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A GTK module that cancels each file chooser dialog as soon as it is shown,
+// so that the testbed's training scenario (see
+// testbed/lib/training_scenario.dart) can make file chooser round trips
+// without anyone to close the dialogs. tools/build_optimized.dart loads it
+// into the testbed with GTK_MODULES=<absolute path to the module>.
+
+#include <gtk/gtk.h>
+
+namespace {
+
+// Cancels |dialog|, which holds a reference taken by OnWidgetMapped.
+gboolean CancelDialog(gpointer dialog) {
+  gtk_dialog_response(GTK_DIALOG(dialog), GTK_RESPONSE_CANCEL);
+  g_object_unref(dialog);
+  return G_SOURCE_REMOVE;
+}
+
+// Emission hook for GtkWidget::map. The response is sent from an idle
+// callback, since the dialog is mapped just before gtk_dialog_run starts the
+// loop that waits for it.
+gboolean OnWidgetMapped(GSignalInvocationHint *hint,
+                        guint param_count,
+                        const GValue *params,
+                        gpointer user_data) {
+  GObject *widget = g_value_get_object(&params[0]);
+  if (GTK_IS_FILE_CHOOSER_DIALOG(widget)) {
+    g_idle_add(CancelDialog, g_object_ref(widget));
+  }
+  // Keep the hook installed.
+  return TRUE;
+}
+
+}  // namespace
+
+extern "C" G_MODULE_EXPORT void gtk_module_init(gint *argc, gchar ***argv) {
+  // Signals can only be looked up once their class exists. The reference is
+  // kept for the life of the process.
+  g_type_class_ref(GTK_TYPE_WIDGET);
+  g_signal_add_emission_hook(g_signal_lookup("map", GTK_TYPE_WIDGET), 0,
+                             OnWidgetMapped, nullptr, nullptr);
+}
@@ -0,0 +1,252 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Builds the testbed with each C++ optimization setting (see
+// plugins/common/linux/optimization.mk), including a profile-guided build
+// trained on the testbed's training scenario, and compares them.
+//
+// Usage: dart tools/build_optimized.dart [--runs=N] [--static-plugins]
+//
+// The steps are:
+// 1. Build an instrumented (pgo-generate) testbed, run the training scenario
+//    (see testbed/lib/training_scenario.dart) in it, and merge the profiles
+//    written by the runner and each plugin library with llvm-profdata.
+// 2. Build release bundles with no optimization, -O2, ThinLTO, and ThinLTO
+//    using the profile.
+// 3. Run the training scenario in each bundle --runs times, alternating
+//    between bundles, and print the median CPU time of each scenario step
+//    along with the size of the executable and its plugin libraries.
+//
+// With --static-plugins, every build links the plugins into the executable
+// (STATIC_PLUGINS=true), so that LTO and PGO also optimize across them.
+//
+// The testbed must already have been built once with the flutter tool, and
+// the training runs use the runner's headless mode, so Xvfb is required. The
+// Dart code is AOT-compiled the same way in every bundle, so differences come
+// from the C++ code of the runner and plugins.
+
+import 'dart:convert';
+import 'dart:io';
+
+const String _runsPrefix = '--runs=';
+const String _staticPluginsFlag = '--static-plugins';
+const Duration _trainingTimeout = Duration(minutes: 5);
+final RegExp _scenarioResultPattern =
+    RegExp(r'Training scenario (.+): (\d+) iterations, (\d+) us CPU');
+
+/// A build to compare.
+class _Variant {
+  const _Variant(this.label, this.optimization);
+
+  final String label;
+
+  /// The OPTIMIZATION setting to build with.
+  final String optimization;
+}
+
+const List<_Variant> _variants = [
+  _Variant('debug (-O0)', 'none'),
+  _Variant('O2', 'o2'),
+  _Variant('LTO', 'lto'),
+  _Variant('LTO+PGO', 'pgo-use'),
+];
+
+Future<void> main(List<String> arguments) async {
+  var runs = 5;
+  var staticPlugins = false;
+  for (final argument in arguments) {
+    if (argument.startsWith(_runsPrefix)) {
+      runs = int.parse(argument.substring(_runsPrefix.length));
+    } else if (argument == _staticPluginsFlag) {
+      staticPlugins = true;
+    } else {
+      _exitWithUsage();
+    }
+  }
+  if (runs < 1) {
+    _exitWithUsage();
+  }
+
+  final root = File.fromUri(Platform.script).parent.parent.path;
+  final testbedLinuxDirectory = '$root/testbed/linux';
+  final makeArguments = [
+    '-C',
+    testbedLinuxDirectory,
+    'BUILD=release',
+    if (staticPlugins) 'STATIC_PLUGINS=true',
+  ];
+  String outputDirectory(String optimization) => optimization == 'none'
+      ? '$root/testbed/build/linux'
+      : '$root/testbed/build/linux/$optimization';
+  String executable(String optimization) =>
+      '${outputDirectory(optimization)}/release/testbed';
+
+  await _make(['-C', testbedLinuxDirectory, 'training']);
+  final dialogDismisser =
+      '${outputDirectory('none')}/libtraining_dialog_dismisser.so';
+
+  // Record and merge the training profile.
+  await _make([...makeArguments, 'OPTIMIZATION=pgo-generate']);
+  final profileDirectory =
+      Directory('${outputDirectory('pgo-generate')}/profile');
+  if (profileDirectory.existsSync()) {
+    profileDirectory.deleteSync(recursive: true);
+  }
+  profileDirectory.createSync(recursive: true);
+  stdout.writeln('Recording the training profile...');
+  if (await _runTrainingScenario(executable('pgo-generate'), dialogDismisser,
+          {'LLVM_PROFILE_FILE': '${profileDirectory.path}/%p-%m.profraw'}) ==
+      null) {
+    exit(1);
+  }
+  final profile = '${profileDirectory.path}/testbed.profdata';
+  final rawProfiles = profileDirectory
+      .listSync()
+      .map((entity) => entity.path)
+      .where((path) => path.endsWith('.profraw'));
+  await _run('llvm-profdata', ['merge', '-output=$profile', ...rawProfiles]);
+
+  for (final variant in _variants) {
+    await _make([
+      ...makeArguments,
+      'OPTIMIZATION=${variant.optimization}',
+      if (variant.optimization == 'pgo-use') 'PGO_PROFILE=$profile',
+    ]);
+  }
+
+  // CPU times in microseconds, by variant and then scenario step.
+  final cpuTimes = <_Variant, Map<String, List<int>>>{
+    for (final variant in _variants) variant: <String, List<int>>{}
+  };
+  final scenarioNames = <String>[];
+  // Alternate between variants, so that each is measured under similar
+  // conditions.
+  for (var i = 0; i < runs; ++i) {
+    for (final variant in _variants) {
+      stdout.writeln('Run ${i + 1} of $runs: ${variant.label}');
+      final results = await _runTrainingScenario(
+          executable(variant.optimization), dialogDismisser, {});
+      if (results == null) {
+        continue;
+      }
+      results.forEach((name, cpuTime) {
+        if (!scenarioNames.contains(name)) {
+          scenarioNames.add(name);
+        }
+        cpuTimes[variant].putIfAbsent(name, () => <int>[]).add(cpuTime);
+      });
+    }
+  }
+
+  stdout.writeln('Median CPU time over up to $runs runs of the training '
+      'scenario${staticPlugins ? ', with static plugins' : ''}:');
+  stdout.writeln(['variant', 'code size', ...scenarioNames]
+      .map((heading) => heading.padRight(16))
+      .join());
+  for (final variant in _variants) {
+    final codeSize = _codeSize(executable(variant.optimization));
+    stdout.writeln([
+      variant.label,
+      '${codeSize ~/ 1024} KB',
+      for (final name in scenarioNames)
+        _formatMilliseconds(_median(cpuTimes[variant][name] ?? [])),
+    ].map((column) => column.padRight(16)).join());
+  }
+}
+
+void _exitWithUsage() {
+  stderr.writeln(
+      'Usage: dart build_optimized.dart [--runs=N] [--static-plugins]');
+  exit(1);
+}
+
+/// Runs make with [arguments], exiting if it fails.
+Future<void> _make(List<String> arguments) => _run('make', arguments);
+
+/// Runs [executable] with [arguments], showing its output, and exits if it
+/// fails.
+Future<void> _run(String executable, List<String> arguments) async {
+  final process = await Process.start(executable, arguments,
+      mode: ProcessStartMode.inheritStdio);
+  final exitCode = await process.exitCode;
+  if (exitCode != 0) {
+    stderr.writeln('$executable ${arguments.join(' ')} failed');
+    exit(1);
+  }
+}
+
+/// Runs the training scenario in the testbed [executable], with the file
+/// chooser dismissed by the GTK module [dialogDismisser], and returns the CPU
+/// time of each step in microseconds, or null if the run fails.
+Future<Map<String, int>> _runTrainingScenario(String executable,
+    String dialogDismisser, Map<String, String> environment) async {
+  final process = await Process.start(executable, ['--headless'],
+      environment: {
+        ...environment,
+        'FLUTTER_TRAINING_SCENARIO': '1',
+        'GTK_MODULES': dialogDismisser,
+      });
+  final results = <String, int>{};
+  final output = process.stdout
+      .transform(const SystemEncoding().decoder)
+      .transform(const LineSplitter())
+      .forEach((line) {
+    final match = _scenarioResultPattern.firstMatch(line);
+    if (match != null) {
+      results[match.group(1)] = int.parse(match.group(3));
+    }
+  });
+  process.stderr.drain<void>();
+  final exitCode = await process.exitCode.timeout(_trainingTimeout,
+      onTimeout: () {
+    process.kill();
+    return -1;
+  });
+  await output;
+  if (exitCode != 0) {
+    stderr.writeln('Training scenario in $executable failed '
+        '(exit code $exitCode)');
+    return null;
+  }
+  return results;
+}
+
+/// Returns the size in bytes of [executable] and the plugin libraries in the
+/// lib directory next to it, excluding the Flutter engine and AOT snapshot.
+int _codeSize(String executable) {
+  final file = File(executable);
+  var size = file.lengthSync();
+  final libraryDirectory = Directory('${file.parent.path}/lib');
+  if (!libraryDirectory.existsSync()) {
+    return size;
+  }
+  const excluded = {'libflutter_linux.so', 'libapp.so'};
+  for (final entity in libraryDirectory.listSync()) {
+    final name = entity.uri.pathSegments.last;
+    if (entity is File && name.endsWith('.so') && !excluded.contains(name)) {
+      size += entity.lengthSync();
+    }
+  }
+  return size;
+}
+
+/// Returns the median of [values], or null if there are none.
+int _median(List<int> values) {
+  final sorted = values.toList()..sort();
+  return sorted.isEmpty ? null : sorted[sorted.length ~/ 2];
+}
+
+String _formatMilliseconds(int microseconds) => microseconds == null
+    ? '-'
+    : '${(microseconds / 1000).toStringAsFixed(1)} ms';
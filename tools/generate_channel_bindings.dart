@@ -0,0 +1,815 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Generates typed bindings for a plugin's platform channel from a schema
+// file: C++ structs with Encode/Decode functions that read and write the
+// standard codec's wire format directly (see
+// plugins/common/linux/standard_codec_stream.h), and matching Dart classes.
+//
+// Usage: dart generate_channel_bindings.dart [--check] <schema.idl>...
+//
+// For plugins/foo/foo_messages.idl, the outputs are
+// plugins/foo/linux/foo_messages.h and plugins/foo/lib/src/foo_messages.dart.
+// With --check, nothing is written, and the exit code is non-zero if any
+// output is out of date.
+//
+// Schema syntax:
+//   channel "flutter/foo";               The channel name.
+//   cpp_namespace plugins_foo;           The namespace of the C++ output.
+//   method DoThing = "Foo.DoThing";      A method handled by the plugin.
+//   callback Done = "Foo.DoneCallback";  A method called on the Dart side.
+//   struct Options {                     A message, sent as a map keyed by
+//     String? title;                     field name. Fields are bool, int,
+//     List<int> values;                  double, String, List<T>, or another
+//   }                                    struct. '?' marks optional fields.
+//   list struct Point {                  A message sent as a list of its
+//     double x;                          field values, in order.
+//     double y;
+//   }
+// Comments starting with /// are copied to the outputs for the declaration
+// that follows; other // comments are ignored. A struct can only contain
+// another struct directly (rather than in a List) if it is declared earlier.
+// The C++ decoder rejects a map that is missing a field not marked optional,
+// and skips keys the schema doesn't have.
+
+import 'dart:io';
+
+const String _checkFlag = '--check';
+
+const String _licenseHeader = '''
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+''';
+
+const Map<String, String> _cppPrimitiveTypes = <String, String>{
+  'bool': 'bool',
+  'int': 'int64_t',
+  'double': 'double',
+  'String': 'plugins_common::ArenaString',
+};
+
+const Map<String, String> _cppPrimitiveDefaults = <String, String>{
+  'bool': ' = false',
+  'int': ' = 0',
+  'double': ' = 0.0',
+  'String': '',
+};
+
+/// A field or list element type.
+class _Type {
+  _Type(this.name, [this.element]);
+
+  /// The type name: a primitive, 'List', or a struct name.
+  final String name;
+
+  /// The element type, for lists.
+  final _Type element;
+
+  bool get isList => name == 'List';
+
+  bool get isPrimitive => _cppPrimitiveTypes.containsKey(name);
+
+  bool get isStruct => !isList && !isPrimitive;
+
+  String get cppType => isList
+      ? 'plugins_common::ArenaVector<${element.cppType}>'
+      : _cppPrimitiveTypes[name] ?? name;
+
+  String get dartType => isList ? 'List<${element.dartType}>' : name;
+}
+
+/// A field of a struct.
+class _Field {
+  _Field(this.name, this.type, this.optional, this.doc);
+
+  final String name;
+  final _Type type;
+  final bool optional;
+  final List<String> doc;
+
+  String get cppName => _snakeCase(name);
+
+  String get cppEnumerator => 'k${_upperCamelCase(name)}';
+}
+
+/// A struct declaration.
+class _Struct {
+  _Struct(this.name, this.encodedAsList, this.doc);
+
+  final String name;
+  final bool encodedAsList;
+  final List<String> doc;
+  final List<_Field> fields = <_Field>[];
+}
+
+/// A method or callback declaration.
+class _Method {
+  _Method(this.name, this.wireName, this.isCallback, this.doc);
+
+  final String name;
+  final String wireName;
+  final bool isCallback;
+  final List<String> doc;
+
+  String get constantName => 'k${name}Method';
+}
+
+/// A parsed schema file.
+class _Schema {
+  String channel;
+  String cppNamespace;
+  final List<_Method> methods = <_Method>[];
+  final List<_Struct> structs = <_Struct>[];
+}
+
+/// Splits schema source into tokens, keeping /// comment lines as single
+/// tokens so that they can be attached to declarations.
+class _Tokenizer {
+  _Tokenizer(this._source, this._path);
+
+  static final RegExp _tokenPattern = RegExp(
+      r'(///[^\n]*)|(//[^\n]*)|("[^"\n]*")|([A-Za-z_][A-Za-z0-9_]*)|'
+      r'([{};=<>?])|(\s+)');
+
+  final String _source;
+  final String _path;
+
+  List<String> tokenize() {
+    final tokens = <String>[];
+    var position = 0;
+    while (position < _source.length) {
+      final match = _tokenPattern.matchAsPrefix(_source, position);
+      if (match == null) {
+        final line = '\n'.allMatches(_source.substring(0, position)).length;
+        throw FormatException(
+            '$_path:${line + 1}: unexpected character '
+            '"${_source[position]}"');
+      }
+      position = match.end;
+      if (match.group(2) != null || match.group(6) != null) {
+        continue;
+      }
+      tokens.add(match.group(0));
+    }
+    return tokens;
+  }
+}
+
+/// A recursive-descent parser for the schema syntax.
+class _Parser {
+  _Parser(this._tokens, this._path);
+
+  final List<String> _tokens;
+  final String _path;
+  int _position = 0;
+  List<String> _pendingDoc = <String>[];
+
+  _Schema parse() {
+    final schema = _Schema();
+    while (!_atEnd) {
+      _readDoc();
+      final keyword = _next();
+      switch (keyword) {
+        case 'channel':
+          schema.channel = _readString();
+          _expect(';');
+          _pendingDoc = <String>[];
+          break;
+        case 'cpp_namespace':
+          schema.cppNamespace = _readIdentifier();
+          _expect(';');
+          _pendingDoc = <String>[];
+          break;
+        case 'method':
+        case 'callback':
+          final name = _readIdentifier();
+          _expect('=');
+          final wireName = _readString();
+          _expect(';');
+          schema.methods.add(
+              _Method(name, wireName, keyword == 'callback', _takeDoc()));
+          break;
+        case 'list':
+          _expect('struct');
+          schema.structs.add(_readStruct(encodedAsList: true));
+          break;
+        case 'struct':
+          schema.structs.add(_readStruct(encodedAsList: false));
+          break;
+        default:
+          _fail('unexpected "$keyword"');
+      }
+    }
+    if (schema.channel == null || schema.cppNamespace == null) {
+      _fail('channel and cpp_namespace are required');
+    }
+    return schema;
+  }
+
+  bool get _atEnd => _position >= _tokens.length;
+
+  String _next() {
+    if (_atEnd) {
+      _fail('unexpected end of file');
+    }
+    return _tokens[_position++];
+  }
+
+  String _peek() => _atEnd ? '' : _tokens[_position];
+
+  void _expect(String token) {
+    final actual = _next();
+    if (actual != token) {
+      _fail('expected "$token", found "$actual"');
+    }
+  }
+
+  String _readIdentifier() {
+    final token = _next();
+    if (!RegExp(r'^[A-Za-z_]\w*$').hasMatch(token)) {
+      _fail('expected an identifier, found "$token"');
+    }
+    return token;
+  }
+
+  String _readString() {
+    final token = _next();
+    if (!token.startsWith('"')) {
+      _fail('expected a string, found "$token"');
+    }
+    return token.substring(1, token.length - 1);
+  }
+
+  /// Collects any /// comment lines before the next declaration.
+  void _readDoc() {
+    while (_peek().startsWith('///')) {
+      final line = _next().substring(3);
+      _pendingDoc.add(line.startsWith(' ') ? line.substring(1) : line);
+    }
+  }
+
+  List<String> _takeDoc() {
+    final doc = _pendingDoc;
+    _pendingDoc = <String>[];
+    return doc;
+  }
+
+  _Struct _readStruct({bool encodedAsList}) {
+    final struct = _Struct(_readIdentifier(), encodedAsList, _takeDoc());
+    _expect('{');
+    while (true) {
+      _readDoc();
+      if (_peek() == '}') {
+        _next();
+        break;
+      }
+      final type = _readType();
+      var optional = false;
+      if (_peek() == '?') {
+        _next();
+        optional = true;
+      }
+      final name = _readIdentifier();
+      _expect(';');
+      struct.fields.add(_Field(name, type, optional, _takeDoc()));
+    }
+    return struct;
+  }
+
+  _Type _readType() {
+    final name = _readIdentifier();
+    if (name != 'List') {
+      return _Type(name);
+    }
+    _expect('<');
+    final element = _readType();
+    _expect('>');
+    return _Type(name, element);
+  }
+
+  void _fail(String message) {
+    throw FormatException('$_path: $message');
+  }
+}
+
+/// Checks that every referenced type exists, and that structs only contain
+/// structs declared earlier (except through lists), so that the C++ output
+/// compiles.
+void _validate(_Schema schema, String path) {
+  final declared = <String>{};
+  final all = schema.structs.map((struct) => struct.name).toSet();
+  final wireNames = <String>{};
+  for (final method in schema.methods) {
+    if (!wireNames.add(method.wireName)) {
+      throw FormatException('$path: duplicate method "${method.wireName}"');
+    }
+  }
+  for (final struct in schema.structs) {
+    if (struct.fields.isEmpty) {
+      throw FormatException('$path: struct ${struct.name} has no fields');
+    }
+    final fieldNames = <String>{};
+    for (final field in struct.fields) {
+      if (!fieldNames.add(field.name)) {
+        throw FormatException(
+            '$path: duplicate field ${struct.name}.${field.name}');
+      }
+      var type = field.type;
+      var inList = false;
+      while (type.isList) {
+        type = type.element;
+        inList = true;
+      }
+      if (type.isStruct && !all.contains(type.name)) {
+        throw FormatException('$path: ${struct.name}.${field.name} uses '
+            'undefined type ${type.name}');
+      }
+      if (type.isStruct && !inList && !declared.contains(type.name)) {
+        throw FormatException('$path: ${struct.name}.${field.name} uses '
+            '${type.name}, which must be declared before ${struct.name}');
+      }
+    }
+    declared.add(struct.name);
+  }
+}
+
+String _upperCamelCase(String name) =>
+    name[0].toUpperCase() + name.substring(1);
+
+String _snakeCase(String name) => name.replaceAllMapped(
+    RegExp('[A-Z]'), (match) => '_${match.group(0).toLowerCase()}');
+
+/// Formats |doc| as comment lines with |prefix|, indented by |indent|.
+String _comment(List<String> doc, String prefix, [String indent = '']) {
+  final buffer = StringBuffer();
+  for (final line in doc) {
+    buffer.writeln(line.isEmpty ? '$indent$prefix' : '$indent$prefix $line');
+  }
+  return buffer.toString();
+}
+
+String _generateCpp(_Schema schema, String schemaPath, String headerPath) {
+  final guard =
+      '${headerPath.toUpperCase().replaceAll(RegExp(r'[/.]'), '_')}_';
+  const reader = 'plugins_common::StandardCodecReader';
+  const writer = 'plugins_common::StandardCodecWriter';
+  final out = StringBuffer()
+    ..write(_licenseHeader)
+    ..writeln()
+    ..writeln('// Generated by tools/generate_channel_bindings.dart from')
+    ..writeln('// $schemaPath. Do not edit.')
+    ..writeln('//')
+    ..writeln("// String and list fields use the reader's arena, if any; see")
+    ..writeln('// plugins/common/linux/arena.h.')
+    ..writeln()
+    ..writeln('#ifndef $guard')
+    ..writeln('#define $guard')
+    ..writeln()
+    ..writeln('#include <cstddef>')
+    ..writeln('#include <cstdint>')
+    ..writeln('#include <string>')
+    ..writeln('#include <vector>')
+    ..writeln()
+    ..writeln('#include "plugins/common/linux/arena.h"')
+    ..writeln('#include "plugins/common/linux/method_table.h"')
+    ..writeln('#include "plugins/common/linux/standard_codec_stream.h"')
+    ..writeln()
+    ..writeln('namespace ${schema.cppNamespace} {')
+    ..writeln()
+    ..writeln('using plugins_common::Decode;')
+    ..writeln('using plugins_common::Encode;')
+    ..writeln()
+    ..writeln('constexpr char kChannelName[] = "${schema.channel}";');
+  for (final method in schema.methods) {
+    out
+      ..writeln()
+      ..write(_comment(method.doc, '//'))
+      ..writeln('constexpr char ${method.constantName}[] = '
+          '"${method.wireName}";');
+  }
+
+  final handled = schema.methods.where((method) => !method.isCallback);
+  if (handled.isNotEmpty) {
+    out
+      ..writeln()
+      ..writeln('// The methods handled by the plugin, for TypedMethodChannel.')
+      ..writeln('enum class Method {');
+    for (final method in handled) {
+      out.writeln('  k${method.name},');
+    }
+    out
+      ..writeln('};')
+      ..writeln()
+      ..writeln(
+          'constexpr plugins_common::MethodEntry<Method> kMethodEntries[] = {');
+    for (final method in handled) {
+      out.writeln('    {${method.constantName}, Method::k${method.name}},');
+    }
+    out
+      ..writeln('};')
+      ..writeln('constexpr auto kMethods = '
+          'plugins_common::MakeMethodTable(kMethodEntries);');
+  }
+
+  for (final struct in schema.structs) {
+    out
+      ..writeln()
+      ..write(_comment(struct.doc, '//'))
+      ..writeln('struct ${struct.name} {');
+    for (final field in struct.fields) {
+      final initializer =
+          field.type.isPrimitive ? _cppPrimitiveDefaults[field.type.name] : '';
+      out
+        ..write(_comment(field.doc, '//', '  '))
+        ..writeln('  ${field.type.cppType} ${field.cppName}$initializer;');
+      if (field.optional) {
+        out.writeln('  bool has_${field.cppName} = false;');
+      }
+    }
+    out.writeln('};');
+  }
+
+  // Declare all the functions first, so that structs can contain each other
+  // through lists.
+  out.writeln();
+  for (final struct in schema.structs) {
+    out
+      ..writeln('inline void Encode(const ${struct.name} &value,')
+      ..writeln('                   $writer *writer);')
+      ..writeln('inline bool Decode($reader *reader,')
+      ..writeln('                   ${struct.name} *value);');
+  }
+
+  for (final struct in schema.structs) {
+    out
+      ..writeln()
+      ..writeln('inline void Encode(const ${struct.name} &value,')
+      ..writeln('                   $writer *writer) {');
+    if (struct.encodedAsList) {
+      out.writeln('  writer->WriteListSize(${struct.fields.length});');
+      for (final field in struct.fields) {
+        if (field.optional) {
+          out
+            ..writeln('  if (value.has_${field.cppName}) {')
+            ..writeln('    Encode(value.${field.cppName}, writer);')
+            ..writeln('  } else {')
+            ..writeln('    writer->WriteNull();')
+            ..writeln('  }');
+        } else {
+          out.writeln('  Encode(value.${field.cppName}, writer);');
+        }
+      }
+    } else {
+      final required = struct.fields.where((field) => !field.optional);
+      out.writeln('  size_t size = ${required.length};');
+      for (final field in struct.fields.where((field) => field.optional)) {
+        out
+          ..writeln('  if (value.has_${field.cppName}) {')
+          ..writeln('    ++size;')
+          ..writeln('  }');
+      }
+      out.writeln('  writer->WriteMapSize(size);');
+      for (final field in struct.fields) {
+        final indent = field.optional ? '    ' : '  ';
+        if (field.optional) {
+          out.writeln('  if (value.has_${field.cppName}) {');
+        }
+        out
+          ..writeln('${indent}writer->WriteString("${field.name}", '
+              '${field.name.length});')
+          ..writeln('${indent}Encode(value.${field.cppName}, writer);');
+        if (field.optional) {
+          out.writeln('  }');
+        }
+      }
+    }
+    out
+      ..writeln('}')
+      ..writeln()
+      ..writeln('inline bool Decode($reader *reader,')
+      ..writeln('                   ${struct.name} *value) {')
+      ..writeln('  size_t size;');
+    if (struct.encodedAsList) {
+      out
+        ..writeln('  if (!reader->ReadListSize(&size) || '
+            'size != ${struct.fields.length}) {')
+        ..writeln('    return false;')
+        ..writeln('  }');
+      for (final field in struct.fields) {
+        _writeCppFieldDecode(out, field, '  ');
+      }
+      out.writeln('  return true;');
+    } else {
+      out
+        ..writeln('  enum class Field {');
+      for (final field in struct.fields) {
+        out.writeln('    ${field.cppEnumerator},');
+      }
+      out
+        ..writeln('  };')
+        ..writeln('  static constexpr plugins_common::MethodEntry<Field> '
+            'kFields[] = {');
+      for (final field in struct.fields) {
+        out.writeln(
+            '      {"${field.name}", Field::${field.cppEnumerator}},');
+      }
+      out
+        ..writeln('  };')
+        ..writeln('  static constexpr auto kFieldTable =')
+        ..writeln('      plugins_common::MakeMethodTable(kFields);');
+      final required = struct.fields.where((field) => !field.optional);
+      if (required.isNotEmpty) {
+        out.writeln("  // Set as each field that isn't optional is read.");
+        for (final field in required) {
+          out.writeln('  bool read_${field.cppName} = false;');
+        }
+      }
+      out
+        ..writeln('  if (!reader->ReadMapSize(&size)) {')
+        ..writeln('    return false;')
+        ..writeln('  }')
+        ..writeln('  for (size_t i = 0; i < size; ++i) {')
+        ..writeln('    const char *key;')
+        ..writeln('    size_t key_size;')
+        ..writeln('    if (!reader->ReadStringView(&key, &key_size)) {')
+        ..writeln('      return false;')
+        ..writeln('    }')
+        ..writeln('    const Field *field = kFieldTable.Find(key, key_size);')
+        ..writeln('    if (!field) {')
+        ..writeln('      // Ignore fields this version of the schema '
+            "doesn't have.")
+        ..writeln('      if (!reader->Skip()) {')
+        ..writeln('        return false;')
+        ..writeln('      }')
+        ..writeln('      continue;')
+        ..writeln('    }')
+        ..writeln('    switch (*field) {');
+      for (final field in struct.fields) {
+        out.writeln('      case Field::${field.cppEnumerator}:');
+        _writeCppFieldDecode(out, field, '        ');
+        if (!field.optional) {
+          out.writeln('        read_${field.cppName} = true;');
+        }
+        out.writeln('        break;');
+      }
+      out..writeln('    }')..writeln('  }');
+      if (required.isEmpty) {
+        out.writeln('  return true;');
+      } else {
+        // Messages missing a field that isn't optional are malformed.
+        final terms = required.map((field) => 'read_${field.cppName}');
+        final singleLine = '  return ${terms.join(' && ')};';
+        out.writeln(singleLine.length <= 80
+            ? singleLine
+            : '  return ${terms.join(' &&\n         ')};');
+      }
+    }
+    out.writeln('}');
+  }
+
+  out
+    ..writeln()
+    ..writeln('}  // namespace ${schema.cppNamespace}')
+    ..writeln()
+    ..writeln('#endif  // $guard');
+  return out.toString();
+}
+
+/// Writes the statements decoding |field|, returning false on failure.
+void _writeCppFieldDecode(StringBuffer out, _Field field, String indent) {
+  final name = field.cppName;
+  if (field.optional) {
+    out
+      ..writeln('${indent}value->has_$name = !reader->ReadNull();')
+      ..writeln('${indent}if (value->has_$name &&')
+      ..writeln('$indent    !Decode(reader, &value->$name)) {');
+  } else {
+    out.writeln('${indent}if (!Decode(reader, &value->$name)) {');
+  }
+  out
+    ..writeln('$indent  return false;')
+    ..writeln('$indent}');
+}
+
+/// Returns a Dart expression converting |expression|, of |type|, to its
+/// channel representation.
+String _dartEncode(_Type type, String expression, [int depth = 0]) {
+  if (type.isStruct) {
+    return '$expression.encode()';
+  }
+  if (type.isList && !_isPrimitiveList(type)) {
+    final item = 'item${depth == 0 ? '' : depth}';
+    return '$expression.map(($item) => '
+        '${_dartEncode(type.element, item, depth + 1)}).toList()';
+  }
+  return expression;
+}
+
+/// Returns a Dart expression converting |expression|, a channel
+/// representation of |type|, to |type|.
+String _dartDecode(_Type type, String expression, [int depth = 0]) {
+  if (type.isStruct) {
+    return '${type.name}.decode($expression)';
+  }
+  if (type.isList) {
+    if (_isPrimitiveList(type)) {
+      return '$expression?.cast<${type.element.dartType}>()';
+    }
+    final item = 'item${depth == 0 ? '' : depth}';
+    return '$expression?.map<${type.element.dartType}>(($item) => '
+        '${_dartDecode(type.element, item, depth + 1)})?.toList()';
+  }
+  return expression;
+}
+
+bool _isPrimitiveList(_Type type) => type.isList && type.element.isPrimitive;
+
+String _generateDart(_Schema schema, String schemaPath) {
+  final out = StringBuffer()
+    ..write(_licenseHeader)
+    ..writeln()
+    ..writeln('// Generated by tools/generate_channel_bindings.dart from')
+    ..writeln('// $schemaPath. Do not edit.')
+    ..writeln()
+    ..writeln('/// The name of the platform channel.')
+    ..writeln("const String kChannelName = '${schema.channel}';");
+  for (final method in schema.methods) {
+    out
+      ..writeln()
+      ..write(_comment(method.doc, '///'))
+      ..writeln("const String ${method.constantName} = '${method.wireName}';");
+  }
+
+  for (final struct in schema.structs) {
+    final name = struct.name;
+    out
+      ..writeln()
+      ..write(_comment(struct.doc, '///'))
+      ..writeln('class $name {')
+      ..writeln('  /// Creates a message with the given field values.')
+      ..writeln('  $name({');
+    for (final field in struct.fields) {
+      out.writeln('    this.${field.name},');
+    }
+    out
+      ..writeln('  });')
+      ..writeln()
+      ..writeln('  /// Creates a message from its platform channel '
+          'representation.')
+      ..writeln('  factory $name.decode(Object message) {');
+    final source = struct.encodedAsList ? 'list' : 'map';
+    out
+      ..writeln(struct.encodedAsList
+          ? '    final List<dynamic> list = message;'
+          : '    final Map<dynamic, dynamic> map = message;')
+      ..writeln('    return $name(');
+    for (var i = 0; i < struct.fields.length; ++i) {
+      final field = struct.fields[i];
+      final value = struct.encodedAsList
+          ? '$source[$i]'
+          : "$source['${field.name}']";
+      var decoded = _dartDecode(field.type, value);
+      if (field.optional && field.type.isStruct) {
+        decoded = '$value == null ? null : $decoded';
+      }
+      out.writeln('      ${field.name}: $decoded,');
+    }
+    out..writeln('    );')..writeln('  }');
+
+    for (final field in struct.fields) {
+      out
+        ..writeln()
+        ..write(_comment(field.doc, '///', '  '))
+        ..writeln('  ${field.type.dartType} ${field.name};');
+    }
+
+    out
+      ..writeln()
+      ..writeln('  /// Returns the platform channel representation of this '
+          'message.')
+      ..writeln('  Object encode() {');
+    if (struct.encodedAsList) {
+      out.writeln('    return <dynamic>[');
+      for (final field in struct.fields) {
+        var encoded = _dartEncode(field.type, field.name);
+        if (field.optional && !field.type.isPrimitive) {
+          encoded = '${field.name} == null ? null : $encoded';
+        }
+        out.writeln('      $encoded,');
+      }
+      out.writeln('    ];');
+    } else {
+      final required = struct.fields.where((field) => !field.optional);
+      if (required.isEmpty) {
+        out.writeln('    final map = <String, dynamic>{};');
+      } else {
+        out.writeln('    final map = <String, dynamic>{');
+        for (final field in required) {
+          out.writeln("      '${field.name}': "
+              '${_dartEncode(field.type, field.name)},');
+        }
+        out.writeln('    };');
+      }
+      for (final field in struct.fields.where((field) => field.optional)) {
+        out
+          ..writeln('    if (${field.name} != null) {')
+          ..writeln("      map['${field.name}'] = "
+              '${_dartEncode(field.type, field.name)};')
+          ..writeln('    }');
+      }
+      out.writeln('    return map;');
+    }
+    out..writeln('  }')..writeln('}');
+  }
+  return out.toString();
+}
+
+/// Parses and validates the schema in |file|, exiting on errors.
+_Schema _load(File file, String path) {
+  try {
+    final tokens = _Tokenizer(file.readAsStringSync(), path).tokenize();
+    final schema = _Parser(tokens, path).parse();
+    _validate(schema, path);
+    return schema;
+  } on FormatException catch (e) {
+    stderr.writeln(e.message);
+    exit(1);
+  }
+  return null;
+}
+
+void main(List<String> arguments) {
+  final check = arguments.contains(_checkFlag);
+  final schemaPaths =
+      arguments.where((argument) => argument != _checkFlag).toList();
+  if (schemaPaths.isEmpty) {
+    stderr.writeln(
+        'Usage: dart generate_channel_bindings.dart [--check] <schema.idl>...');
+    exit(1);
+  }
+  // Paths in the outputs are relative to the repository root, so that they
+  // don't depend on where the tool is run from.
+  final repositoryRoot = File.fromUri(Platform.script).parent.parent.path;
+
+  var outOfDate = false;
+  for (final schemaPath in schemaPaths) {
+    final schemaFile = File(schemaPath).absolute;
+    if (!schemaFile.path.endsWith('.idl')) {
+      stderr.writeln('$schemaPath is not a .idl file');
+      exit(1);
+    }
+    final schema = _load(schemaFile, schemaPath);
+
+    final directory = schemaFile.parent.path;
+    final baseName = schemaFile.uri.pathSegments.last.replaceAll('.idl', '');
+    String relative(String path) =>
+        path.startsWith('$repositoryRoot/')
+            ? path.substring(repositoryRoot.length + 1)
+            : path;
+    final headerPath = '$directory/linux/$baseName.h';
+    final dartPath = '$directory/lib/src/$baseName.dart';
+    final outputs = <String, String>{
+      headerPath: _generateCpp(
+          schema, relative(schemaFile.path), relative(headerPath)),
+      dartPath: _generateDart(schema, relative(schemaFile.path)),
+    };
+    outputs.forEach((path, contents) {
+      final file = File(path);
+      if (check) {
+        if (!file.existsSync() || file.readAsStringSync() != contents) {
+          stderr.writeln('${relative(path)} is out of date');
+          outOfDate = true;
+        }
+      } else {
+        file.writeAsStringSync(contents);
+        print('Wrote ${relative(path)}');
+      }
+    });
+  }
+  if (outOfDate) {
+    stderr.writeln('Run tools/generate_channel_bindings.dart to update.');
+    exit(1);
+  }
+}
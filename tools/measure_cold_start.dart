@@ -0,0 +1,355 @@
+// Copyright 2019 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures the startup and steady-state frame times of Linux runners, using
+// the runner's startup trace (see runner/linux/startup_tracer.h).
+//
+// Usage: dart measure_cold_start.dart [--runs=N] [--drop-caches]
+//            [--shader-cache] <executable> [<executable>...]
+//
+// Each run launches an executable with FLUTTER_STARTUP_TRACE set, waits for
+// the first frame and the steady-state frame summary to be reported, then
+// terminates it. With --drop-caches, the page cache is dropped before each run
+// (which requires root), so that every run is a cold start.
+//
+// Results for each executable are printed side by side, so that, for example,
+// a debug (kernel snapshot) and release (AOT) bundle can be compared. Along
+// with times, the resident set size at the end of each run (and its peak) and
+// the size of each executable and its bundled plugin libraries are reported,
+// so that bundles built with and without STATIC_PLUGINS can be compared.
+//
+// With --shader-cache, the testbed's shader benchmark is run instead of the
+// application (see testbed/lib/shader_benchmark.dart), alternating runs with
+// a purged and a warm shader cache, and results are reported for each.
+//
+// To measure zygote launches, start `testbed --zygote` and pass both the
+// testbed and testbed_launch executables; the launcher reports when it
+// started, so times for both are measured from the launch request.
+
+import 'dart:async';
+import 'dart:convert';
+import 'dart:io';
+
+const String _runsPrefix = '--runs=';
+const String _dropCachesFlag = '--drop-caches';
+const String _shaderCacheFlag = '--shader-cache';
+const String _purgeShaderCacheArgument = '--purge-shader-cache';
+const String _shaderBenchmarkEnvironmentVariable = 'FLUTTER_SHADER_BENCHMARK';
+const Duration _pollInterval = Duration(milliseconds: 50);
+const Duration _firstFrameTimeout = Duration(seconds: 30);
+// The steady-state summary is only reported if the application keeps
+// producing frames, so don't wait long for it.
+const Duration _summaryTimeout = Duration(seconds: 5);
+
+/// The measurements from a single run.
+class _RunResult {
+  /// Microseconds from process start to the first rasterized frame.
+  int timeToFirstFrame;
+
+  /// Microseconds from process start to the window and engine being created.
+  int timeToWindow;
+
+  /// The runner's snapshot mode metadata, if reported.
+  String snapshot;
+
+  /// 'zygote' if the run was forked from a zygote.
+  String launch;
+
+  /// Steady-state build and raster times in microseconds, if reported.
+  int buildMedian;
+  int rasterMedian;
+  int rasterP90;
+
+  /// The resident set size and its peak, in kilobytes, at the end of the run.
+  int rss;
+  int peakRss;
+}
+
+/// A configuration to measure: an executable and how to launch it.
+class _Configuration {
+  _Configuration(this.label, this.executable,
+      {this.arguments = const <String>[],
+      this.environment = const <String, String>{}});
+
+  final String label;
+  final String executable;
+  final List<String> arguments;
+  final Map<String, String> environment;
+}
+
+Future<void> main(List<String> arguments) async {
+  var runs = 10;
+  var dropCaches = false;
+  var shaderCache = false;
+  final executables = <String>[];
+  for (final argument in arguments) {
+    if (argument.startsWith(_runsPrefix)) {
+      runs = int.parse(argument.substring(_runsPrefix.length));
+    } else if (argument == _dropCachesFlag) {
+      dropCaches = true;
+    } else if (argument == _shaderCacheFlag) {
+      shaderCache = true;
+    } else {
+      executables.add(argument);
+    }
+  }
+  if (executables.isEmpty || runs < 1) {
+    stderr.writeln('Usage: dart measure_cold_start.dart [--runs=N] '
+        '[--drop-caches] [--shader-cache] <executable> [<executable>...]');
+    exit(1);
+  }
+
+  final configurations = <_Configuration>[];
+  for (final executable in executables) {
+    if (shaderCache) {
+      const environment = {_shaderBenchmarkEnvironmentVariable: '1'};
+      configurations
+        ..add(_Configuration('cold shaders', executable,
+            arguments: [_purgeShaderCacheArgument], environment: environment))
+        ..add(_Configuration('warm shaders', executable,
+            environment: environment));
+    } else {
+      configurations.add(_Configuration('', executable));
+    }
+  }
+
+  final traceDirectory = Directory.systemTemp.createTempSync('cold_start');
+  final results = <_Configuration, List<_RunResult>>{
+    for (final configuration in configurations) configuration: <_RunResult>[]
+  };
+  try {
+    // Alternate between configurations, so that each run of one is compared
+    // against a run of another under similar conditions.
+    for (var i = 0; i < runs; ++i) {
+      for (final configuration in configurations) {
+        if (dropCaches) {
+          _dropPageCache();
+        }
+        final tracePath = '${traceDirectory.path}/trace.json';
+        final result = await _measureRun(configuration, tracePath);
+        if (result == null) {
+          stderr.writeln('${configuration.executable} run $i did not report '
+              'a first frame');
+          continue;
+        }
+        results[configuration].add(result);
+      }
+    }
+  } finally {
+    traceDirectory.deleteSync(recursive: true);
+  }
+
+  stdout.writeln('Medians over up to $runs runs'
+      '${dropCaches ? ' with a cold page cache' : ''}:');
+  stdout.writeln([
+    'snapshot',
+    'window',
+    'first frame',
+    'build',
+    'raster',
+    'raster p90',
+    'rss',
+    'peak rss',
+    'code size',
+    'configuration'
+  ].map((heading) => heading.padRight(12)).join());
+  for (final configuration in configurations) {
+    final configurationResults = results[configuration];
+    if (configurationResults.isEmpty) {
+      continue;
+    }
+    String median(int Function(_RunResult) value) =>
+        _formatMilliseconds(_median(configurationResults.map(value)));
+    stdout.writeln([
+      configurationResults.first.snapshot ?? '?',
+      median((r) => r.timeToWindow),
+      median((r) => r.timeToFirstFrame),
+      median((r) => r.buildMedian),
+      median((r) => r.rasterMedian),
+      median((r) => r.rasterP90),
+      _formatKilobytes(_median(configurationResults.map((r) => r.rss))),
+      _formatKilobytes(_median(configurationResults.map((r) => r.peakRss))),
+      _formatKilobytes(_codeSize(configuration.executable) ~/ 1024),
+      [
+        configuration.executable,
+        configuration.label,
+        if (configurationResults.first.launch != null)
+          '(${configurationResults.first.launch})',
+      ].join(' '),
+    ].map((column) => column.padRight(12)).join());
+  }
+}
+
+/// Runs [configuration] until it reports its first frame and steady-state
+/// frame summary, or null if no first frame is reported.
+Future<_RunResult> _measureRun(
+    _Configuration configuration, String tracePath) async {
+  final traceFile = File(tracePath);
+  if (traceFile.existsSync()) {
+    traceFile.deleteSync();
+  }
+  final process = await Process.start(
+      configuration.executable, configuration.arguments,
+      environment: {
+        ...configuration.environment,
+        'FLUTTER_STARTUP_TRACE': tracePath,
+      });
+  // Drain the output so that the runner never blocks on a full pipe.
+  process.stdout.drain<void>();
+  process.stderr.drain<void>();
+  _RunResult result;
+  var deadline = DateTime.now().add(_firstFrameTimeout);
+  while (DateTime.now().isBefore(deadline)) {
+    await Future<void>.delayed(_pollInterval);
+    final trace = _readTrace(traceFile);
+    if (trace == null) {
+      continue;
+    }
+    if (result == null) {
+      result = _readFirstFrame(trace);
+      if (result != null) {
+        deadline = DateTime.now().add(_summaryTimeout);
+      }
+    }
+    if (result != null && _readFrameSummary(trace, result)) {
+      break;
+    }
+  }
+  if (result != null) {
+    _readMemoryUsage(process.pid, result);
+  }
+  process.kill();
+  await process.exitCode;
+  return result;
+}
+
+/// Fills in [result] with the current and peak resident set sizes of the
+/// process [pid].
+void _readMemoryUsage(int pid, _RunResult result) {
+  List<String> lines;
+  try {
+    lines = File('/proc/$pid/status').readAsLinesSync();
+  } on FileSystemException {
+    return;
+  }
+  int kilobytes(String line) => int.parse(line.split(RegExp(r'\s+'))[1]);
+  for (final line in lines) {
+    if (line.startsWith('VmRSS:')) {
+      result.rss = kilobytes(line);
+    } else if (line.startsWith('VmHWM:')) {
+      result.peakRss = kilobytes(line);
+    }
+  }
+}
+
+/// Returns the size in bytes of [executable] and the plugin libraries in the
+/// lib directory next to it. The Flutter engine and AOT snapshot libraries
+/// are excluded, since they don't depend on how plugins are linked.
+int _codeSize(String executable) {
+  final file = File(executable);
+  var size = file.lengthSync();
+  final libraryDirectory = Directory('${file.parent.path}/lib');
+  if (!libraryDirectory.existsSync()) {
+    return size;
+  }
+  const excluded = {'libflutter_linux.so', 'libapp.so'};
+  for (final entity in libraryDirectory.listSync()) {
+    final name = entity.uri.pathSegments.last;
+    if (entity is File && name.endsWith('.so') && !excluded.contains(name)) {
+      size += entity.lengthSync();
+    }
+  }
+  return size;
+}
+
+/// Returns the decoded trace in [traceFile], or null if it is missing or
+/// incomplete.
+Map<String, dynamic> _readTrace(File traceFile) {
+  if (!traceFile.existsSync()) {
+    return null;
+  }
+  try {
+    return json.decode(traceFile.readAsStringSync()) as Map<String, dynamic>;
+  } on FormatException {
+    // The trace may be read while it is being written.
+    return null;
+  }
+}
+
+/// Returns a result with the times from the start of the ProcessStartToMain
+/// phase to the end of the CreateWindow phase and to the FirstFrameRasterized
+/// event in [trace], or null if the first frame hasn't been reported.
+_RunResult _readFirstFrame(Map<String, dynamic> trace) {
+  int processStart;
+  int windowCreated;
+  int firstFrame;
+  for (final event in trace['traceEvents'] as List<dynamic>) {
+    final name = event['name'];
+    if (name == 'ProcessStartToMain') {
+      processStart = event['ts'] as int;
+    } else if (name == 'CreateWindow') {
+      windowCreated = (event['ts'] as int) + (event['dur'] as int);
+    } else if (name == 'FirstFrameRasterized') {
+      firstFrame = event['ts'] as int;
+    }
+  }
+  if (processStart == null || firstFrame == null) {
+    return null;
+  }
+  final metadata = trace['metadata'] as Map<String, dynamic> ?? {};
+  return _RunResult()
+    ..timeToFirstFrame = firstFrame - processStart
+    ..timeToWindow =
+        windowCreated == null ? null : windowCreated - processStart
+    ..snapshot = metadata['snapshot'] as String
+    ..launch = metadata['launch'] as String;
+}
+
+/// Fills in [result] from the steady-state frame summary in [trace]. Returns
+/// false if the summary hasn't been reported.
+bool _readFrameSummary(Map<String, dynamic> trace, _RunResult result) {
+  final metadata = trace['metadata'] as Map<String, dynamic> ?? {};
+  if (!metadata.containsKey('build_median_us')) {
+    return false;
+  }
+  result
+    ..buildMedian = int.parse(metadata['build_median_us'] as String)
+    ..rasterMedian = int.parse(metadata['raster_median_us'] as String)
+    ..rasterP90 = int.parse(metadata['raster_p90_us'] as String);
+  return true;
+}
+
+/// Drops the page, dentry, and inode caches.
+void _dropPageCache() {
+  final result = Process.runSync(
+      'sh', ['-c', 'sync && echo 3 > /proc/sys/vm/drop_caches']);
+  if (result.exitCode != 0) {
+    stderr.writeln('Unable to drop caches (${result.stderr.trim()}); '
+        'run as root to measure cold starts.');
+    exit(1);
+  }
+}
+
+/// Returns the median of the non-null [values], or null if there are none.
+int _median(Iterable<int> values) {
+  final sorted = values.where((value) => value != null).toList()..sort();
+  return sorted.isEmpty ? null : sorted[sorted.length ~/ 2];
+}
+
+String _formatKilobytes(int kilobytes) =>
+    kilobytes == null ? '-' : '$kilobytes KB';
+
+String _formatMilliseconds(int microseconds) => microseconds == null
+    ? '-'
+    : '${(microseconds / 1000).toStringAsFixed(1)} ms';